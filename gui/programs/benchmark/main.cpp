@@ -0,0 +1,94 @@
+/* RevKit: A Toolkit for Reversible Circuit Design (www.revkit.org)
+ * Copyright (C) 2009-2014  The RevKit Developers <revkit@informatik.uni-bremen.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include <QtCore/QElapsedTimer>
+#include <QtGui/QImage>
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QGraphicsScene>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+
+#include "src/circuit_view.hpp"
+
+using namespace revkit;
+
+/* Measures loading and painting a large random circuit.  Runs headless
+   with the offscreen platform unless QT_QPA_PLATFORM is set. */
+int main( int argc, char ** argv )
+{
+  if ( qgetenv( "QT_QPA_PLATFORM" ).isEmpty() )
+  {
+    qputenv( "QT_QPA_PLATFORM", "offscreen" );
+  }
+
+  QApplication app( argc, argv );
+
+  unsigned num_gates = argc > 1 ? std::atoi( argv[1] ) : 500000u;
+  unsigned lines = argc > 2 ? std::atoi( argv[2] ) : 64u;
+
+  auto circ = std::make_shared<circuit>();
+  circ->set_lines( lines );
+  std::srand( 42 );
+  for ( unsigned i = 0u; i < num_gates; ++i )
+  {
+    gate::control_container controls;
+    unsigned target = std::rand() % lines;
+    for ( unsigned j = 0u; j < 3u; ++j )
+    {
+      unsigned control = std::rand() % lines;
+      if ( control != target )
+      {
+        controls.push_back( make_var( control, std::rand() % 2 ) );
+      }
+    }
+    append_toffoli( *circ, controls, target );
+  }
+
+  CircuitView view;
+  view.resize( 1280, 800 );
+
+  QElapsedTimer timer;
+  timer.start();
+  view.load( circ );
+  qint64 load_time = timer.elapsed();
+
+  timer.restart();
+  QImage detail = view.grab().toImage();
+  qint64 detail_time = timer.elapsed();
+
+  view.fitInView( view.scene()->sceneRect() );
+  timer.restart();
+  QImage overview = view.grab().toImage();
+  qint64 overview_time = timer.elapsed();
+
+  std::cout << "gates:    " << num_gates << std::endl
+            << "lines:    " << lines << std::endl
+            << "load:     " << load_time << " ms" << std::endl
+            << "detail:   " << detail_time << " ms" << std::endl
+            << "overview: " << overview_time << " ms" << std::endl;
+
+  return 0;
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// End:
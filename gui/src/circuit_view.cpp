@@ -17,19 +17,25 @@
 
 #include "circuit_view.hpp"
 
+#include <cmath>
 #include <memory>
+#include <sstream>
 
 #include <QtGui/QClipboard>
+#include <QtGui/QFontMetrics>
 #include <QtGui/QIcon>
 #include <QtGui/QPainter>
 #include <QtGui/QPixmap>
+#include <QtGui/QWheelEvent>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QGraphicsItem>
 #include <QtWidgets/QGraphicsScene>
+#include <QtWidgets/QGraphicsSceneHoverEvent>
 #include <QtWidgets/QMenu>
+#include <QtWidgets/QStyleOptionGraphicsItem>
 
-#include <boost/foreach.hpp>
+#include <boost/format.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/irange.hpp>
 
@@ -39,64 +45,163 @@
 
 using namespace revkit;
 
-class CircuitLineItem : public QGraphicsItemGroup
+/* The whole circuit is a single item, which only paints the lines, labels,
+   and gates in the exposed rectangle.  The extent of each gate column is
+   kept as spatial index, and if a column gets narrower than a few pixels,
+   the columns falling into the same pixel are summarized as a single line. */
+class CircuitItem : public QGraphicsItem
 {
 public:
-  CircuitLineItem( unsigned index, unsigned width, QGraphicsItem * parent = nullptr )
-    : QGraphicsItemGroup( parent )
+  explicit CircuitItem( const std::shared_ptr<circuit>& circ, QGraphicsItem * parent = nullptr )
+    : QGraphicsItem( parent ),
+      mCircuit( circ )
   {
-    setToolTip( boost::str( boost::format( "<b><font color=\"#606060\">Line:</font></b> %d" ) % index ).c_str() );
+    setFlag( QGraphicsItem::ItemUsesExtendedStyleOption );
+    setAcceptHoverEvents( true );
 
-    unsigned x = 0u;
-    for ( unsigned i : boost::irange( 0u, width + 1u ) )
+    mFirst.reserve( circ->num_gates() );
+    mLast.reserve( circ->num_gates() );
+
+    std::vector<unsigned> lines;
+    for ( const gate& g : *circ )
+    {
+      lines.clear();
+      find_non_empty_lines( g, std::back_inserter( lines ) );
+      mFirst.push_back( *boost::min_element( lines ) );
+      mLast.push_back( *boost::max_element( lines ) );
+    }
+
+    QFontMetrics metrics( mFont );
+    for ( unsigned i : boost::irange( 0u, circ->lines() ) )
     {
-      unsigned ewidth = ( i == 0u || i == width ) ? 15u : 30u;
-      addToGroup( new QGraphicsLineItem( x, index * 30u, x + ewidth, index * 30u, this ) );
-      x += ewidth;
+      mInputWidth = std::max( mInputWidth, metrics.width( circ->inputs()[i].c_str() ) );
+      mOutputWidth = std::max( mOutputWidth, metrics.width( circ->outputs()[i].c_str() ) );
     }
   }
-};
 
-class GateItem : public QGraphicsItemGroup
-{
-public:
-  GateItem( const gate& g, unsigned index, const circuit& circ, QGraphicsItem * parent = nullptr )
-    : QGraphicsItemGroup( parent )
+  QRectF boundingRect() const
   {
-    std::vector<unsigned> lines;
-    find_non_empty_lines( g, std::back_inserter( lines ) );
-    boost::sort( lines );
+    return QRectF( -mInputWidth - 10, -15, mInputWidth + width() + mOutputWidth + 20, mCircuit->lines() * 30 );
+  }
+
+  void paint( QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget = nullptr )
+  {
+    const QRectF& exposed = option->exposedRect;
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
+
+    const int lines = mCircuit->lines();
+    const int firstLine = std::max( 0, (int)std::floor( exposed.top() / 30 ) );
+    const int lastLine = std::min( lines - 1, (int)std::ceil( exposed.bottom() / 30 ) );
+
+    /* lines */
+    const qreal x1 = std::max<qreal>( 0, exposed.left() );
+    const qreal x2 = std::min<qreal>( width(), exposed.right() );
+    for ( int i = firstLine; i <= lastLine && x1 < x2; ++i )
+    {
+      painter->drawLine( QLineF( x1, i * 30, x2, i * 30 ) );
+    }
 
-    if ( lines.size() > 1u )
+    /* labels, only if readable */
+    if ( lod >= 0.3 )
     {
-      auto circuitLine = new QGraphicsLineItem( 0, lines.front() * 30, 0, lines.back() * 30, this );
-      addToGroup( circuitLine );
+      painter->setFont( mFont );
+      for ( int i = firstLine; i <= lastLine; ++i )
+      {
+        if ( exposed.left() < 0 )
+        {
+          painter->setPen( mCircuit->constants()[i] ? Qt::red : Qt::black );
+          painter->drawText( QRectF( -mInputWidth - 5, i * 30 - 12, mInputWidth, 24 ), Qt::AlignRight | Qt::AlignVCenter, mCircuit->inputs()[i].c_str() );
+        }
+        if ( exposed.right() > width() )
+        {
+          painter->setPen( mCircuit->garbage()[i] ? Qt::red : Qt::black );
+          painter->drawText( QRectF( width() + 5, i * 30 - 12, mOutputWidth, 24 ), Qt::AlignLeft | Qt::AlignVCenter, mCircuit->outputs()[i].c_str() );
+        }
+      }
+      painter->setPen( Qt::black );
+    }
+
+    /* gates in the exposed columns */
+    const int numGates = mFirst.size();
+    const int firstColumn = std::max( 0, (int)std::floor( ( exposed.left() - 25 ) / 30 ) );
+    const int lastColumn = std::min( numGates - 1, (int)std::ceil( ( exposed.right() - 5 ) / 30 ) );
+
+    if ( lod * 30 >= 4 )
+    {
+      for ( int c = firstColumn; c <= lastColumn; ++c )
+      {
+        drawGate( painter, ( *mCircuit )[c], c );
+      }
+    }
+    else
+    {
+      /* one line per pixel column */
+      const int group = std::max( 1, (int)std::ceil( 1 / ( lod * 30 ) ) );
+      painter->setPen( QPen( Qt::black, 0 ) );
+      for ( int c = firstColumn - firstColumn % group; c <= lastColumn; c += group )
+      {
+        const int end = std::min( c + group, numGates );
+        unsigned first = *std::min_element( mFirst.begin() + c, mFirst.begin() + end );
+        unsigned last = *std::max_element( mLast.begin() + c, mLast.begin() + end );
+        painter->drawLine( QLineF( c * 30 + 15, first * 30, c * 30 + 15, last * 30 ) );
+      }
+    }
+  }
+
+protected:
+  void hoverMoveEvent( QGraphicsSceneHoverEvent * event )
+  {
+    int line = (int)std::floor( event->pos().y() / 30 + 0.5 );
+    if ( line >= 0 && line < (int)mCircuit->lines() )
+    {
+      setToolTip( boost::str( boost::format( "<b><font color=\"#606060\">Line:</font></b> %d" ) % line ).c_str() );
+    }
+  }
+
+private:
+  qreal width() const
+  {
+    return 30.0 * mFirst.size();
+  }
+
+  void drawGate( QPainter * painter, const gate& g, int column ) const
+  {
+    const qreal x = column * 30 + 15;
+
+    if ( mFirst[column] != mLast[column] )
+    {
+      painter->drawLine( QLineF( x, mFirst[column] * 30, x, mLast[column] * 30 ) );
     }
 
     for ( int t : g.targets() )
     {
       if ( is_toffoli( g ) )
       {
-        auto target = new QGraphicsEllipseItem( -10, t * 30 - 10, 20, 20, this );
-        auto targetLine = new QGraphicsLineItem( 0, t * 30 - 10, 0, t * 30 + 10, this );
-        auto targetLine2 = new QGraphicsLineItem( -10, t * 30, 10, t * 30, this );
-        addToGroup( target );
-        addToGroup( targetLine );
-        addToGroup( targetLine2 );
+        painter->setBrush( Qt::NoBrush );
+        painter->drawEllipse( QRectF( x - 10, t * 30 - 10, 20, 20 ) );
+        painter->drawLine( QLineF( x, t * 30 - 10, x, t * 30 + 10 ) );
+        painter->drawLine( QLineF( x - 10, t * 30, x + 10, t * 30 ) );
       }
       else
       {
-        assert( false );
+        painter->drawLine( QLineF( x - 5, t * 30 - 5, x + 5, t * 30 + 5 ) );
+        painter->drawLine( QLineF( x - 5, t * 30 + 5, x + 5, t * 30 - 5 ) );
       }
     }
 
     for ( const auto& v : g.controls() )
     {
-      auto control = new QGraphicsEllipseItem( -5, (int)v.line() * 30 - 5, 10, 10, this );
-      control->setBrush( v.polarity() ? Qt::black : Qt::white );
-      addToGroup( control );
+      painter->setBrush( v.polarity() ? Qt::black : Qt::white );
+      painter->drawEllipse( QRectF( x - 5, (int)v.line() * 30 - 5, 10, 10 ) );
     }
   }
+
+  std::shared_ptr<circuit> mCircuit;
+  std::vector<unsigned> mFirst;
+  std::vector<unsigned> mLast;
+  QFont mFont;
+  int mInputWidth = 0;
+  int mOutputWidth = 0;
 };
 
 class CircuitView::Private
@@ -115,6 +220,7 @@ CircuitView::CircuitView( QWidget * parent )
 {
   setScene( new QGraphicsScene( this ) );
   scene()->setBackgroundBrush( Qt::white );
+  scene()->setItemIndexMethod( QGraphicsScene::NoIndex );
 
   setupActions();
   setupContextMenu();
@@ -124,26 +230,23 @@ void CircuitView::load( const std::shared_ptr<circuit>& circ )
 {
   d->mCircuit = circ;
 
-  boost::for_each( scene()->items(), [this]( QGraphicsItem* item ) { scene()->removeItem( item ); } );
+  scene()->clear();
 
-  unsigned width = 30u * circ->num_gates();
+  auto item = new CircuitItem( circ );
+  scene()->addItem( item );
+  scene()->setSceneRect( item->boundingRect() );
+}
 
-  for ( unsigned i : boost::irange( 0u, circ->lines() ) )
+void CircuitView::wheelEvent( QWheelEvent * event )
+{
+  if ( event->modifiers() & Qt::ControlModifier )
   {
-    auto line = new CircuitLineItem( i, circ->num_gates() );
-    scene()->addItem( line );
-
-    addLineLabel( 0u, i * 30u, circ->inputs()[i].c_str(), Qt::AlignRight, circ->constants()[i] );
-    addLineLabel( width, i * 30u, circ->outputs()[i].c_str(), Qt::AlignLeft, circ->garbage()[i] );
+    const qreal factor = event->angleDelta().y() > 0 ? 1.25 : 0.8;
+    scale( factor, factor );
   }
-
-  unsigned index = 0u;
-  for ( const gate& g : *circ )
+  else
   {
-    auto gateItem = new GateItem( g, index, *circ );
-    gateItem->setPos( index * 30u + 15u, 0u );
-    scene()->addItem( gateItem );
-    ++index;
+    QGraphicsView::wheelEvent( event );
   }
 }
 
@@ -186,26 +289,6 @@ void CircuitView::copyLatexToClipboard()
   }
 }
 
-QGraphicsTextItem * CircuitView::addLineLabel( int x, int y, QString text, unsigned align, bool color )
-{
-  auto textItem = scene()->addText( text );
-  textItem->setPlainText( text );
-
-  if ( align == Qt::AlignRight )
-  {
-    x -= textItem->boundingRect().width();
-  }
-
-  textItem->setPos( x, y - 12 );
-
-  if ( color )
-  {
-    textItem->setDefaultTextColor( Qt::red );
-  }
-
-  return textItem;
-}
-
 #include "src/circuit_view.moc"
 
 // Local Variables:
@@ -25,8 +25,6 @@
 
 #include <reversible/circuit.hpp>
 
-class QGraphicsTextItem;
-
 class CircuitView : public QGraphicsView
 {
   Q_OBJECT
@@ -37,12 +35,13 @@ public:
   void load( const std::shared_ptr<revkit::circuit>& circ );
   void saveImage( const QString& filename ) const;
 
+protected:
+  void wheelEvent( QWheelEvent * event );
+
 private:
   void setupActions();
   void setupContextMenu();
 
-  QGraphicsTextItem * addLineLabel( int x, int y, QString text, unsigned align, bool color );
-
 private Q_SLOTS:
   void copyLatexToClipboard();
   void showContextMenu( const QPoint& pos );
@@ -15,11 +15,14 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <boost/format.hpp>
+
 #include <reversible/circuit.hpp>
 #include <reversible/io/create_image.hpp>
 #include <reversible/io/print_circuit.hpp>
 #include <reversible/io/print_statistics.hpp>
 #include <reversible/io/read_realization.hpp>
+#include <reversible/io/stream_realization.hpp>
 #include <reversible/utils/reversible_program_options.hpp>
 
 using namespace revkit;
@@ -32,6 +35,7 @@ int main( int argc, char ** argv )
     ( "circuit,c",    "Prints the circuit" )
     ( "statistics,s", "Prints circuit statistics " )
     ( "image,i",      "Creates circuit image in LaTeX" )
+    ( "stream",       "Computes statistics without loading all gates into memory" )
     ;
 
   opts.parse( argc, argv );
@@ -42,6 +46,21 @@ int main( int argc, char ** argv )
     return 1;
   }
 
+  if ( opts.is_set( "stream" ) )
+  {
+    statistics_sink stats;
+    std::string error;
+
+    if ( !stream_realization( opts.read_realization_filename(), stats, &error ) )
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+
+    std::cout << boost::format( print_statistics_settings().main_template ) % "" % stats.num_gates() % stats.lines() % stats.transistor_costs() % stats.quantum_costs();
+    return 0;
+  }
+
   circuit circ;
   read_realization( circ, opts.read_realization_filename() );
 
@@ -0,0 +1,74 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/io/read_binary_realization.hpp>
+#include <reversible/io/read_realization.hpp>
+#include <reversible/io/write_binary_realization.hpp>
+#include <reversible/io/write_realization.hpp>
+#include <reversible/utils/reversible_program_options.hpp>
+
+using namespace revkit;
+
+/* files ending with .rbc are in binary format, all others in RevLib format */
+bool is_binary( const std::string& filename )
+{
+  return boost::algorithm::ends_with( filename, ".rbc" );
+}
+
+int main( int argc, char ** argv )
+{
+  reversible_program_options opts;
+  opts.add_read_realization_option();
+  opts.add_write_realization_option();
+  opts.parse( argc, argv );
+
+  if ( !opts.good() || !opts.is_write_realization_filename_set() )
+  {
+    std::cout << opts << std::endl;
+    return 1;
+  }
+
+  circuit circ;
+  std::string error;
+
+  const std::string& in = opts.read_realization_filename();
+  if ( !( is_binary( in ) ? read_binary_realization( circ, in, &error ) : read_realization( circ, in, read_realization_settings(), &error ) ) )
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  const std::string& out = opts.write_realization_filename();
+  if ( !( is_binary( out ) ? write_binary_realization( circ, out, &error ) : write_realization( circ, out, write_realization_settings(), &error ) ) )
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -34,6 +34,8 @@
 #include <reversible/synthesis/embed_pla.hpp>
 #include <reversible/synthesis/rcbdd_synthesis.hpp>
 
+#include <boost/format.hpp>
+
 using namespace revkit;
 
 int main( int argc, char ** argv )
@@ -45,21 +47,30 @@ int main( int argc, char ** argv )
   std::string embedded_pla;
   unsigned    timeout        = 5000u;
   unsigned    esop_minimizer = 0u;
+  std::string embedding_cache;
+  std::string checkpoint;
+  unsigned    checkpoint_interval = 0u;
 
   reversible_program_options opts;
   opts.add_write_realization_option();
   opts.add_options()
-    ( "filename",       value( &filename ),                    "PLA filename" )
-    ( "mode",           value_with_default( &mode ),           "Mode (0: default, 1: swap, 2: hamming)" )
-    ( "embedded_pla",   value( &embedded_pla ),                "Filename of the embedded PLA file (default is empty)" )
-    ( "truth_table,t",                                         "Prints truth table of embedded PLA (with constants and garbage)" )
+    ( "filename",            value( &filename ),                         "PLA filename" )
+    ( "mode",                value_with_default( &mode ),                "Mode (0: default, 1: swap, 2: hamming)" )
+    ( "embedded_pla",        value( &embedded_pla ),                     "Filename of the embedded PLA file (default is empty)" )
+    ( "truth_table,t",                                                   "Prints truth table of embedded PLA (with constants and garbage)" )
     //    ( "timeout",        value_with_default( &timeout ),        "Timeout in seconds" )
-    ( "esop_minimizer", value_with_default( &esop_minimizer ), "ESOP minizer (0: built-in, 1: exorcism)" )
-    ( "verbose,v",                                             "Be verbose" )
+    ( "esop_minimizer",      value_with_default( &esop_minimizer ),      "ESOP minizer (0: built-in, 1: exorcism)" )
+    ( "reordering,r",                                                    "Enables dynamic group sifting on the (x,y,z) variable triples" )
+    ( "reorder_after_variable",                                          "Reorders the BDD after each adjusted line" )
+    ( "embedding_cache",     value( &embedding_cache ),                  "Stores the embedding in this file and reuses it as long as it is newer than the PLA" )
+    ( "checkpoint",          value( &checkpoint ),                       "Prefix for checkpoint files (<checkpoint>.rcbdd and <checkpoint>.real)" )
+    ( "checkpoint_interval", value_with_default( &checkpoint_interval ), "Writes a checkpoint every K variables (0: never, only in mode 0)" )
+    ( "resume",                                                          "Resumes synthesis from the checkpoint (only in mode 0)" )
+    ( "verbose,v",                                                       "Be verbose" )
     ;
   opts.parse( argc, argv );
 
-  if ( !opts.good() || !opts.is_set( "filename" ) )
+  if ( !opts.good() || ( !opts.is_set( "filename" ) && !opts.is_set( "resume" ) ) )
   {
     std::cout << opts << std::endl;
     return 1;
@@ -72,25 +83,47 @@ int main( int argc, char ** argv )
   rcbdd cf;
   circuit circ;
 
-  read_pla_settings settings;
-  settings.extend = false;
-  read_pla( pla, filename, settings );
-  extend_pla( pla, extended );
-  write_pla( extended, "/tmp/extended.pla" );
+  /* the embedding is computed with the default constant value */
+  bool cached = !opts.is_set( "resume" ) && !embedding_cache.empty()
+    && load_cached_embedding( cf, embedding_cache, filename );
 
-  properties::ptr ep_settings( new properties );
-  ep_settings->set( "truth_table", opts.is_set( "truth_table" ) );
-  ep_settings->set( "write_pla", embedded_pla );
-  embed_pla( cf, "/tmp/extended.pla", ep_settings );
+  if ( !opts.is_set( "resume" ) && !cached )
+  {
+    read_pla_settings settings;
+    settings.extend = false;
+    read_pla( pla, filename, settings );
+    extend_pla( pla, extended );
+    write_pla( extended, "/tmp/extended.pla" );
+
+    cf.initialize_manager();
+    if ( opts.is_set( "reordering" ) )
+    {
+      cf.enable_group_reordering();
+    }
+
+    properties::ptr ep_settings( new properties );
+    ep_settings->set( "truth_table", opts.is_set( "truth_table" ) );
+    ep_settings->set( "write_pla", embedded_pla );
+    ep_settings->set( "cache", embedding_cache );
+    embed_pla( cf, "/tmp/extended.pla", ep_settings );
+  }
 
   properties::ptr rs_settings( new properties );
   properties::ptr rs_statistics( new properties );
   rs_settings->set( "verbose", opts.is_set( "verbose" ) );
   rs_settings->set( "mode", mode );
+  rs_settings->set( "reorder_after_variable", opts.is_set( "reorder_after_variable" ) );
+  rs_settings->set( "checkpoint", checkpoint );
+  rs_settings->set( "checkpoint_interval", checkpoint_interval );
+  rs_settings->set( "resume", opts.is_set( "resume" ) );
   properties::ptr esopmin_settings( new properties );
   esopmin_settings->set( "verbose", opts.is_set( "verbose" ) );
   rs_settings->set( "esopmin", esop_minimizer ? dd_based_exorcism_minimization_func( esopmin_settings ) : dd_based_esop_minimization_func( esopmin_settings ) );
-  rcbdd_synthesis( circ, cf, rs_settings, rs_statistics );
+  if ( !rcbdd_synthesis( circ, cf, rs_settings, rs_statistics ) )
+  {
+    std::cout << rs_statistics->get<std::string>( "error" ) << std::endl;
+    return 1;
+  }
 
   if ( opts.is_write_realization_filename_set() )
   {
@@ -99,6 +132,14 @@ int main( int argc, char ** argv )
 
   print_statistics( circ, rs_statistics->get<double>( "runtime" ) );
 
+  if ( opts.is_set( "reordering" ) || opts.is_set( "reorder_after_variable" ) )
+  {
+    std::cout << boost::format( "Peak live nodes:  %d\nReorderings:      %d\nReordering time:  %.2f" )
+      % rs_statistics->get<unsigned>( "peak_live_nodes" )
+      % rs_statistics->get<unsigned>( "num_reorderings" )
+      % rs_statistics->get<double>( "reordering_time" ) << std::endl;
+  }
+
   return 0;
 }
 
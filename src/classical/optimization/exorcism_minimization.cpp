@@ -40,7 +40,7 @@ class exorcism_processor : public pla_processor
 public:
   exorcism_processor( const cube_function_t& on_cube_f ) : on_cube_f( on_cube_f ) {}
 
-  void on_cube( const std::string& in, const std::string& out )
+  void on_cube_range( const pla_token& in, const pla_token& out )
   {
     /* only one output functions are supported */
     assert( out.size() == 1u );
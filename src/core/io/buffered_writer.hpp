@@ -0,0 +1,145 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file buffered_writer.hpp
+ *
+ * @brief Buffered text output without formatting objects
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef BUFFERED_WRITER_HPP
+#define BUFFERED_WRITER_HPP
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace revkit
+{
+
+  /**
+   * @brief Collects text in a large buffer and writes it in blocks to a stream
+   *
+   * Numbers are converted without locale, no line is flushed
+   * individually.  The buffer is flushed when it is full, on
+   * flush(), and on destruction.
+   *
+   * @code
+   * buffered_writer w( std::cout );
+   * w << ".numvars " << 5u << '\n';
+   * @endcode
+   *
+   * @since  2.0
+   */
+  class buffered_writer
+  {
+  public:
+    explicit buffered_writer( std::ostream& os, std::size_t capacity = 1u << 20u )
+      : os( os ), buffer( capacity ), pos( 0u )
+    {
+    }
+
+    ~buffered_writer()
+    {
+      flush();
+    }
+
+    buffered_writer& put( char c )
+    {
+      if ( pos == buffer.size() )
+      {
+        flush();
+      }
+      buffer[pos++] = c;
+      return *this;
+    }
+
+    buffered_writer& write( const char* s, std::size_t n )
+    {
+      if ( buffer.size() - pos < n )
+      {
+        flush();
+        if ( n > buffer.size() )
+        {
+          os.write( s, n );
+          return *this;
+        }
+      }
+      std::memcpy( &buffer[pos], s, n );
+      pos += n;
+      return *this;
+    }
+
+    buffered_writer& write( unsigned long long n )
+    {
+      char digits[20];
+      char* p = digits + 20;
+      do
+      {
+        *--p = '0' + n % 10u;
+        n /= 10u;
+      } while ( n );
+      return write( p, digits + 20 - p );
+    }
+
+    /**
+     * @brief Writes \p n copies of \p c
+     */
+    buffered_writer& fill( std::size_t n, char c )
+    {
+      while ( n-- )
+      {
+        put( c );
+      }
+      return *this;
+    }
+
+    void flush()
+    {
+      os.write( buffer.data(), pos );
+      pos = 0u;
+    }
+
+    buffered_writer& operator<<( char c )                 { return put( c ); }
+    buffered_writer& operator<<( const char* s )          { return write( s, std::strlen( s ) ); }
+    buffered_writer& operator<<( const std::string& s )   { return write( s.data(), s.size() ); }
+    buffered_writer& operator<<( unsigned n )             { return write( static_cast<unsigned long long>( n ) ); }
+    buffered_writer& operator<<( unsigned long n )        { return write( static_cast<unsigned long long>( n ) ); }
+    buffered_writer& operator<<( unsigned long long n )   { return write( n ); }
+
+  private:
+    buffered_writer( const buffered_writer& );
+    buffered_writer& operator=( const buffered_writer& );
+
+    std::ostream& os;
+    std::vector<char> buffer;
+    std::size_t pos;
+  };
+
+}
+
+#endif /* BUFFERED_WRITER_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,569 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compressed_stream.hpp"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <zlib.h>
+
+#ifdef HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace revkit
+{
+
+  bool is_gzip_filename( const std::string& filename )
+  {
+    return boost::algorithm::ends_with( filename, ".gz" );
+  }
+
+  bool is_zstd_filename( const std::string& filename )
+  {
+#ifdef HAS_ZSTD
+    return boost::algorithm::ends_with( filename, ".zst" );
+#else
+    return false;
+#endif
+  }
+
+  bool is_compressed_filename( const std::string& filename )
+  {
+    return is_gzip_filename( filename ) || is_zstd_filename( filename );
+  }
+
+  ////////////////////////////// decoders and encoders
+
+  /* source of decompressed data, read returns 0 at the end and -1 on errors */
+  class decoder
+  {
+  public:
+    virtual ~decoder() {}
+    virtual long read( char* buffer, std::size_t size ) = 0;
+  };
+
+  /* sink for data to compress */
+  class encoder
+  {
+  public:
+    virtual ~encoder() {}
+    virtual bool write( const char* buffer, std::size_t size ) = 0;
+    virtual bool finish() = 0;
+  };
+
+  class gzip_decoder : public decoder
+  {
+  public:
+    explicit gzip_decoder( gzFile file ) : file( file )
+    {
+      gzbuffer( file, 1u << 17u );
+    }
+
+    ~gzip_decoder()
+    {
+      gzclose( file );
+    }
+
+    long read( char* buffer, std::size_t size )
+    {
+      long n = gzread( file, buffer, size );
+
+      /* gzread returns 0 for a truncated file and only sets the error */
+      int error = Z_OK;
+      if ( n == 0 )
+      {
+        gzerror( file, &error );
+      }
+
+      return error == Z_OK ? n : -1;
+    }
+
+  private:
+    gzFile file;
+  };
+
+  class gzip_encoder : public encoder
+  {
+  public:
+    explicit gzip_encoder( gzFile file ) : file( file )
+    {
+      gzbuffer( file, 1u << 17u );
+    }
+
+    ~gzip_encoder()
+    {
+      finish();
+    }
+
+    bool write( const char* buffer, std::size_t size )
+    {
+      return !size || gzwrite( file, buffer, size ) > 0;
+    }
+
+    bool finish()
+    {
+      if ( !file )
+      {
+        return true;
+      }
+
+      bool result = gzclose( file ) == Z_OK;
+      file = 0;
+      return result;
+    }
+
+  private:
+    gzFile file;
+  };
+
+#ifdef HAS_ZSTD
+  class zstd_decoder : public decoder
+  {
+  public:
+    explicit zstd_decoder( std::FILE* file )
+      : file( file ), stream( ZSTD_createDStream() ), input( ZSTD_DStreamInSize() )
+    {
+      ZSTD_initDStream( stream );
+      in.src = input.data();
+      in.size = 0u;
+      in.pos = 0u;
+    }
+
+    ~zstd_decoder()
+    {
+      ZSTD_freeDStream( stream );
+      std::fclose( file );
+    }
+
+    long read( char* buffer, std::size_t size )
+    {
+      ZSTD_outBuffer out = { buffer, size, 0u };
+
+      while ( out.pos == 0u )
+      {
+        /* a full output buffer may leave data in the decoder, which is flushed before reading on */
+        if ( in.pos == in.size && !flush )
+        {
+          in.size = std::fread( input.data(), 1u, input.size(), file );
+          in.pos = 0u;
+          if ( !in.size )
+          {
+            /* a started frame without its end is truncated */
+            return std::ferror( file ) || !frame_complete ? -1 : 0;
+          }
+        }
+
+        std::size_t result = ZSTD_decompressStream( stream, &out, &in );
+        if ( ZSTD_isError( result ) )
+        {
+          return -1;
+        }
+
+        frame_complete = result == 0u;
+        flush = out.pos == out.size;
+      }
+
+      return out.pos;
+    }
+
+  private:
+    std::FILE* file;
+    ZSTD_DStream* stream;
+    std::vector<char> input;
+    ZSTD_inBuffer in;
+    bool frame_complete = true;
+    bool flush = false;
+  };
+
+  class zstd_encoder : public encoder
+  {
+  public:
+    explicit zstd_encoder( std::FILE* file )
+      : file( file ), context( ZSTD_createCCtx() ), output( ZSTD_CStreamOutSize() )
+    {
+      ZSTD_CCtx_setParameter( context, ZSTD_c_compressionLevel, 3 );
+    }
+
+    ~zstd_encoder()
+    {
+      finish();
+      ZSTD_freeCCtx( context );
+    }
+
+    bool write( const char* buffer, std::size_t size )
+    {
+      ZSTD_inBuffer in = { buffer, size, 0u };
+      while ( in.pos < in.size )
+      {
+        if ( !compress( in, ZSTD_e_continue ) )
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool finish()
+    {
+      if ( !file )
+      {
+        return true;
+      }
+
+      ZSTD_inBuffer in = { 0, 0u, 0u };
+      bool result = true;
+      std::size_t remaining;
+      do
+      {
+        remaining = compress( in, ZSTD_e_end );
+        if ( remaining == error )
+        {
+          result = false;
+          break;
+        }
+      } while ( remaining );
+
+      result = std::fclose( file ) == 0 && result;
+      file = 0;
+      return result;
+    }
+
+  private:
+    static const std::size_t error = ~std::size_t( 0u );
+
+    /* compresses one step, returns the number of bytes left to flush or error */
+    std::size_t compress( ZSTD_inBuffer& in, ZSTD_EndDirective mode )
+    {
+      ZSTD_outBuffer out = { output.data(), output.size(), 0u };
+      std::size_t remaining = ZSTD_compressStream2( context, &out, &in, mode );
+      if ( ZSTD_isError( remaining ) || std::fwrite( output.data(), 1u, out.pos, file ) != out.pos )
+      {
+        return error;
+      }
+      return remaining ? remaining : ( mode == ZSTD_e_continue ? 1u : 0u );
+    }
+
+    std::FILE* file;
+    ZSTD_CCtx* context;
+    std::vector<char> output;
+  };
+#endif
+
+  std::unique_ptr<decoder> make_decoder( const std::string& filename )
+  {
+    if ( is_gzip_filename( filename ) )
+    {
+      gzFile file = gzopen( filename.c_str(), "rb" );
+      return std::unique_ptr<decoder>( file ? new gzip_decoder( file ) : 0 );
+    }
+
+#ifdef HAS_ZSTD
+    if ( is_zstd_filename( filename ) )
+    {
+      std::FILE* file = std::fopen( filename.c_str(), "rb" );
+      return std::unique_ptr<decoder>( file ? new zstd_decoder( file ) : 0 );
+    }
+#endif
+
+    return std::unique_ptr<decoder>();
+  }
+
+  std::unique_ptr<encoder> make_encoder( const std::string& filename )
+  {
+    if ( is_gzip_filename( filename ) )
+    {
+      gzFile file = gzopen( filename.c_str(), "wb6" );
+      return std::unique_ptr<encoder>( file ? new gzip_encoder( file ) : 0 );
+    }
+
+#ifdef HAS_ZSTD
+    if ( is_zstd_filename( filename ) )
+    {
+      std::FILE* file = std::fopen( filename.c_str(), "wb" );
+      return std::unique_ptr<encoder>( file ? new zstd_encoder( file ) : 0 );
+    }
+#endif
+
+    return std::unique_ptr<encoder>();
+  }
+
+  ////////////////////////////// stream buffers
+
+  /* stream buffer which is filled by a thread decompressing ahead */
+  class decompressing_streambuf : public std::streambuf
+  {
+  public:
+    explicit decompressing_streambuf( std::unique_ptr<decoder> source )
+      : source( std::move( source ) ), thread( [this]() { produce(); } )
+    {
+    }
+
+    ~decompressing_streambuf()
+    {
+      {
+        std::lock_guard<std::mutex> lock( mutex );
+        stop = true;
+      }
+      cond.notify_all();
+      thread.join();
+    }
+
+  protected:
+    int_type underflow()
+    {
+      if ( gptr() < egptr() )
+      {
+        return traits_type::to_int_type( *gptr() );
+      }
+
+      std::unique_lock<std::mutex> lock( mutex );
+      cond.wait( lock, [this]() { return !blocks.empty() || done; } );
+
+      if ( blocks.empty() )
+      {
+        /* the stream catches this and sets its badbit */
+        if ( failed )
+        {
+          throw std::ios_base::failure( "cannot decompress input, the file is corrupt or truncated" );
+        }
+        return traits_type::eof();
+      }
+
+      current = std::move( blocks.front() );
+      blocks.pop_front();
+      lock.unlock();
+      cond.notify_all();
+
+      setg( current.data(), current.data(), current.data() + current.size() );
+      return traits_type::to_int_type( *gptr() );
+    }
+
+  private:
+    static const std::size_t block_size = 1u << 18u;
+    static const std::size_t max_blocks = 4u;
+
+    void produce()
+    {
+      while ( true )
+      {
+        std::vector<char> block( block_size );
+        long n = source->read( block.data(), block.size() );
+
+        std::unique_lock<std::mutex> lock( mutex );
+        if ( n <= 0 )
+        {
+          failed = n < 0;
+          done = true;
+          break;
+        }
+
+        block.resize( n );
+        cond.wait( lock, [this]() { return blocks.size() < max_blocks || stop; } );
+        if ( stop )
+        {
+          break;
+        }
+        blocks.push_back( std::move( block ) );
+        lock.unlock();
+        cond.notify_all();
+      }
+      cond.notify_all();
+    }
+
+    std::unique_ptr<decoder> source;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::vector<char> > blocks;
+    bool done = false;
+    bool failed = false;
+    bool stop = false;
+
+    std::vector<char> current;
+    std::thread thread;
+  };
+
+  /* stream buffer which passes full buffers to an encoder */
+  class compressing_streambuf : public std::streambuf
+  {
+  public:
+    explicit compressing_streambuf( std::unique_ptr<encoder> sink )
+      : sink( std::move( sink ) ), buffer( 1u << 18u )
+    {
+      setp( buffer.data(), buffer.data() + buffer.size() );
+    }
+
+    ~compressing_streambuf()
+    {
+      close();
+    }
+
+    bool close()
+    {
+      return sync() == 0 && sink->finish();
+    }
+
+  protected:
+    int_type overflow( int_type c )
+    {
+      if ( sync() != 0 )
+      {
+        return traits_type::eof();
+      }
+
+      if ( !traits_type::eq_int_type( c, traits_type::eof() ) )
+      {
+        *pptr() = traits_type::to_char_type( c );
+        pbump( 1 );
+      }
+
+      return traits_type::not_eof( c );
+    }
+
+    int sync()
+    {
+      bool ok = sink->write( pbase(), pptr() - pbase() );
+      setp( buffer.data(), buffer.data() + buffer.size() );
+      return ok ? 0 : -1;
+    }
+
+  private:
+    std::unique_ptr<encoder> sink;
+    std::vector<char> buffer;
+  };
+
+  ////////////////////////////// class compressed_ifstream
+  class compressed_ifstream::priv
+  {
+  public:
+    std::unique_ptr<std::streambuf> buffer;
+  };
+
+  compressed_ifstream::compressed_ifstream( const std::string& filename )
+    : std::istream( 0 ), d( new priv() )
+  {
+    if ( is_compressed_filename( filename ) )
+    {
+      std::unique_ptr<decoder> source = make_decoder( filename );
+      if ( source )
+      {
+        d->buffer.reset( new decompressing_streambuf( std::move( source ) ) );
+      }
+    }
+    else
+    {
+      std::filebuf* fb = new std::filebuf();
+      d->buffer.reset( fb );
+      if ( !fb->open( filename.c_str(), std::ios::in ) )
+      {
+        d->buffer.reset();
+      }
+    }
+
+    rdbuf( d->buffer.get() );
+  }
+
+  compressed_ifstream::~compressed_ifstream()
+  {
+    rdbuf( 0 );
+    delete d;
+  }
+
+  bool compressed_ifstream::is_open() const
+  {
+    return d->buffer.get() != 0;
+  }
+
+  ////////////////////////////// class compressed_ofstream
+  class compressed_ofstream::priv
+  {
+  public:
+    std::unique_ptr<compressing_streambuf> compressed;
+    std::unique_ptr<std::filebuf> plain;
+  };
+
+  compressed_ofstream::compressed_ofstream( const std::string& filename )
+    : std::ostream( 0 ), d( new priv() )
+  {
+    if ( is_compressed_filename( filename ) )
+    {
+      std::unique_ptr<encoder> sink = make_encoder( filename );
+      if ( sink )
+      {
+        d->compressed.reset( new compressing_streambuf( std::move( sink ) ) );
+        rdbuf( d->compressed.get() );
+      }
+    }
+    else
+    {
+      d->plain.reset( new std::filebuf() );
+      if ( d->plain->open( filename.c_str(), std::ios::out ) )
+      {
+        rdbuf( d->plain.get() );
+      }
+      else
+      {
+        d->plain.reset();
+      }
+    }
+  }
+
+  compressed_ofstream::~compressed_ofstream()
+  {
+    close();
+    rdbuf( 0 );
+    delete d;
+  }
+
+  bool compressed_ofstream::is_open() const
+  {
+    return d->compressed || d->plain;
+  }
+
+  bool compressed_ofstream::close()
+  {
+    flush();
+
+    bool result = good();
+    if ( d->compressed )
+    {
+      result = d->compressed->close() && result;
+    }
+    else if ( d->plain && d->plain->is_open() )
+    {
+      result = d->plain->close() && result;
+    }
+    return result;
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,108 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file compressed_stream.hpp
+ *
+ * @brief File streams with transparent gzip and zstd compression
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef COMPRESSED_STREAM_HPP
+#define COMPRESSED_STREAM_HPP
+
+#include <iostream>
+#include <string>
+
+namespace revkit
+{
+
+  /**
+   * @brief Checks whether a file-name has a compression extension
+   *
+   * Files ending in \b .gz are gzip compressed, files ending in
+   * \b .zst are zstd compressed.  The latter is only supported when
+   * RevKit has been built with libzstd.
+   *
+   * @since  2.0
+   */
+  bool is_compressed_filename( const std::string& filename );
+
+  /**
+   * @brief Input file stream which decompresses based on the file extension
+   *
+   * For compressed files a separate thread decompresses ahead of the
+   * reader, so decompression runs in parallel to parsing.  Other files
+   * are read as with std::ifstream.
+   *
+   * A corrupt or truncated compressed file sets the badbit of the
+   * stream when the reader reaches the damaged part, a clean end of
+   * file only sets the eofbit.
+   *
+   * @since  2.0
+   */
+  class compressed_ifstream : public std::istream
+  {
+  public:
+    explicit compressed_ifstream( const std::string& filename );
+    ~compressed_ifstream();
+
+    bool is_open() const;
+
+  private:
+    class priv;
+    priv* const d;
+  };
+
+  /**
+   * @brief Output file stream which compresses based on the file extension
+   *
+   * @since  2.0
+   */
+  class compressed_ofstream : public std::ostream
+  {
+  public:
+    explicit compressed_ofstream( const std::string& filename );
+    ~compressed_ofstream();
+
+    bool is_open() const;
+
+    /**
+     * @brief Flushes all data and finishes the compressed file
+     *
+     * @return false if the data could not be written
+     *
+     * @since  2.0
+     */
+    bool close();
+
+  private:
+    class priv;
+    priv* const d;
+  };
+
+}
+
+#endif /* COMPRESSED_STREAM_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -17,95 +17,202 @@
 
 #include "pla_parser.hpp"
 
+#include "compressed_stream.hpp"
 #include "pla_processor.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <fstream>
 
-#include <boost/algorithm/string/classification.hpp>
-#include <boost/algorithm/string/predicate.hpp>
-#include <boost/algorithm/string/split.hpp>
-#include <boost/algorithm/string/trim.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <boost/lexical_cast.hpp>
-#include <boost/regex.hpp>
 
 namespace revkit
 {
 
-bool pla_parser( std::istream& in, pla_processor& reader, bool skip_after_first_cube )
-{
-  std::string line;
-
-  while ( in.good() && getline( in, line ) )
+  /* splits lines into whitespace separated tokens without copying and dispatches them */
+  class pla_lexer
   {
-    boost::trim( line );
-    boost::regex_replace( line, boost::regex( "\\s+" ), " ", boost::match_default | boost::format_all );
-    if ( !line.size() ) { continue; }
+  public:
+    explicit pla_lexer( pla_processor& reader ) : reader( reader ) {}
 
-    if ( boost::starts_with( line, "#" ) )
+    /* returns true if the line contained a cube */
+    bool operator()( const char* first, const char* last )
     {
-      std::string comment( std::find_if_not( line.begin(), line.end(), []( char c ) { return c == '#'; } ), line.end() );
-      reader.on_comment( comment );
+      tokens.clear();
+
+      while ( first != last )
+      {
+        while ( first != last && is_space( *first ) ) { ++first; }
+        const char* begin = first;
+        while ( first != last && !is_space( *first ) ) { ++first; }
+        if ( begin != first )
+        {
+          tokens.push_back( pla_token( begin, first ) );
+        }
+      }
+
+      if ( tokens.empty() ) { return false; }
+
+      const pla_token& command = tokens.front();
+
+      if ( *command.begin() == '#' )
+      {
+        const char* comment = std::find_if( command.begin(), tokens.back().end(), []( char c ) { return c != '#'; } );
+        reader.on_comment( std::string( comment, tokens.back().end() ) );
+      }
+      else if ( *command.begin() == '.' )
+      {
+        if ( tokens.size() < 2u )
+        {
+          if ( equals( command, ".e" ) || equals( command, ".end" ) )
+          {
+            reader.on_end();
+          }
+        }
+        else if ( equals( command, ".i" ) )
+        {
+          reader.on_num_inputs( boost::lexical_cast<unsigned>( tokens[1u] ) );
+        }
+        else if ( equals( command, ".o" ) )
+        {
+          reader.on_num_outputs( boost::lexical_cast<unsigned>( tokens[1u] ) );
+        }
+        else if ( equals( command, ".p" ) )
+        {
+          reader.on_num_products( boost::lexical_cast<unsigned>( tokens[1u] ) );
+        }
+        else if ( equals( command, ".ilb" ) )
+        {
+          reader.on_input_labels( labels() );
+        }
+        else if ( equals( command, ".ob" ) )
+        {
+          reader.on_output_labels( labels() );
+        }
+        else if ( equals( command, ".type" ) )
+        {
+          reader.on_type( std::string( tokens[1u].begin(), tokens.back().end() ) );
+        }
+      }
+      else
+      {
+        assert( tokens.size() == 2u && ( *command.begin() == '0' || *command.begin() == '1' || *command.begin() == '-' ) );
+        reader.on_cube_range( tokens[0u], tokens[1u] );
+        return true;
+      }
+
+      return false;
     }
-    else if ( boost::starts_with( line, ".i " ) )
+
+  private:
+    static bool is_space( char c )
     {
-      reader.on_num_inputs( boost::lexical_cast<unsigned>( line.substr( 3 ) ) );
+      return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
     }
-    else if ( boost::starts_with( line, ".o " ) )
+
+    static bool equals( const pla_token& token, const char* keyword )
     {
-      reader.on_num_outputs( boost::lexical_cast<unsigned>( line.substr( 3 ) ) );
+      return (std::size_t)token.size() == std::strlen( keyword ) && std::equal( token.begin(), token.end(), keyword );
     }
-    else if ( boost::starts_with( line, ".p " ) )
+
+    std::vector<std::string> labels() const
     {
-      reader.on_num_products( boost::lexical_cast<unsigned>( line.substr( 3 ) ) );
+      std::vector<std::string> labels;
+      for ( auto it = tokens.begin() + 1u; it != tokens.end(); ++it )
+      {
+        labels.push_back( std::string( it->begin(), it->end() ) );
+      }
+      return labels;
     }
-    else if ( boost::starts_with( line, ".ilb " ) )
+
+    pla_processor& reader;
+    std::vector<pla_token> tokens;
+  };
+
+  bool pla_parser( const char* first, const char* last, pla_processor& reader, bool skip_after_first_cube )
+  {
+    pla_lexer lexer( reader );
+
+    while ( first != last )
     {
-      std::vector<std::string> input_labels;
-      std::string rem = line.substr( 5 );
-      boost::split( input_labels, rem, boost::is_space(), boost::token_compress_on );
-      reader.on_input_labels( input_labels );
+      const char* eol = static_cast<const char*>( std::memchr( first, '\n', last - first ) );
+      if ( !eol ) { eol = last; }
+
+      if ( lexer( first, eol ) && skip_after_first_cube )
+      {
+        break;
+      }
+
+      first = ( eol == last ) ? last : eol + 1;
     }
-    else if ( boost::starts_with( line, ".ob " ) )
+
+    return true;
+  }
+
+  bool pla_parser( std::istream& in, pla_processor& reader, bool skip_after_first_cube )
+  {
+    pla_lexer lexer( reader );
+    std::string line;
+
+    while ( in.good() && getline( in, line ) )
     {
-      std::vector<std::string> output_labels;
-      std::string rem = line.substr( 4 );
-      boost::split( output_labels, rem, boost::is_space(), boost::token_compress_on );
-      reader.on_output_labels( output_labels );
+      if ( lexer( line.data(), line.data() + line.size() ) && skip_after_first_cube )
+      {
+        break;
+      }
     }
-    else if ( line == ".e" )
+
+    return !in.bad();
+  }
+
+  bool pla_parser( const std::string& filename, pla_processor& reader, bool skip_after_first_cube )
+  {
+    /* compressed files are decompressed by a separate thread while parsing */
+    if ( is_compressed_filename( filename ) )
     {
-      reader.on_end();
+      compressed_ifstream is( filename );
+      return is.good() && pla_parser( is, reader, skip_after_first_cube );
     }
-    else if ( boost::starts_with( line, ".type " ) )
+
+    int fd = open( filename.c_str(), O_RDONLY );
+    if ( fd == -1 )
     {
-      reader.on_type( line.substr( 6 ) );
+      return false;
     }
-    else
+
+    struct stat sb;
+    void* data = MAP_FAILED;
+    if ( fstat( fd, &sb ) == 0 && sb.st_size > 0 )
     {
-      assert( line.size() && ( line[0] == '0' || line[0] == '1' || line[0] == '-' ) );
+      data = mmap( 0, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    }
 
-      std::vector<std::string> inout;
-      boost::split( inout, line, boost::is_space(), boost::token_compress_on );
-      assert( inout.size() == 2 );
-      reader.on_cube( inout[0], inout[1] );
+    /* fall back to streams, e.g. for empty files or pipes */
+    if ( data == MAP_FAILED )
+    {
+      close( fd );
 
-      if ( skip_after_first_cube )
-      {
-        break;
-      }
+      std::ifstream is;
+      is.open( filename.c_str() );
+      return pla_parser( is, reader, skip_after_first_cube );
     }
-  }
 
-  return true;
-}
+    madvise( data, sb.st_size, MADV_SEQUENTIAL );
 
-bool pla_parser( const std::string& filename, pla_processor& reader, bool skip_after_first_cube )
-{
-  std::ifstream is;
-  is.open(filename.c_str());
+    const char* first = static_cast<const char*>( data );
+    bool result = pla_parser( first, first + sb.st_size, reader, skip_after_first_cube );
 
-  return pla_parser( is, reader, skip_after_first_cube );
-}
+    munmap( data, sb.st_size );
+    close( fd );
+
+    return result;
+  }
 
 }
 
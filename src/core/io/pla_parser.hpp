@@ -36,7 +36,12 @@ namespace revkit
   class pla_processor;
 
   bool pla_parser( std::istream& in, pla_processor& reader, bool skip_after_first_cube = false );
+
+  /* the file is memory-mapped and tokenized in place */
   bool pla_parser( const std::string& filename, pla_processor& reader, bool skip_after_first_cube = false );
+
+  /* parses the characters in [first, last), e.g. of a memory-mapped file */
+  bool pla_parser( const char* first, const char* last, pla_processor& reader, bool skip_after_first_cube = false );
 }
 
 #endif
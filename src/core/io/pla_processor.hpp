@@ -28,11 +28,23 @@
 #define PLA_PROCESSOR_HPP
 
 #include <iosfwd>
+#include <string>
 #include <vector>
 
+#include <boost/range/iterator_range.hpp>
+
 namespace revkit
 {
 
+  /**
+   * @brief A token of a PLA file, pointing into the parser's buffer
+   *
+   * The token is only valid during the callback in which it is passed.
+   *
+   * @since  2.0
+   */
+  typedef boost::iterator_range<const char*> pla_token;
+
   /**
    * @brief Base class for actions on the pla_parser
    *
@@ -50,6 +62,20 @@ namespace revkit
       virtual void on_end() {}
       virtual void on_type( const std::string& type ) {}
       virtual void on_cube( const std::string& in, const std::string& out ) {}
+
+      /**
+       * @brief Cube callback without copying
+       *
+       * This method is called by the parser for each cube and by default
+       * forwards the cube to on_cube.  Processors that can handle the
+       * characters in place should override this method instead.
+       *
+       * @since  2.0
+       */
+      virtual void on_cube_range( const pla_token& in, const pla_token& out )
+      {
+        on_cube( std::string( in.begin(), in.end() ), std::string( out.begin(), out.end() ) );
+      }
   };
 }
 
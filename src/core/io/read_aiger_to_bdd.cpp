@@ -0,0 +1,115 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "read_aiger_to_bdd.hpp"
+
+#include <vector>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/format.hpp>
+
+extern "C"
+{
+#include <aiger.h>
+}
+
+namespace revkit
+{
+
+  bool read_aiger_to_bdd( BDDTable& bdd, const std::string& filename, const read_aiger_to_bdd_settings& settings, std::string* error )
+  {
+    aiger* aig = aiger_init();
+
+    if ( const char* msg = aiger_open_and_read_from_file( aig, filename.c_str() ) )
+    {
+      if ( error )
+      {
+        *error = boost::str( boost::format( "Cannot read %s: %s" ) % filename % msg );
+      }
+      aiger_reset( aig );
+      return false;
+    }
+
+    if ( aig->num_latches )
+    {
+      if ( error )
+      {
+        *error = "Sequential AIGs are not supported";
+      }
+      aiger_reset( aig );
+      return false;
+    }
+
+    /* inputs first, then AND gates in topological order */
+    aiger_reencode( aig );
+
+    std::vector<DdNode*> nodes( aig->maxvar + 1u );
+    nodes[0u] = Cudd_ReadLogicZero( bdd.cudd );
+    Cudd_Ref( nodes[0u] );
+
+    auto node = [&nodes]( unsigned lit ) { return Cudd_NotCond( nodes[aiger_lit2var( lit )], aiger_sign( lit ) ); };
+
+    for ( unsigned i = 0u; i < aig->num_inputs; ++i )
+    {
+      const aiger_symbol& input = aig->inputs[i];
+      DdNode* var = settings.input_generation_func( bdd.cudd, i );
+      Cudd_Ref( var );
+      nodes[aiger_lit2var( input.lit )] = var;
+      bdd.inputs.push_back( std::make_pair( input.name ? std::string( input.name ) : boost::str( boost::format( "i%d" ) % i ), var ) );
+    }
+
+    for ( unsigned i = 0u; i < aig->num_ands; ++i )
+    {
+      const aiger_and& a = aig->ands[i];
+      DdNode* f = Cudd_bddAnd( bdd.cudd, node( a.rhs0 ), node( a.rhs1 ) );
+      Cudd_Ref( f );
+      nodes[aiger_lit2var( a.lhs )] = f;
+    }
+
+    for ( unsigned i = 0u; i < aig->num_outputs; ++i )
+    {
+      const aiger_symbol& output = aig->outputs[i];
+      DdNode* f = node( output.lit );
+      Cudd_Ref( f );
+      bdd.outputs.push_back( std::make_pair( output.name ? std::string( output.name ) : boost::str( boost::format( "o%d" ) % i ), f ) );
+    }
+
+    for ( DdNode* f : nodes )
+    {
+      if ( f )
+      {
+        Cudd_RecursiveDeref( bdd.cudd, f );
+      }
+    }
+
+    aiger_reset( aig );
+    return true;
+  }
+
+  bool is_aiger_filename( const std::string& filename )
+  {
+    return boost::ends_with( filename, ".aig" ) || boost::ends_with( filename, ".aag" ) ||
+           boost::ends_with( filename, ".aig.gz" ) || boost::ends_with( filename, ".aag.gz" );
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
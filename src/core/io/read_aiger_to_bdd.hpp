@@ -0,0 +1,82 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file read_aiger_to_bdd.hpp
+ *
+ * @brief Reads a BDD from an AIGER file
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef READ_AIGER_TO_BDD_HPP
+#define READ_AIGER_TO_BDD_HPP
+
+#include <functional>
+#include <string>
+
+#include <core/io/read_pla_to_bdd.hpp>
+
+namespace revkit
+{
+
+  /**
+   * @since  2.0
+   */
+  struct read_aiger_to_bdd_settings
+  {
+    std::function<DdNode*(DdManager*, unsigned)> input_generation_func = []( DdManager* manager, unsigned pos ) { return Cudd_bddNewVar( manager ); };
+  };
+
+  /**
+   * @brief Reads a BDD from an AIGER file
+   *
+   * Both the binary (*.aig) and the ASCII (*.aag) format are
+   * supported.  The BDDs are built by traversing the AND gates
+   * in topological order.  Only combinational AIGs, i.e. without
+   * latches, can be read.  Missing input and output names are
+   * generated as in read_pla_to_bdd.
+   *
+   * @param bdd      Table to store the BDD nodes
+   * @param filename AIGER filename
+   * @param settings Settings
+   * @param error    A pointer to a string. In case the parsing fails,
+   *                 and \p error is not null, a error message is stored
+   *
+   * @return true on success, false otherwise
+   *
+   * @since  2.0
+   */
+  bool read_aiger_to_bdd( BDDTable& bdd, const std::string& filename, const read_aiger_to_bdd_settings& settings = read_aiger_to_bdd_settings(), std::string* error = 0 );
+
+  /**
+   * @brief Checks whether a filename has an AIGER extension
+   *
+   * @since  2.0
+   */
+  bool is_aiger_filename( const std::string& filename );
+
+}
+
+#endif /* READ_AIGER_TO_BDD_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
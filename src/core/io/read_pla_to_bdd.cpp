@@ -18,7 +18,9 @@
 #include "read_pla_to_bdd.hpp"
 
 #include <fstream>
+#include <thread>
 
+#include <boost/algorithm/cxx11/all_of.hpp>
 #include <boost/assign/std/vector.hpp>
 #include <boost/format.hpp>
 #include <boost/range/adaptor/map.hpp>
@@ -75,9 +77,9 @@ namespace revkit
       pla.type = type;
     }
 
-    void on_cube( const std::string& in, const std::string& out )
+    void on_cube_range( const pla_token& in, const pla_token& out )
     {
-      pla.cubes += std::make_pair( in, out );
+      pla.cubes.emplace_back( std::string( in.begin(), in.end() ), std::string( out.begin(), out.end() ) );
     }
   private:
     pla_t& pla;
@@ -115,11 +117,8 @@ namespace revkit
 
   bool parse( pla_t& pla, const std::string& filename )
   {
-    std::ifstream is;
-    is.open( filename.c_str(), std::ifstream::in );
-
     parse_pla_processor p( pla );
-    pla_parser( is, p );
+    pla_parser( filename, p );
 
     if ( !semantic_parse( pla ) )
     {
@@ -129,6 +128,90 @@ namespace revkit
     return true;
   }
 
+  /* AND of the literals of the input cube (referenced) */
+  DdNode* cube_product( DdManager* dd, const std::string& in, const std::vector<DdNode*>& vars )
+  {
+    DdNode *tmp, *var;
+    DdNode* prod = Cudd_ReadOne( dd );
+    Cudd_Ref( prod );
+
+    for ( unsigned i = 0u; i < vars.size(); ++i )
+    {
+      if ( in[i] == '-' ) continue;
+
+      var = in[i] == '0' ? Cudd_Not( vars[i] ) : vars[i];
+      tmp = Cudd_bddAnd( dd, prod, var );
+      Cudd_Ref( tmp );
+      Cudd_RecursiveDeref( dd, prod );
+      prod = tmp;
+    }
+
+    return prod;
+  }
+
+  /* ORs referenced nodes pairwise in a balanced tree and consumes them, the result is referenced */
+  DdNode* balanced_or( DdManager* dd, std::vector<DdNode*>& nodes )
+  {
+    if ( nodes.empty() )
+    {
+      DdNode* zero = Cudd_ReadLogicZero( dd );
+      Cudd_Ref( zero );
+      return zero;
+    }
+
+    while ( nodes.size() > 1u )
+    {
+      for ( unsigned i = 0u; i + 1u < nodes.size(); i += 2u )
+      {
+        DdNode* tmp = Cudd_bddOr( dd, nodes[i], nodes[i + 1u] );
+        Cudd_Ref( tmp );
+        Cudd_RecursiveDeref( dd, nodes[i] );
+        Cudd_RecursiveDeref( dd, nodes[i + 1u] );
+        nodes[i / 2u] = tmp;
+      }
+      if ( nodes.size() % 2u == 1u )
+      {
+        nodes[nodes.size() / 2u] = nodes.back();
+      }
+      nodes.resize( ( nodes.size() + 1u ) / 2u );
+    }
+
+    DdNode* result = nodes.front();
+    nodes.clear();
+    return result;
+  }
+
+  /* all outputs in one manager, cube products are shared among the outputs */
+  void build_outputs( DdManager* dd, const pla_t& pla, const std::vector<DdNode*>& vars, const std::vector<unsigned>& outputs, std::vector<DdNode*>& result )
+  {
+    std::vector<DdNode*> products;
+    for ( const auto& cube : pla.cubes )
+    {
+      products += cube_product( dd, cube.first, vars );
+    }
+
+    for ( unsigned o : outputs )
+    {
+      std::vector<DdNode*> terms;
+      for ( unsigned c = 0u; c < pla.cubes.size(); ++c )
+      {
+        const char v = pla.cubes[c].second[o];
+        if ( v == '0' || v == '~' ) continue;
+
+        Cudd_Ref( products[c] );
+        terms += products[c];
+      }
+      result += balanced_or( dd, terms );
+    }
+
+    boost::for_each( products, [dd]( DdNode* node ) { Cudd_RecursiveDeref( dd, node ); } );
+  }
+
+  bool is_projection( DdManager* dd, DdNode* node )
+  {
+    return !Cudd_IsComplement( node ) && !Cudd_IsConstant( node ) && Cudd_T( node ) == Cudd_ReadOne( dd ) && Cudd_E( node ) == Cudd_ReadLogicZero( dd );
+  }
+
   bool read_pla_to_bdd( BDDTable& bdd, const std::string& filename, const read_pla_to_bdd_settings& settings )
   {
     using boost::adaptors::map_values;
@@ -148,50 +231,70 @@ namespace revkit
     unsigned pos = 0u;
     boost::generate( bdd.inputs | map_values, [&settings, &bdd, &pos]() { return settings.input_generation_func( bdd.cudd, pos++ ); } );
 
-    // Outputs
-    boost::transform( pla.output_labels,
-                      std::back_inserter( bdd.outputs ),
-                      [&bdd]( const std::string& label ) { return std::make_pair( label, Cudd_ReadLogicZero( bdd.cudd ) ); } );
-    boost::for_each( bdd.outputs | map_values, Cudd_Ref );
+    std::vector<DdNode*> vars;
+    boost::push_back( vars, bdd.inputs | map_values );
 
-
-    // Iterate through cubes
-    for ( const auto& cube : pla.cubes )
+    // Outputs are only built in separate managers if they can be transferred back variable by variable
+    unsigned num_threads = std::min( settings.num_threads, *pla.num_outputs );
+    if ( !boost::algorithm::all_of( vars, [&bdd]( DdNode* node ) { return is_projection( bdd.cudd, node ); } ) )
     {
-      const std::string& in = cube.first;
-      const std::string& out = cube.second;
+      num_threads = 1u;
+    }
 
-      DdNode *tmp, *var;
-      DdNode* prod = Cudd_ReadOne( bdd.cudd );
-      Cudd_Ref( prod );
+    std::vector<DdNode*> nodes;
 
-      for ( unsigned i = 0u; i < *pla.num_inputs; ++i )
+    if ( num_threads <= 1u )
+    {
+      build_outputs( bdd.cudd, pla, vars, boost::copy_range<std::vector<unsigned> >( boost::irange( 0u, *pla.num_outputs ) ), nodes );
+    }
+    else
+    {
+      std::vector<DdManager*> managers( num_threads );
+      std::vector<std::vector<unsigned> > outputs( num_threads );
+      std::vector<std::vector<DdNode*> > results( num_threads );
+      std::vector<std::thread> threads;
+
+      for ( unsigned o = 0u; o < *pla.num_outputs; ++o )
       {
-        if ( in[i] == '-' ) continue;
+        outputs[o % num_threads] += o;
+      }
 
-        var = bdd.inputs[i].second;
-        Cudd_Ref( var );
-        if ( in[i] == '0' ) var = Cudd_Not( var );
-        tmp = Cudd_bddAnd( bdd.cudd, prod, var );
-        Cudd_Ref( tmp );
-        Cudd_RecursiveDeref( bdd.cudd, prod );
-        Cudd_RecursiveDeref( bdd.cudd, var );
-        prod = tmp;
+      for ( unsigned t = 0u; t < num_threads; ++t )
+      {
+        threads.push_back( std::thread( [&, t]() {
+              managers[t] = Cudd_Init( 0, 0, CUDD_UNIQUE_SLOTS, CUDD_CACHE_SLOTS, 0 );
+
+              /* same variable indexes as in the target manager */
+              std::vector<DdNode*> local_vars;
+              for ( DdNode* var : vars )
+              {
+                local_vars += Cudd_bddIthVar( managers[t], Cudd_NodeReadIndex( var ) );
+              }
+
+              build_outputs( managers[t], pla, local_vars, outputs[t], results[t] );
+            } ) );
       }
 
-      for ( unsigned i = 0u; i < *pla.num_outputs; ++i )
+      nodes.resize( *pla.num_outputs );
+      for ( unsigned t = 0u; t < num_threads; ++t )
       {
-        if ( out[i] == '0' || out[i] == '~' ) continue;
+        threads[t].join();
 
-        tmp = Cudd_bddOr( bdd.cudd, bdd.outputs[i].second, prod );
-        Cudd_Ref( tmp );
-        Cudd_RecursiveDeref( bdd.cudd, bdd.outputs[i].second );
-        bdd.outputs[i].second = tmp;
-      }
+        for ( unsigned i = 0u; i < outputs[t].size(); ++i )
+        {
+          DdNode* node = Cudd_bddTransfer( managers[t], bdd.cudd, results[t][i] );
+          Cudd_Ref( node );
+          Cudd_RecursiveDeref( managers[t], results[t][i] );
+          nodes[outputs[t][i]] = node;
+        }
 
-      Cudd_RecursiveDeref( bdd.cudd, prod );
+        Cudd_Quit( managers[t] );
+      }
     }
 
+    boost::transform( pla.output_labels, nodes, std::back_inserter( bdd.outputs ),
+                      []( const std::string& label, DdNode* node ) { return std::make_pair( label, node ); } );
+
     return true;
   }
 
@@ -245,16 +348,19 @@ namespace revkit
       ys = tmp;
     }
 
+    // Input patterns of f, maintained incrementally; new parts of f are
+    // collected in pending and only ORed (in a balanced tree) into f when
+    // f is needed, i.e., when input cubes overlap
+    DdNode *h = Cudd_ReadLogicZero( bdd.cudd );
+    Cudd_Ref( h );
+    std::vector<DdNode*> pending;
+
     // Iterate through cubes
     for ( const auto& cube : pla.cubes )
     {
       const std::string& in = cube.first;
       const std::string& out = cube.second;
 
-      // Input patterns of f
-      DdNode *h = Cudd_bddExistAbstract( bdd.cudd, f, ys );
-      Cudd_Ref( h );
-
       // Input cube
       DdNode* input = Cudd_ReadOne( bdd.cudd );
       Cudd_Ref( input );
@@ -289,29 +395,58 @@ namespace revkit
       tmp2 = Cudd_bddAnd( bdd.cudd, tmp, output );
       Cudd_Ref( tmp2 );
       Cudd_RecursiveDeref( bdd.cudd, tmp );
-      tmp = Cudd_bddOr( bdd.cudd, f, tmp2 );
-      Cudd_Ref( tmp );
-      Cudd_RecursiveDeref( bdd.cudd, f );
-      Cudd_RecursiveDeref( bdd.cudd, tmp2 );
-      f = tmp;
+      pending += tmp2;
 
       // Update outputs
-      tmp = Cudd_bddAnd( bdd.cudd, h, input );
-      Cudd_Ref( tmp );
-      tmp2 = Cudd_bddOr( bdd.cudd, Cudd_Not( tmp ), output ); // h => output
-      Cudd_Ref( tmp2 );
-      Cudd_RecursiveDeref( bdd.cudd, tmp );
-      tmp = Cudd_bddAnd( bdd.cudd, f, tmp2 );
-      Cudd_Ref( tmp );
-      Cudd_RecursiveDeref( bdd.cudd, tmp2 );
-      f = tmp;
+      DdNode *overlap = Cudd_bddAnd( bdd.cudd, h, input );
+      Cudd_Ref( overlap );
+
+      if ( overlap != Cudd_ReadLogicZero( bdd.cudd ) )
+      {
+        pending += f;
+        f = balanced_or( bdd.cudd, pending );
+
+        tmp2 = Cudd_bddOr( bdd.cudd, Cudd_Not( overlap ), output ); // h => output
+        Cudd_Ref( tmp2 );
+        tmp = Cudd_bddAnd( bdd.cudd, f, tmp2 );
+        Cudd_Ref( tmp );
+        Cudd_RecursiveDeref( bdd.cudd, tmp2 );
+        Cudd_RecursiveDeref( bdd.cudd, f );
+        f = tmp;
+
+        // overlapping input patterns remain only if some of their outputs are left
+        DdNode *left = Cudd_bddAndAbstract( bdd.cudd, f, overlap, ys );
+        Cudd_Ref( left );
+        tmp = Cudd_bddOr( bdd.cudd, Cudd_Not( overlap ), left );
+        Cudd_Ref( tmp );
+        Cudd_RecursiveDeref( bdd.cudd, left );
+        tmp2 = Cudd_bddOr( bdd.cudd, h, input );
+        Cudd_Ref( tmp2 );
+        Cudd_RecursiveDeref( bdd.cudd, h );
+        h = Cudd_bddAnd( bdd.cudd, tmp2, tmp );
+        Cudd_Ref( h );
+        Cudd_RecursiveDeref( bdd.cudd, tmp );
+        Cudd_RecursiveDeref( bdd.cudd, tmp2 );
+      }
+      else
+      {
+        // the new part of f covers all inputs of the cube, since output is never empty
+        tmp = Cudd_bddOr( bdd.cudd, h, input );
+        Cudd_Ref( tmp );
+        Cudd_RecursiveDeref( bdd.cudd, h );
+        h = tmp;
+      }
 
       // Cleanup
+      Cudd_RecursiveDeref( bdd.cudd, overlap );
       Cudd_RecursiveDeref( bdd.cudd, input );
       Cudd_RecursiveDeref( bdd.cudd, output );
-      Cudd_RecursiveDeref( bdd.cudd, h );
     }
 
+    pending += f;
+    f = balanced_or( bdd.cudd, pending );
+    Cudd_RecursiveDeref( bdd.cudd, h );
+
     // Assign 0s
     for ( unsigned i = 0u; i < *pla.num_outputs; ++i )
     {
@@ -99,6 +99,18 @@ namespace revkit
   struct read_pla_to_bdd_settings
   {
     std::function<DdNode*(DdManager*, unsigned)> input_generation_func = []( DdManager* manager, unsigned pos ) { return Cudd_bddNewVar( manager ); };
+
+    /**
+     * @brief Number of threads for building the output BDDs
+     *
+     * If larger than 1, the outputs are distributed among separate
+     * CUDD managers that are built concurrently and afterwards
+     * transferred into the target manager.  This requires that
+     * input_generation_func returns variables.
+     *
+     * @since  2.0
+     */
+    unsigned num_threads = 1u;
   };
 
   /**
@@ -0,0 +1,152 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file cancellation_token.hpp
+ *
+ * @brief Cooperative cancellation of long running algorithms
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef CANCELLATION_TOKEN_HPP
+#define CANCELLATION_TOKEN_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace revkit {
+
+  /**
+   * @brief Token which is checked by an algorithm to stop early
+   *
+   * A token is cancelled explicitly with cancel() or when its
+   * time-out has passed.  Copies share their state, such that a
+   * token can be passed to an algorithm, e.g. with the setting
+   * \b cancellation_token, and cancelled by the caller from another
+   * thread.  Algorithms call is_cancelled() regularly and return
+   * \b false if it holds.
+   *
+   * A default constructed token is never cancelled.
+   *
+   * Algorithms which are run by a \ref revkit::worker_pool "worker_pool"
+   * find the token of their job in current(), which is why they
+   * use it as default value of the setting \b cancellation_token.
+   *
+   * @since  2.0
+   */
+  class cancellation_token {
+  public:
+    /**
+     * @brief Creates a token
+     *
+     * @param timeout Time-out in milliseconds after which the
+     *                token is cancelled, 0u for no time-out
+     *
+     * @since  2.0
+     */
+    explicit cancellation_token( unsigned timeout = 0u )
+      : d( std::make_shared<state>() )
+    {
+      d->cancelled = false;
+      d->has_deadline = timeout != 0u;
+      d->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeout );
+    }
+
+    /**
+     * @brief Cancels the token and all its copies
+     *
+     * @since  2.0
+     */
+    void cancel() const {
+      d->cancelled = true;
+    }
+
+    /**
+     * @brief Checks whether the token was cancelled or timed out
+     *
+     * @since  2.0
+     */
+    bool is_cancelled() const {
+      if ( d->cancelled ) {
+        return true;
+      }
+
+      if ( d->has_deadline && std::chrono::steady_clock::now() >= d->deadline ) {
+        d->cancelled = true;
+        return true;
+      }
+
+      return false;
+    }
+
+    /**
+     * @brief Time point of the time-out
+     *
+     * Only meaningful if has_timeout() holds.
+     *
+     * @since  2.0
+     */
+    std::chrono::steady_clock::time_point deadline() const {
+      return d->deadline;
+    }
+
+    /**
+     * @brief Whether the token has a time-out
+     *
+     * @since  2.0
+     */
+    bool has_timeout() const {
+      return d->has_deadline;
+    }
+
+    /**
+     * @brief Token of the job running on this thread
+     *
+     * Assigned by \ref revkit::worker_pool "worker_pool" while it
+     * runs a job on this thread, such that the job can be cancelled
+     * without changing the settings of the algorithm.  Otherwise it
+     * is never cancelled.
+     *
+     * @since  2.0
+     */
+    static cancellation_token& current() {
+      static thread_local cancellation_token token;
+      return token;
+    }
+
+  private:
+    struct state {
+      std::atomic<bool> cancelled;
+      bool has_deadline;
+      std::chrono::steady_clock::time_point deadline;
+    };
+
+    std::shared_ptr<state> d;
+  };
+
+}
+
+#endif /* CANCELLATION_TOKEN_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
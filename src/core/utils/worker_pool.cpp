@@ -0,0 +1,182 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace revkit {
+
+  struct worker_job {
+    worker_pool::job_func job;
+    cancellation_token token;
+    bool started;
+    bool done;
+    bool finished;
+    bool abandoned;
+    std::exception_ptr error;
+  };
+
+  class worker_pool::priv {
+  public:
+    priv() : num_workers( 0u ), stop( false ) {}
+
+    /* runs on a detached thread, which keeps the pool data alive for abandoned jobs */
+    static void work( std::shared_ptr<priv> p ) {
+      std::unique_lock<std::mutex> lock( p->mutex );
+
+      while ( true ) {
+        p->job_available.wait( lock, [&p]() { return p->stop || !p->jobs.empty(); } );
+
+        if ( p->jobs.empty() ) {
+          if ( --p->num_workers == 0u ) {
+            p->workers_stopped.notify_all();
+          }
+          return;
+        }
+
+        std::shared_ptr<worker_job> j = p->jobs.front();
+        p->jobs.pop_front();
+
+        /* jobs which timed out while waiting are skipped */
+        if ( !j->token.is_cancelled() ) {
+          j->started = true;
+          lock.unlock();
+          cancellation_token::current() = j->token;
+          std::exception_ptr error;
+          try {
+            j->job( j->token );
+          }
+          catch ( ... ) {
+            error = std::current_exception();
+          }
+          cancellation_token::current() = cancellation_token();
+          lock.lock();
+
+          /* a job which stopped because of the time-out or an exception did not finish */
+          j->error = error;
+          j->finished = !error && !j->token.is_cancelled();
+        }
+
+        j->done = true;
+        p->job_done.notify_all();
+
+        /* a replacement has been started for this worker */
+        if ( j->abandoned ) {
+          return;
+        }
+      }
+    }
+
+    void start_worker( const std::shared_ptr<priv>& self ) {
+      std::thread( &priv::work, self ).detach();
+    }
+
+    std::mutex mutex;
+    std::condition_variable job_available;
+    std::condition_variable job_done;
+    std::condition_variable workers_stopped;
+
+    std::deque<std::shared_ptr<worker_job> > jobs;
+    unsigned num_workers;
+    bool stop;
+  };
+
+  /* result of a done job, an exception of the job is thrown in the waiting thread */
+  bool job_result( const worker_job& j )
+  {
+    if ( j.error ) {
+      std::rethrow_exception( j.error );
+    }
+    return j.finished;
+  }
+
+  worker_pool::worker_pool( unsigned num_workers )
+    : d( std::make_shared<priv>() )
+  {
+    std::lock_guard<std::mutex> lock( d->mutex );
+    d->num_workers = std::max( num_workers, 1u );
+    for ( unsigned i = 0u; i < d->num_workers; ++i ) {
+      d->start_worker( d );
+    }
+  }
+
+  worker_pool::~worker_pool()
+  {
+    std::unique_lock<std::mutex> lock( d->mutex );
+    d->stop = true;
+    for ( const auto& j : d->jobs ) {
+      j->token.cancel();
+    }
+    d->job_available.notify_all();
+
+    /* abandoned jobs are not waited for */
+    d->workers_stopped.wait( lock, [this]() { return d->num_workers == 0u; } );
+  }
+
+  bool worker_pool::run( const job_func& job, unsigned timeout )
+  {
+    auto j = std::make_shared<worker_job>();
+    j->job = job;
+    j->token = cancellation_token( timeout );
+    j->started = false;
+    j->done = false;
+    j->finished = false;
+    j->abandoned = false;
+
+    std::unique_lock<std::mutex> lock( d->mutex );
+    d->jobs.push_back( j );
+    d->job_available.notify_one();
+
+    if ( !timeout ) {
+      d->job_done.wait( lock, [&j]() { return j->done; } );
+      return job_result( *j );
+    }
+
+    if ( d->job_done.wait_until( lock, j->token.deadline(), [&j]() { return j->done; } ) ) {
+      return job_result( *j );
+    }
+
+    /* give the job the time-out once more to notice the cancellation */
+    j->token.cancel();
+    if ( d->job_done.wait_for( lock, std::chrono::milliseconds( timeout ), [&j]() { return j->done; } ) ) {
+      job_result( *j );
+      return false;
+    }
+
+    /* abandon the job and replace its worker, a waiting job is skipped by the workers */
+    if ( j->started ) {
+      j->abandoned = true;
+      d->start_worker( d );
+    }
+    return false;
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
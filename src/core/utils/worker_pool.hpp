@@ -0,0 +1,132 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file worker_pool.hpp
+ *
+ * @brief Worker threads for jobs with a time-out
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <functional>
+#include <memory>
+
+#include <core/utils/cancellation_token.hpp>
+
+namespace revkit {
+
+  /**
+   * @brief Runs jobs on worker threads and waits for them with a time-out
+   *
+   * This replaces running a job in a forked process with a CPU
+   * limit.  The job runs on a worker thread of the pool and
+   * receives a \ref revkit::cancellation_token "cancellation_token",
+   * which is also available as cancellation_token::current() on the
+   * worker thread and which the job should check regularly.  If the
+   * job does not finish in time, the token is cancelled and the job
+   * gets the time-out once more to stop.  A job which does not stop
+   * either is abandoned and its worker is replaced by a new thread,
+   * such that later jobs do not wait for it.  Since an abandoned job
+   * keeps running, a job should only write to data it owns.  An
+   * exception thrown by a job is rethrown by run(), unless the job
+   * has been abandoned.
+   *
+   * The worker threads are started on construction and stopped on
+   * destruction, which waits for running jobs but not for abandoned
+   * ones.
+   *
+   * @section sec_example_worker_pool Example
+   * @code
+   * revkit::worker_pool pool;
+   * auto result = std::make_shared<circuit>();
+   * if ( pool.run( [result]( const revkit::cancellation_token& token ) { ... }, 1000u ) )
+   * {
+   *   // finished within one second
+   * }
+   * @endcode
+   *
+   * @since  2.0
+   */
+  class worker_pool {
+  public:
+    /**
+     * @brief Type of a job
+     *
+     * @since  2.0
+     */
+    typedef std::function<void(const cancellation_token&)> job_func;
+
+    /**
+     * @brief Starts the worker threads
+     *
+     * With one worker, jobs never run concurrently, except for
+     * abandoned jobs which have not stopped yet.
+     *
+     * @param num_workers Number of worker threads
+     *
+     * @since  2.0
+     */
+    explicit worker_pool( unsigned num_workers = 1u );
+
+    /**
+     * @brief Cancels the waiting jobs and stops the worker threads
+     *
+     * @since  2.0
+     */
+    ~worker_pool();
+
+    /**
+     * @brief Runs a job and waits for it
+     *
+     * The time-out starts with the call, i.e. it includes the time
+     * the job waits for a free worker.  If the job is too slow, this
+     * waits at most the time-out once more for the job to stop before
+     * it is abandoned.
+     *
+     * @param job Job to run
+     * @param timeout Time-out in milliseconds, 0u for no time-out
+     *
+     * @return true, if the job finished in time
+     *
+     * @throw Any exception thrown by \p job before it is abandoned
+     *
+     * @since  2.0
+     */
+    bool run( const job_func& job, unsigned timeout = 0u );
+
+  private:
+    worker_pool( const worker_pool& );
+    worker_pool& operator=( const worker_pool& );
+
+    class priv;
+    std::shared_ptr<priv> const d;
+  };
+
+}
+
+#endif /* WORKER_POOL_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,82 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file binary_realization_p.hpp
+ *
+ * @brief Layout of the binary realization format
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+/** @cond */
+#ifndef BINARY_REALIZATION_P_HPP
+#define BINARY_REALIZATION_P_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <reversible/circuit.hpp>
+
+namespace revkit
+{
+
+  class binary_gate;
+
+  /*
+   * The file is a sequence of 32-bit words in host byte order.
+   * Strings are stored as length followed by the characters
+   * padded to a multiple of four bytes.
+   *
+   * file    := magic version circuit
+   * circuit := lines name inputs[lines] outputs[lines]
+   *            constants garbage inputbuses outputbuses statesignals
+   *            #modules { name circuit }*
+   *            #gates #words gate* #annotations { index key value }*
+   * buses   := #buses { name has_initial_value initial_value #lines line* }*
+   * gate    := kind | ( #targets << 8 ), #controls, [ module ],
+   *            { line << 1 | polarity }[#controls], line[#targets]
+   *
+   * The gate kinds are the values of binary_gate::kind_type.
+   * Constants and garbage are stored as one character per line
+   * as in the .constants and .garbage commands.
+   */
+  namespace binary_format
+  {
+    const std::uint32_t magic   = 0x43424b52u; /* "RKBC" */
+    const std::uint32_t version = 1u;
+
+    /* appends the words of g, module gates refer to module_index */
+    void pack_gate( const gate& g, const std::map<std::string, unsigned>& module_index, std::vector<std::uint32_t>& words );
+
+    /* adds lines and type of a packed gate to the empty gate target */
+    void unpack_gate( const binary_gate& g, const circuit& circ, const std::vector<std::string>& module_names, gate& target );
+  }
+
+}
+
+#endif /* BINARY_REALIZATION_P_HPP */
+/** @endcond */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
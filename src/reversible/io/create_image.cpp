@@ -18,7 +18,8 @@
 #include "create_image.hpp"
 
 #include <fstream>
-#include <sstream>
+#include <iomanip>
+#include <map>
 
 #include <boost/assign/std/vector.hpp>
 #include <boost/format.hpp>
@@ -47,6 +48,11 @@ namespace revkit
     os << draw_after_text;
   }
 
+  void create_image_settings::draw_block( std::ostream& os, float x1, float y1, float x2, float y2, unsigned num_gates ) const
+  {
+    draw_peres_frame( os, x1, y1, x2, y2 );
+  }
+
   //// class: create_pstricks_settings ////
 
   create_pstricks_settings::create_pstricks_settings()
@@ -69,7 +75,7 @@ namespace revkit
     os << boost::format( "\\psline[linewidth=%f](%f,%f)(%f,%f)" ) % line_width % x1 % y % x2 % y << std::endl;
   }
 
-  void create_pstricks_settings::draw_input( std::ostream& os, float x, float y, const std::string& text, bool is_constant ) const
+  void create_pstricks_settings::draw_input( std::ostream& os, float x, float y, const std::string& text, boost::optional<bool> is_constant ) const
   {
     std::string input = text;
     if ( math_emph )
@@ -121,6 +127,11 @@ namespace revkit
     os << boost::format( "\\psline[linewidth=%f](%f,%f)(%f,%f)" ) % line_width % x % y1 % x % y2 << std::endl;
   }
 
+  void create_pstricks_settings::draw_block( std::ostream& os, float x1, float y1, float x2, float y2, unsigned num_gates ) const
+  {
+    os << boost::format( "\\psframe[linewidth=%1%,fillstyle=solid,fillcolor=lightgray](%2%,%3%)(%4%,%5%)\\rput(%6%,%7%){\\tiny %8%}" ) % line_width % x1 % y1 % x2 % y2 % ( ( x1 + x2 ) / 2 ) % ( ( y1 + y2 ) / 2 ) % num_gates << std::endl;
+  }
+
   void create_pstricks_settings::draw_end( std::ostream& os ) const
   {
     os << "\\end{pspicture}" << std::endl;
@@ -148,7 +159,7 @@ namespace revkit
     os << boost::format( "\\draw[line width=%.2f] (%.2f,%.2f) -- (%.2f,%.2f);" ) % line_width % x1 % y % x2 % y << std::endl;
   }
 
-  void create_tikz_settings::draw_input( std::ostream& os, float x, float y, const std::string& text, bool is_constant ) const
+  void create_tikz_settings::draw_input( std::ostream& os, float x, float y, const std::string& text, boost::optional<bool> is_constant ) const
   {
     std::string input = text;
     if ( math_emph )
@@ -200,13 +211,240 @@ namespace revkit
     os << boost::format( "\\draw[line width=%.2f] (%.2f,%.2f) -- (%.2f,%.2f);" ) % line_width % x % y1 % x % y2 << std::endl;
   }
 
+  void create_tikz_settings::draw_block( std::ostream& os, float x1, float y1, float x2, float y2, unsigned num_gates ) const
+  {
+    os << boost::format( "\\draw[line width=%.2f,fill=lightgray] (%.2f,%.2f) rectangle (%.2f,%.2f) node[midway] {\\tiny %d};" ) % line_width % x1 % y1 % x2 % y2 % num_gates << std::endl;
+  }
+
   void create_tikz_settings::draw_end( std::ostream& os ) const
   {
     os << "\\end{tikzpicture}" << std::endl;
   }
 
+  //// class: create_svg_settings ////
+
+  /* escapes text for XML */
+  void write_svg_text( std::ostream& os, const std::string& text )
+  {
+    for ( char c : text )
+    {
+      switch ( c )
+      {
+      case '&': os << "&amp;"; break;
+      case '<': os << "&lt;"; break;
+      case '>': os << "&gt;"; break;
+      default: os << c; break;
+      }
+    }
+  }
+
+  create_svg_settings::create_svg_settings()
+    : font_size( 12 )
+  {
+    elem_width = 24;
+    elem_height = 24;
+    line_width = 1;
+    control_radius = 4;
+    target_radius = 8;
+  }
+
+  /* the y-axis of SVG points downwards, hence all y-coordinates are mirrored */
+  void create_svg_settings::draw_begin( std::ostream& os ) const
+  {
+    /* no exponent notation for wide images */
+    saved_flags = os.flags();
+    saved_precision = os.precision();
+    os << std::fixed << std::setprecision( 1 );
+    os << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height << "\">" << std::endl
+       << "<style>line,circle,rect{stroke:black;stroke-width:" << line_width << ";fill:none}"
+       << " .p{fill:black} .n{fill:white} .f{stroke-dasharray:4,2} .b{fill:lightgray}"
+       << " text{font-size:" << font_size << "px;dominant-baseline:middle} .i{text-anchor:end} .c{fill:red} .m{text-anchor:middle}</style>" << std::endl;
+  }
+
+  void create_svg_settings::draw_line( std::ostream& os, float x1, float x2, float y ) const
+  {
+    os << "<line x1=\"" << x1 << "\" y1=\"" << ( height - y ) << "\" x2=\"" << x2 << "\" y2=\"" << ( height - y ) << "\"/>" << std::endl;
+  }
+
+  void create_svg_settings::draw_input( std::ostream& os, float x, float y, const std::string& text, boost::optional<bool> is_constant ) const
+  {
+    os << "<text class=\"i" << ( is_constant ? " c" : "" ) << "\" x=\"" << ( x - 2 ) << "\" y=\"" << ( height - y ) << "\">";
+    write_svg_text( os, text );
+    os << "</text>" << std::endl;
+  }
+
+  void create_svg_settings::draw_output( std::ostream& os, float x, float y, const std::string& text, bool is_garbage ) const
+  {
+    os << "<text x=\"" << ( x + 2 ) << "\" y=\"" << ( height - y ) << "\">";
+    write_svg_text( os, text );
+    os << "</text>" << std::endl;
+  }
+
+  void create_svg_settings::draw_control( std::ostream& os, float x, float y, bool polarity ) const
+  {
+    os << "<circle class=\"" << ( polarity ? "p" : "n" ) << "\" cx=\"" << x << "\" cy=\"" << ( height - y ) << "\" r=\"" << control_radius << "\"/>" << std::endl;
+  }
+
+  void create_svg_settings::draw_targets( std::ostream& os, float x, const std::vector<float>& ys, const boost::any& target_tag ) const
+  {
+    if ( is_type<toffoli_tag>( target_tag ) )
+    {
+      float y = height - ys.at( 0 );
+      os << "<circle cx=\"" << x << "\" cy=\"" << y << "\" r=\"" << target_radius << "\"/>"
+         << "<line x1=\"" << x << "\" y1=\"" << ( y - target_radius ) << "\" x2=\"" << x << "\" y2=\"" << ( y + target_radius ) << "\"/>" << std::endl;
+    }
+    else if ( is_type<fredkin_tag>( target_tag ) )
+    {
+      for ( const auto& yt : ys )
+      {
+        float y = height - yt;
+        os << "<line x1=\"" << ( x - control_radius ) << "\" y1=\"" << ( y - control_radius ) << "\" x2=\"" << ( x + control_radius ) << "\" y2=\"" << ( y + control_radius ) << "\"/>"
+           << "<line x1=\"" << ( x - control_radius ) << "\" y1=\"" << ( y + control_radius ) << "\" x2=\"" << ( x + control_radius ) << "\" y2=\"" << ( y - control_radius ) << "\"/>" << std::endl;
+      }
+    }
+  }
+
+  void create_svg_settings::draw_peres_frame( std::ostream& os, float x1, float y1, float x2, float y2 ) const
+  {
+    os << "<rect class=\"f\" x=\"" << x1 << "\" y=\"" << ( height - y2 ) << "\" width=\"" << ( x2 - x1 ) << "\" height=\"" << ( y2 - y1 ) << "\"/>" << std::endl;
+  }
+
+  void create_svg_settings::draw_gate_line( std::ostream& os, float x, float y1, float y2 ) const
+  {
+    os << "<line x1=\"" << x << "\" y1=\"" << ( height - y1 ) << "\" x2=\"" << x << "\" y2=\"" << ( height - y2 ) << "\"/>" << std::endl;
+  }
+
+  void create_svg_settings::draw_block( std::ostream& os, float x1, float y1, float x2, float y2, unsigned num_gates ) const
+  {
+    os << "<rect class=\"b\" x=\"" << x1 << "\" y=\"" << ( height - y2 ) << "\" width=\"" << ( x2 - x1 ) << "\" height=\"" << ( y2 - y1 ) << "\"/>"
+       << "<text class=\"m\" x=\"" << ( ( x1 + x2 ) / 2 ) << "\" y=\"" << ( height - ( y1 + y2 ) / 2 ) << "\">" << num_gates << "</text>" << std::endl;
+  }
+
+  void create_svg_settings::draw_end( std::ostream& os ) const
+  {
+    os << "</svg>" << std::endl;
+    os.flags( saved_flags );
+    os.precision( saved_precision );
+  }
+
   //// function: create_image ////
 
+  /* lines spanned by a gate and the number of columns it needs */
+  struct gate_extent
+  {
+    explicit gate_extent( const gate& g )
+      : first( ~0u ), last( 0u ), width( is_peres( g ) ? 2u : 1u )
+    {
+      for ( const auto& v : g.controls() )
+      {
+        first = std::min( first, v.line() );
+        last = std::max( last, v.line() );
+      }
+      for ( const auto& t : g.targets() )
+      {
+        first = std::min( first, t );
+        last = std::max( last, t );
+      }
+    }
+
+    unsigned first;
+    unsigned last;
+    unsigned width;
+  };
+
+  /* assigns gates in their order to columns.  In compact mode a gate is put
+     into the current column unless it overlaps a gate in there, hence only
+     the occupied intervals of the current column are stored. */
+  class column_layout
+  {
+  public:
+    explicit column_layout( bool compact ) : compact( compact ) {}
+
+    unsigned add( const gate_extent& e )
+    {
+      if ( !used || !compact || e.width > 1u || width > 1u || overlaps( e ) )
+      {
+        if ( used )
+        {
+          column += width;
+        }
+        occupied.clear();
+        width = e.width;
+        used = true;
+      }
+
+      occupied[e.first] = e.last;
+      return column;
+    }
+
+    unsigned columns() const
+    {
+      return used ? column + width : 0u;
+    }
+
+  private:
+    bool overlaps( const gate_extent& e ) const
+    {
+      /* intervals are disjoint, only the last one starting before e.last can overlap */
+      auto it = occupied.upper_bound( e.last );
+      if ( it == occupied.begin() )
+      {
+        return false;
+      }
+      return ( --it )->second >= e.first;
+    }
+
+    bool compact;
+    bool used = false;
+    unsigned column = 0u;
+    unsigned width = 0u;
+    std::map<unsigned, unsigned> occupied;
+  };
+
+  void draw_gate( std::ostream& os, const gate& g, const gate_extent& e, float x, create_image_settings& settings )
+  {
+    auto ypos = [&settings]( unsigned line ) { return settings.height - ( line + 0.5 ) * settings.elem_height; };
+
+    if ( !is_peres( g ) )
+    {
+      settings.draw_gate_line( os, x, ypos( e.last ), ypos( e.first ) );
+
+      for ( const auto& v : g.controls() )
+      {
+        settings.draw_control( os, x, ypos( v.line() ), v.polarity() );
+      }
+
+      std::vector<float> ys;
+      boost::transform( g.targets(), std::back_inserter( ys ), ypos );
+      settings.draw_targets( os, x, ys, g.type() );
+    }
+    else
+    {
+      std::vector<float> yts;
+
+      float y = ypos( g.controls().front().line() );
+      float yt1 = ypos( g.targets().at( 0u ) );
+      float yt2 = ypos( g.targets().at( 1u ) );
+
+      settings.draw_gate_line( os, x, std::min( std::min( y, yt1 ), yt2 ), std::max( std::max( y, yt1 ), yt2 ) );
+      settings.draw_gate_line( os, x + settings.elem_width, std::min( y, yt1 ), std::max( y, yt1 ) );
+
+      settings.draw_peres_frame( os, x - settings.elem_width / 2, std::min( std::min( y, yt1 ), yt2 ) - settings.elem_height / 2,
+                                 x + settings.elem_width + settings.elem_width / 2, std::max( std::max( y, yt1 ), yt2 ) + settings.elem_height / 2 );
+
+      settings.draw_control( os, x, y, g.controls().front().polarity() );
+      settings.draw_control( os, x + settings.elem_width, y, g.controls().front().polarity() );
+
+      yts += yt1;
+      settings.draw_control( os, x, yt1, true );
+      settings.draw_targets( os, x + settings.elem_width, yts, toffoli_tag() );
+
+      yts.clear();
+      yts += yt2;
+      settings.draw_targets( os, x, yts, toffoli_tag() );
+    }
+  }
+
   void create_image( std::ostream& os, const circuit& circ, create_image_settings& settings )
   {
     if ( circ.num_gates() == 0 || circ.lines() == 0 )
@@ -214,9 +452,26 @@ namespace revkit
       return;
     }
 
-    unsigned peres_count = std::count_if( circ.begin(), circ.end(), [](const gate& g) { return is_peres( g ); } );
+    /* first pass: number of columns */
+    unsigned num_columns;
+    {
+      column_layout layout( settings.compact );
+      for ( const auto& g : circ )
+      {
+        layout.add( gate_extent( g ) );
+      }
+      num_columns = layout.columns();
+    }
+
+    /* level of detail: columns per block */
+    unsigned group = 1u;
+    if ( settings.max_columns && num_columns > settings.max_columns )
+    {
+      group = ( num_columns + settings.max_columns - 1u ) / settings.max_columns;
+    }
+    unsigned drawn_columns = ( num_columns + group - 1u ) / group;
 
-    settings.width = settings.elem_width * ( 2 + circ.num_gates() + peres_count );
+    settings.width = settings.elem_width * ( 2 + drawn_columns );
     settings.height = settings.elem_height * circ.lines();
 
     settings.draw_begin( os );
@@ -239,63 +494,48 @@ namespace revkit
 
     settings.draw_in_between( os );
 
-    float x = settings.elem_width * 3 / 2;
+    /* second pass: draw gates or blocks */
+    column_layout layout( settings.compact );
+
+    unsigned block = 0u;
+    unsigned block_gates = 0u;
+    unsigned block_first = ~0u;
+    unsigned block_last = 0u;
+
+    auto draw_current_block = [&]() {
+      float bx = settings.elem_width * ( 1 + block );
+      settings.draw_block( os, bx + settings.elem_width / 8, settings.height - ( block_last + 0.75f ) * settings.elem_height,
+                           bx + settings.elem_width * 7 / 8, settings.height - ( block_first + 0.25f ) * settings.elem_height, block_gates );
+    };
 
     for ( const auto& g : circ )
     {
-      std::stringstream sstr;
+      gate_extent e( g );
+      unsigned column = layout.add( e );
 
-      if ( !is_peres( g ) )
+      if ( group == 1u )
       {
-        float ymin = settings.height;
-        float ymax = 0;
-
-        for ( const auto& v : g.controls() )
-        {
-          float y = settings.height - ( v.line() + 0.5 ) * settings.elem_height;
-          ymin = std::min( ymin, y );
-          ymax = std::max( ymax, y );
-          settings.draw_control( sstr, x, y, v.polarity() );
-        }
-
-        std::vector<float> ys;
-        boost::transform( g.targets(), std::back_inserter( ys ), [&settings]( unsigned target ) { return settings.height - ( target + 0.5 ) * settings.elem_height; } );
-        ymin = std::min( ymin, *std::min_element( ys.begin(), ys.end() ) );
-        ymax = std::max( ymax, *std::max_element( ys.begin(), ys.end() ) );
-        settings.draw_targets( sstr, x, ys, g.type() );
-
-        settings.draw_gate_line( os, x, ymin, ymax );
-
-        x += settings.elem_width;
+        draw_gate( os, g, e, settings.elem_width * 3 / 2 + column * settings.elem_width, settings );
+        continue;
       }
-      else
-      {
-        std::vector<float> yts;
-
-        float y = settings.height - ( g.controls().front().line() + 0.5 ) * settings.elem_height;
-        settings.draw_control( sstr, x, y, g.controls().front().polarity() );
-        settings.draw_control( sstr, x + settings.elem_width, y, g.controls().front().polarity() );
 
-        float yt1 = settings.height - ( g.targets().at( 0u ) + 0.5 ) * settings.elem_height;
-        yts += yt1;
-        settings.draw_control( sstr, x, yt1, true );
-        settings.draw_targets( sstr, x + settings.elem_width, yts, toffoli_tag() );
-
-        float yt2 = settings.height - ( g.targets().at( 1u ) + 0.5 ) * settings.elem_height;
-        yts.clear();
-        yts += yt2;
-        settings.draw_targets( sstr, x, yts, toffoli_tag() );
-
-        settings.draw_gate_line( os, x, std::min( std::min( y, yt1 ), yt2 ), std::max( std::max( y, yt1 ), yt2 ) );
-        settings.draw_gate_line( os, x + settings.elem_width, std::min( y, yt1 ), std::max( y, yt1 ) );
-
-        settings.draw_peres_frame( os, x - settings.elem_width / 2, std::min( std::min( y, yt1 ), yt2 ) - settings.elem_height / 2,
-                                   x + settings.elem_width + settings.elem_width / 2, std::max( std::max( y, yt1 ), yt2 ) + settings.elem_height / 2 );
-
-        x += 2 * settings.elem_width;
+      if ( column / group != block && block_gates )
+      {
+        draw_current_block();
+        block_gates = 0u;
+        block_first = ~0u;
+        block_last = 0u;
       }
 
-      os << sstr.str();
+      block = column / group;
+      ++block_gates;
+      block_first = std::min( block_first, e.first );
+      block_last = std::max( block_last, e.last );
+    }
+
+    if ( block_gates )
+    {
+      draw_current_block();
     }
 
     settings.draw_after( os );
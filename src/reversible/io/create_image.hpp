@@ -179,6 +179,24 @@ namespace revkit
     virtual void draw_end( std::ostream& os ) const = 0;
 
   public:
+    /**
+     * @brief Draws a block summarizing several gates
+     *
+     * Used instead of the gates if the circuit has more columns
+     * than max_columns.  The default implementation draws a
+     * frame as for Peres gates.
+     *
+     * @param os Output stream of the create_image function
+     * @param x1 Left X-coordinate
+     * @param y1 Bottom Y-coordinate
+     * @param x2 Right X-coordinate
+     * @param y2 Top Y-coordinate
+     * @param num_gates Number of gates in the block
+     *
+     * @since  2.0
+     */
+    virtual void draw_block( std::ostream& os, float x1, float y1, float x2, float y2, unsigned num_gates ) const;
+
     /**
      * @brief User callback for user-defined drawing before the circuit is painted
      *
@@ -300,6 +318,32 @@ namespace revkit
      * @since  1.0
      */
     std::string draw_after_text;
+
+    /**
+     * @brief Packs gates into shared columns
+     *
+     * If true, a gate is drawn in the same column as its
+     * predecessors as long as it does not overlap with any
+     * of them vertically.  The order of the gates is kept.
+     *
+     * Default value is \b false
+     *
+     * @since  2.0
+     */
+    bool compact = false;
+
+    /**
+     * @brief Maximum number of columns drawn
+     *
+     * If the circuit needs more columns, consecutive columns
+     * are summarized as blocks which are drawn with draw_block.
+     * A value of 0 means no limit.
+     *
+     * Default value is \b 0
+     *
+     * @since  2.0
+     */
+    unsigned max_columns = 0u;
   };
 
   /**
@@ -326,13 +370,14 @@ namespace revkit
 
     virtual void draw_begin( std::ostream& os ) const;
     virtual void draw_line( std::ostream& os, float x1, float x2, float y ) const;
-    virtual void draw_input( std::ostream& os, float x, float y, const std::string& text, bool is_constant ) const;
+    virtual void draw_input( std::ostream& os, float x, float y, const std::string& text, boost::optional<bool> is_constant ) const;
     virtual void draw_output( std::ostream& os, float x, float y, const std::string& text, bool is_garbage ) const;
 
     virtual void draw_control( std::ostream& os, float x, float y, bool polarity ) const;
     virtual void draw_targets( std::ostream& os, float x, const std::vector<float>& ys, const boost::any& target_tag ) const;
     virtual void draw_peres_frame( std::ostream& os, float x1, float y1, float x2, float y2 ) const;
     virtual void draw_gate_line( std::ostream& os, float x, float y1, float y2 ) const;
+    virtual void draw_block( std::ostream& os, float x1, float y1, float x2, float y2, unsigned num_gates ) const;
     virtual void draw_end( std::ostream& os ) const;
 
   public:
@@ -370,13 +415,14 @@ namespace revkit
 
     virtual void draw_begin( std::ostream& os ) const;
     virtual void draw_line( std::ostream& os, float x1, float x2, float y ) const;
-    virtual void draw_input( std::ostream& os, float x, float y, const std::string& text, bool is_constant ) const;
+    virtual void draw_input( std::ostream& os, float x, float y, const std::string& text, boost::optional<bool> is_constant ) const;
     virtual void draw_output( std::ostream& os, float x, float y, const std::string& text, bool is_garbage ) const;
 
     virtual void draw_control( std::ostream& os, float x, float y, bool polarity ) const;
     virtual void draw_targets( std::ostream& os, float x, const std::vector<float>& ys, const boost::any& target_tag ) const;
     virtual void draw_peres_frame( std::ostream& os, float x1, float y1, float x2, float y2 ) const;
     virtual void draw_gate_line( std::ostream& os, float x, float y1, float y2 ) const;
+    virtual void draw_block( std::ostream& os, float x1, float y1, float x2, float y2, unsigned num_gates ) const;
     virtual void draw_end( std::ostream& os ) const;
 
   public:
@@ -390,6 +436,58 @@ namespace revkit
     bool math_emph;
   };
 
+  /**
+   * @brief Implementation of create_image_settings for generating SVG
+   *
+   * The image can be viewed directly in a browser, which does
+   * not require compiling LaTeX code for large circuits.  The
+   * elements are styled by CSS classes in the header.
+   *
+   * @since  2.0
+   */
+  class create_svg_settings : public create_image_settings
+  {
+  public:
+    /**
+     * @brief Default constructor
+     *
+     * Sizes are given in pixels.
+     *
+     * @since  2.0
+     */
+    create_svg_settings();
+
+    /** @cond false */
+    virtual ~create_svg_settings() {}
+    /** @endcond */
+
+    virtual void draw_begin( std::ostream& os ) const;
+    virtual void draw_line( std::ostream& os, float x1, float x2, float y ) const;
+    virtual void draw_input( std::ostream& os, float x, float y, const std::string& text, boost::optional<bool> is_constant ) const;
+    virtual void draw_output( std::ostream& os, float x, float y, const std::string& text, bool is_garbage ) const;
+    virtual void draw_control( std::ostream& os, float x, float y, bool polarity ) const;
+    virtual void draw_targets( std::ostream& os, float x, const std::vector<float>& ys, const boost::any& target_tag ) const;
+    virtual void draw_peres_frame( std::ostream& os, float x1, float y1, float x2, float y2 ) const;
+    virtual void draw_gate_line( std::ostream& os, float x, float y1, float y2 ) const;
+    virtual void draw_block( std::ostream& os, float x1, float y1, float x2, float y2, unsigned num_gates ) const;
+    virtual void draw_end( std::ostream& os ) const;
+
+  public:
+    /**
+     * @brief Font size of inputs, outputs and block labels in pixels
+     *
+     * Default value is \b 12.
+     *
+     * @since  2.0
+     */
+    float font_size;
+
+  private:
+    /* format of the output stream, restored in draw_end */
+    mutable std::ios_base::fmtflags saved_flags = std::ios_base::dec;
+    mutable std::streamsize saved_precision = 6;
+  };
+
   /**
    * @brief Create image from circuit \p circ and write it to \p os
    *
@@ -401,6 +499,12 @@ namespace revkit
    * In order to write to an unsupported format, derive a class from create_image_settings
    * and re-implement the abstract methods.
    *
+   * Gates are assigned to columns in a first pass, which also
+   * packs them if create_image_settings::compact is set, and
+   * drawn in a second pass.  If there are more columns than
+   * create_image_settings::max_columns, blocks of consecutive
+   * columns are drawn instead of the gates.
+   *
    * @param os Output stream to write the image to
    * @param circ Circuit
    * @param settings The settings for painting which provides as well the painting methods
@@ -0,0 +1,422 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "read_binary_realization.hpp"
+
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <reversible/target_tags.hpp>
+
+#include "binary_realization_p.hpp"
+
+namespace revkit
+{
+
+  namespace binary_format
+  {
+    void unpack_gate( const binary_gate& g, const circuit& circ, const std::vector<std::string>& module_names, gate& target )
+    {
+      for ( unsigned j = 0u; j < g.num_controls(); ++j )
+      {
+        target.add_control( g.control( j ) );
+      }
+      for ( unsigned j = 0u; j < g.num_targets(); ++j )
+      {
+        target.add_target( g.target( j ) );
+      }
+
+      switch ( g.kind() )
+      {
+      case binary_gate::toffoli:
+        target.set_type( toffoli_tag() );
+        break;
+
+      case binary_gate::fredkin:
+        target.set_type( fredkin_tag() );
+        break;
+
+      case binary_gate::peres:
+        target.set_type( peres_tag() );
+        break;
+
+      case binary_gate::module:
+        {
+          module_tag module_t;
+          module_t.name = module_names[g.module_index()];
+          module_t.reference = circ.modules().find( module_t.name )->second;
+          target.set_type( module_t );
+        }
+        break;
+      }
+    }
+  }
+
+  /* read-only mapping of a whole file */
+  class mapped_file
+  {
+  public:
+    ~mapped_file()
+    {
+      if ( data != MAP_FAILED )
+      {
+        munmap( data, size );
+      }
+    }
+
+    bool open( const std::string& filename, std::string* error )
+    {
+      int fd = ::open( filename.c_str(), O_RDONLY );
+      if ( fd == -1 )
+      {
+        if ( error )
+        {
+          *error = "Cannot open " + filename;
+        }
+        return false;
+      }
+
+      struct stat sb;
+      if ( fstat( fd, &sb ) == 0 && sb.st_size > 0 )
+      {
+        size = sb.st_size;
+        data = mmap( 0, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      }
+      close( fd );
+
+      if ( data == MAP_FAILED )
+      {
+        if ( error )
+        {
+          *error = "Cannot map " + filename;
+        }
+        return false;
+      }
+
+      return true;
+    }
+
+    const std::uint32_t* begin() const { return static_cast<const std::uint32_t*>( data ); }
+    const std::uint32_t* end() const { return begin() + size / sizeof( std::uint32_t ); }
+
+    void* data = MAP_FAILED;
+    std::size_t size = 0u;
+  };
+
+  /* bounds checked access to the words of the file */
+  class binary_reader
+  {
+  public:
+    binary_reader( const std::uint32_t* first, const std::uint32_t* last ) : pos( first ), last( last ) {}
+
+    bool get( std::uint32_t& word )
+    {
+      if ( pos == last ) { return false; }
+      word = *pos++;
+      return true;
+    }
+
+    bool get( std::string& s )
+    {
+      std::uint32_t length;
+      return get( length ) && get_chars( length, s );
+    }
+
+    bool get_chars( std::uint32_t length, std::string& s )
+    {
+      std::size_t words = ( length + 3u ) / 4u;
+      if ( std::size_t( last - pos ) < words ) { return false; }
+      s.assign( reinterpret_cast<const char*>( pos ), length );
+      pos += words;
+      return true;
+    }
+
+    bool skip( std::uint32_t words )
+    {
+      if ( std::size_t( last - pos ) < words ) { return false; }
+      pos += words;
+      return true;
+    }
+
+    const std::uint32_t* pos;
+    const std::uint32_t* last;
+  };
+
+  bool read_buses( binary_reader& r, unsigned lines, bus_collection& buses )
+  {
+    std::uint32_t num_buses;
+    if ( !r.get( num_buses ) ) { return false; }
+
+    for ( std::uint32_t i = 0u; i < num_buses; ++i )
+    {
+      std::string name;
+      std::uint32_t has_initial_value, initial_value, size;
+      if ( !r.get( name ) || !r.get( has_initial_value ) || !r.get( initial_value ) || !r.get( size ) ) { return false; }
+
+      std::vector<unsigned> line_indices( size );
+      for ( auto& l : line_indices )
+      {
+        std::uint32_t word;
+        if ( !r.get( word ) || word >= lines ) { return false; }
+        l = word;
+      }
+
+      buses.add( name, line_indices, has_initial_value ? boost::optional<unsigned>( initial_value ) : boost::optional<unsigned>() );
+    }
+
+    return true;
+  }
+
+  /* checks that the gate at pos fits into [pos, last) and only uses existing lines and modules */
+  bool check_gate( const std::uint32_t* pos, const std::uint32_t* last, unsigned lines, unsigned num_modules )
+  {
+    if ( last - pos < 2 ) { return false; }
+
+    binary_gate g( pos );
+    if ( g.kind() > binary_gate::module ) { return false; }
+    if ( g.kind() == binary_gate::module && ( last - pos < 3 || g.module_index() >= num_modules ) ) { return false; }
+    if ( std::uint64_t( last - pos ) < std::uint64_t( g.num_controls() ) + g.num_targets() + ( g.kind() == binary_gate::module ? 3u : 2u ) ) { return false; }
+
+    for ( unsigned i = 0u; i < g.num_controls(); ++i )
+    {
+      if ( g.control( i ).line() >= lines ) { return false; }
+    }
+    for ( unsigned i = 0u; i < g.num_targets(); ++i )
+    {
+      if ( g.target( i ) >= lines ) { return false; }
+    }
+
+    return true;
+  }
+
+  /* reads one circuit section; if gates is given, the gate words are only checked and their range is stored */
+  bool read_circuit( binary_reader& r, circuit& circ, std::pair<const std::uint32_t*, const std::uint32_t*>* gates = 0 )
+  {
+    std::uint32_t lines;
+    std::string name;
+    if ( !r.get( lines ) || !r.get( name ) ) { return false; }
+
+    circ.set_lines( lines );
+    circ.set_circuit_name( name );
+
+    std::vector<std::string> inputs( lines ), outputs( lines );
+    for ( auto& s : inputs )
+    {
+      if ( !r.get( s ) ) { return false; }
+    }
+    for ( auto& s : outputs )
+    {
+      if ( !r.get( s ) ) { return false; }
+    }
+    circ.set_inputs( inputs );
+    circ.set_outputs( outputs );
+
+    std::string sconstants, sgarbage;
+    if ( !r.get_chars( lines, sconstants ) || !r.get_chars( lines, sgarbage ) ) { return false; }
+
+    std::vector<constant> constants( lines );
+    std::vector<bool> garbage( lines );
+    for ( unsigned i = 0u; i < lines; ++i )
+    {
+      if ( sconstants[i] != '-' )
+      {
+        constants[i] = sconstants[i] == '1';
+      }
+      garbage[i] = sgarbage[i] == '1';
+    }
+    circ.set_constants( constants );
+    circ.set_garbage( garbage );
+
+    if ( !read_buses( r, lines, circ.inputbuses() ) || !read_buses( r, lines, circ.outputbuses() ) || !read_buses( r, lines, circ.statesignals() ) ) { return false; }
+
+    std::uint32_t num_modules;
+    if ( !r.get( num_modules ) ) { return false; }
+
+    std::vector<std::string> module_names( num_modules );
+    for ( auto& module_name : module_names )
+    {
+      std::shared_ptr<circuit> module( new circuit() );
+      if ( !r.get( module_name ) || !read_circuit( r, *module ) ) { return false; }
+      circ.add_module( module_name, module );
+    }
+
+    std::uint32_t num_gates, num_words;
+    if ( !r.get( num_gates ) || !r.get( num_words ) ) { return false; }
+
+    const std::uint32_t* pos = r.pos;
+    if ( !r.skip( num_words ) ) { return false; }
+    const std::uint32_t* last = r.pos;
+
+    if ( gates )
+    {
+      gates->first = pos;
+      gates->second = last;
+    }
+
+    for ( std::uint32_t i = 0u; i < num_gates; ++i )
+    {
+      if ( !check_gate( pos, last, lines, num_modules ) ) { return false; }
+
+      binary_gate g( pos );
+      pos += g.size();
+
+      if ( gates ) { continue; }
+
+      binary_format::unpack_gate( g, circ, module_names, circ.append_gate() );
+    }
+
+    if ( pos != last ) { return false; }
+
+    std::uint32_t num_annotations;
+    if ( !r.get( num_annotations ) ) { return false; }
+
+    for ( std::uint32_t i = 0u; i < num_annotations; ++i )
+    {
+      std::uint32_t index;
+      std::string key, value;
+      if ( !r.get( index ) || !r.get( key ) || !r.get( value ) || index >= num_gates ) { return false; }
+
+      if ( !gates )
+      {
+        circ.annotate( circ[index], key, value );
+      }
+    }
+
+    return true;
+  }
+
+  bool read_binary_header( binary_reader& r, const std::string& filename, std::string* error )
+  {
+    std::uint32_t magic, version;
+    if ( !r.get( magic ) || !r.get( version ) || magic != binary_format::magic || version != binary_format::version )
+    {
+      if ( error )
+      {
+        *error = filename + " is not a binary realization of this version and byte order";
+      }
+      return false;
+    }
+    return true;
+  }
+
+  ////////////////////////////// class binary_circuit_view
+  class binary_circuit_view::priv
+  {
+  public:
+    mapped_file file;
+    circuit metadata;
+    unsigned num_gates = 0u;
+    std::pair<const std::uint32_t*, const std::uint32_t*> gates;
+  };
+
+  binary_circuit_view::binary_circuit_view()
+    : d( new priv() )
+  {
+  }
+
+  binary_circuit_view::~binary_circuit_view()
+  {
+    delete d;
+  }
+
+  bool binary_circuit_view::open( const std::string& filename, std::string* error )
+  {
+    if ( !d->file.open( filename, error ) )
+    {
+      return false;
+    }
+
+    binary_reader r( d->file.begin(), d->file.end() );
+    if ( !read_binary_header( r, filename, error ) )
+    {
+      return false;
+    }
+
+    if ( !read_circuit( r, d->metadata, &d->gates ) )
+    {
+      if ( error )
+      {
+        *error = "Corrupt binary realization " + filename;
+      }
+      return false;
+    }
+
+    /* number of gates is stored right before the gate words */
+    d->num_gates = *( d->gates.first - 2 );
+
+    return true;
+  }
+
+  const circuit& binary_circuit_view::metadata() const
+  {
+    return d->metadata;
+  }
+
+  unsigned binary_circuit_view::num_gates() const
+  {
+    return d->num_gates;
+  }
+
+  binary_circuit_view::const_iterator binary_circuit_view::begin() const
+  {
+    return const_iterator( d->gates.first );
+  }
+
+  binary_circuit_view::const_iterator binary_circuit_view::end() const
+  {
+    return const_iterator( d->gates.second );
+  }
+
+  bool read_binary_realization( circuit& circ, const std::string& filename, std::string* error )
+  {
+    mapped_file file;
+    if ( !file.open( filename, error ) )
+    {
+      return false;
+    }
+
+    madvise( file.data, file.size, MADV_SEQUENTIAL );
+
+    binary_reader r( file.begin(), file.end() );
+    if ( !read_binary_header( r, filename, error ) )
+    {
+      return false;
+    }
+
+    if ( !read_circuit( r, circ ) )
+    {
+      if ( error )
+      {
+        *error = "Corrupt binary realization " + filename;
+      }
+      return false;
+    }
+
+    return true;
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
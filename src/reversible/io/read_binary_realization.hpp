@@ -0,0 +1,182 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file read_binary_realization.hpp
+ *
+ * @brief Reader for the binary realization format
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef READ_BINARY_REALIZATION_HPP
+#define READ_BINARY_REALIZATION_HPP
+
+#include <cstdint>
+#include <string>
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <reversible/circuit.hpp>
+
+namespace revkit
+{
+
+  /**
+   * @brief A gate inside a memory-mapped binary realization
+   *
+   * @since  2.0
+   */
+  class binary_gate
+  {
+  public:
+    /**
+     * @brief Gate kinds of the binary format
+     *
+     * @since  2.0
+     */
+    enum kind_type { toffoli = 0u, fredkin = 1u, peres = 2u, module = 3u };
+
+    explicit binary_gate( const std::uint32_t* data = 0 ) : data( data ) {}
+
+    kind_type kind() const { return static_cast<kind_type>( data[0] & 0xffu ); }
+    unsigned num_controls() const { return data[1]; }
+    unsigned num_targets() const { return data[0] >> 8u; }
+
+    /**
+     * @brief Index of the module in the module map of the circuit (only for module gates)
+     *
+     * @since  2.0
+     */
+    unsigned module_index() const { return data[2]; }
+
+    variable control( unsigned i ) const { return make_var( lines()[i] >> 1u, lines()[i] & 1u ); }
+    unsigned target( unsigned i ) const { return lines()[num_controls() + i]; }
+
+    /**
+     * @brief Number of words of this gate in the file
+     *
+     * @since  2.0
+     */
+    unsigned size() const { return 2u + ( kind() == module ? 1u : 0u ) + num_controls() + num_targets(); }
+
+  private:
+    const std::uint32_t* lines() const { return data + ( kind() == module ? 3u : 2u ); }
+
+    const std::uint32_t* data;
+  };
+
+  /**
+   * @brief Read-only view on a binary realization
+   *
+   * The file is memory-mapped and the gates are accessed in place,
+   * i.e. iterating over a view does not allocate any memory.  All
+   * other data is read into a circuit without gates, which is
+   * available via metadata().  Annotations are not part of the view.
+   *
+   * @code
+   * binary_circuit_view view;
+   * if ( view.open( "circuit.rbc" ) )
+   * {
+   *   for ( const auto& g : view ) { ... }
+   * }
+   * @endcode
+   *
+   * @since  2.0
+   */
+  class binary_circuit_view
+  {
+  public:
+    class const_iterator : public boost::iterator_facade<const_iterator, binary_gate, boost::forward_traversal_tag, binary_gate>
+    {
+    public:
+      const_iterator() {}
+      explicit const_iterator( const std::uint32_t* data ) : g( data ), data( data ) {}
+
+    private:
+      friend class boost::iterator_core_access;
+
+      void increment() { data += g.size(); g = binary_gate( data ); }
+      bool equal( const const_iterator& other ) const { return data == other.data; }
+      binary_gate dereference() const { return g; }
+
+      binary_gate g;
+      const std::uint32_t* data = 0;
+    };
+
+    binary_circuit_view();
+    ~binary_circuit_view();
+
+    /**
+     * @brief Maps a binary realization
+     *
+     * @param filename File written by write_binary_realization
+     * @param error    If not-null, an error message is written
+     *                 to this parameter in case the function fails
+     *
+     * @return true on success, false otherwise
+     *
+     * @since  2.0
+     */
+    bool open( const std::string& filename, std::string* error = 0 );
+
+    /**
+     * @brief Circuit with all data except the gates
+     *
+     * @since  2.0
+     */
+    const circuit& metadata() const;
+
+    unsigned num_gates() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+
+  private:
+    binary_circuit_view( const binary_circuit_view& );
+    binary_circuit_view& operator=( const binary_circuit_view& );
+
+    class priv;
+    priv* const d;
+  };
+
+  /**
+   * @brief Reads a binary realization into a circuit
+   *
+   * The file is memory-mapped and the gates are added from the
+   * packed gate array without parsing.
+   *
+   * @param circ     Empty circuit to be constructed
+   * @param filename File written by write_binary_realization
+   * @param error    If not-null, an error message is written
+   *                 to this parameter in case the function fails
+   *
+   * @return true on success, false otherwise
+   *
+   * @since  2.0
+   */
+  bool read_binary_realization( circuit& circ, const std::string& filename, std::string* error = 0 );
+
+}
+
+#endif /* READ_BINARY_REALIZATION_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -24,6 +24,7 @@
 #include <boost/assign/std/vector.hpp>
 #include <boost/range/algorithm.hpp>
 
+#include <core/io/compressed_stream.hpp>
 #include <core/io/pla_parser.hpp>
 #include <reversible/functions/extend_truth_table.hpp>
 
@@ -89,7 +90,7 @@ namespace revkit
       spec.set_outputs( output_labels );
     }
 
-    void on_cube( const std::string& in, const std::string& out )
+    void on_cube_range( const pla_token& in, const pla_token& out )
     {
       std::vector<boost::optional<bool> > cube_in( in.size() );
       boost::transform( in, cube_in.begin(), transform_pla_to_constants() );
@@ -142,7 +143,14 @@ namespace revkit
   bool read_pla( binary_truth_table& spec, std::istream& in, const read_pla_settings& settings, std::string* error )
   {
     read_pla_processor p( spec );
-    pla_parser( in, p, settings.skip_after_first_cube );
+    if ( !pla_parser( in, p, settings.skip_after_first_cube ) )
+    {
+      if ( error )
+      {
+        *error = "Cannot read the input stream, it may be corrupt or truncated";
+      }
+      return false;
+    }
 
     if ( settings.extend )
     {
@@ -154,8 +162,7 @@ namespace revkit
 
   bool read_pla( binary_truth_table& spec, const std::string& filename, const read_pla_settings& settings, std::string* error )
   {
-    std::ifstream is;
-    is.open( filename.c_str(), std::ifstream::in );
+    compressed_ifstream is( filename );
 
     if ( !is.good() )
     {
@@ -29,6 +29,8 @@
 #include <boost/regex.hpp>
 #include <boost/variant.hpp>
 
+#include <core/io/compressed_stream.hpp>
+
 #include "revlib_parser.hpp"
 #include "print_circuit.hpp"
 #include "../target_tags.hpp"
@@ -183,6 +185,69 @@ namespace revkit
     }
   }
 
+  void circuit_processor::on_gates( const revlib_gate_batch& batch ) const
+  {
+    circuit& circ = *d->circs.top();
+    const properties& p = *( current_annotations().get() );
+    std::vector<variable> line_indices;
+
+    for ( const auto& r : batch.gates )
+    {
+      auto first = batch.variables.begin() + r.first;
+      auto last = first + r.size;
+      assert( ( last - 1 )->polarity() ); /* target line must be positive */
+      gate* added_gate = 0;
+
+      switch ( r.kind )
+      {
+      case revlib_gate_batch::toffoli:
+        {
+          gate& g = circ.append_gate();
+          std::for_each( first, last - 1, [&g]( variable l ) { g.add_control( l ); } );
+          g.add_target( ( last - 1 )->line() );
+          g.set_type( toffoli_tag() );
+          added_gate = &g;
+        }
+        break;
+
+      case revlib_gate_batch::fredkin:
+        {
+          assert( r.size > 1u );
+          gate& g = circ.append_gate();
+          std::for_each( first, last - 2, [&g]( variable l ) { g.add_control( l ); } );
+          g.add_target( ( last - 2 )->line() );
+          g.add_target( ( last - 1 )->line() );
+          g.set_type( fredkin_tag() );
+          added_gate = &g;
+        }
+        break;
+
+      case revlib_gate_batch::peres:
+        assert( r.size == 3u );
+        added_gate = &append_peres( circ, *first, ( first + 1 )->line(), ( first + 2 )->line() );
+        break;
+
+      case revlib_gate_batch::module:
+        {
+          module_tag module_t;
+          module_t.name = batch.module_names.at( r.module );
+          line_indices.assign( first, last );
+          on_gate( module_t, line_indices );
+        }
+        break;
+      }
+
+      /* only set for gates read with annotations */
+      if ( added_gate )
+      {
+        for ( const auto& it : p )
+        {
+          circ.annotate( *added_gate, it.first, boost::any_cast<std::string>( it.second ) );
+        }
+      }
+    }
+  }
+
   void circuit_processor::on_end() const
   {
     d->circs.pop();
@@ -197,8 +262,7 @@ namespace revkit
 
   bool read_realization( circuit& circ, const std::string& filename, const read_realization_settings& settings, std::string* error )
   {
-    std::ifstream is;
-    is.open( filename.c_str(), std::ifstream::in );
+    compressed_ifstream is( filename );
 
     if ( !is.good() )
     {
@@ -211,6 +275,30 @@ namespace revkit
 
     boost::filesystem::path pfilename( filename );
     circuit_processor processor( circ );
+
+    if ( settings.num_threads > 1u )
+    {
+      std::vector<char> buffer;
+      std::size_t size = 0u;
+      do
+      {
+        buffer.resize( size + ( 1u << 20u ) );
+        is.read( &buffer[size], buffer.size() - size );
+        size += is.gcount();
+      } while ( is );
+
+      if ( is.bad() )
+      {
+        if ( error )
+        {
+          *error = "Cannot read " + filename + ", it may be corrupt or truncated";
+        }
+        return false;
+      }
+
+      return revlib_parser( buffer.data(), buffer.data() + size, processor, pfilename.parent_path().string(), settings.read_gates, settings.num_threads, error );
+    }
+
     return revlib_parser( is, processor, pfilename.parent_path().string(), settings.read_gates, error );
   }
 
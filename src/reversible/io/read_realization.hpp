@@ -89,6 +89,7 @@ namespace revkit
     virtual void on_state( const std::string& name, const std::vector<unsigned>& line_indices, unsigned initial_value ) const;
     virtual void on_module( const std::string& name, const boost::optional<std::string>& filename ) const;
     virtual void on_gate( const boost::any& target_type, const std::vector<variable>& line_indices ) const;
+    virtual void on_gates( const revlib_gate_batch& batch ) const;
     virtual void on_end() const;
 
   private:
@@ -102,6 +103,14 @@ namespace revkit
   struct read_realization_settings
   {
     bool read_gates = true;
+
+    /**
+     * @brief Number of threads to lex the gates when reading from a file
+     *
+     * For values greater than 1 the file is loaded into memory and
+     * parsed with revlib_parser(const char*, const char*, revlib_processor&, const std::string&, bool, unsigned, std::string*).
+     */
+    unsigned num_threads = 1u;
   };
 
   /**
@@ -20,6 +20,8 @@
 #include <fstream>
 #include <iostream>
 
+#include <core/io/compressed_stream.hpp>
+
 #include "revlib_parser.hpp"
 
 namespace revkit
@@ -103,8 +105,7 @@ namespace revkit
 
   bool read_specification( binary_truth_table& spec, const std::string& filename, std::string* error )
   {
-    std::ifstream is;
-    is.open( filename.c_str(), std::ifstream::in );
+    compressed_ifstream is( filename );
 
     if ( !is.good() )
     {
@@ -17,31 +17,28 @@
 
 #include "revlib_parser.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <locale>
 #include <map>
 #include <stack>
+#include <thread>
+#include <vector>
 
 #include <boost/algorithm/string/find.hpp>
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
-#include <boost/assign/std/vector.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/format.hpp>
 #include <boost/fusion/include/adapt_struct.hpp>
 #include <boost/fusion/include/io.hpp>
 #include <boost/lexical_cast.hpp>
-#include <boost/range/adaptors.hpp>
 #include <boost/range/algorithm.hpp>
-#include <boost/range/algorithm_ext/push_back.hpp>
 #include <boost/spirit/include/qi.hpp>
 
-#include "../target_tags.hpp"
 #include "revlib_processor.hpp"
 
-using namespace boost::assign;
-
 namespace revkit
 {
 
@@ -75,28 +72,177 @@ namespace revkit
     }
   };
 
-  // CODE move to utils
-  template<typename Map>
-  struct map_access_functor
+  /* flat open addressing table from variable names to line indices,
+     built once for each .variables command */
+  class variable_table
   {
-    explicit map_access_functor( Map& map )
-      : _map( map )
+  public:
+    static const unsigned npos = ~0u;
+
+    explicit variable_table( const std::vector<std::string>& names )
+      : names( names )
+    {
+      unsigned size = 2u;
+      while ( size < 2u * names.size() )
+      {
+        size <<= 1u;
+      }
+      slots.resize( size, 0u );
+
+      for ( unsigned i = 0u; i < names.size(); ++i )
+      {
+        unsigned h = hash( names[i].data(), names[i].size() ) & ( size - 1u );
+        while ( slots[h] )
+        {
+          h = ( h + 1u ) & ( size - 1u );
+        }
+        slots[h] = i + 1u;
+      }
+    }
+
+    unsigned find( const char* first, std::size_t length ) const
     {
+      const unsigned mask = slots.size() - 1u;
+      unsigned h = hash( first, length ) & mask;
+
+      while ( unsigned slot = slots[h] )
+      {
+        const std::string& name = names[slot - 1u];
+        if ( name.size() == length && std::equal( first, first + length, name.begin() ) )
+        {
+          return slot - 1u;
+        }
+        h = ( h + 1u ) & mask;
+      }
+
+      return npos;
     }
 
-    const typename Map::mapped_type& operator()( const typename Map::key_type& key ) const
+    unsigned find( const std::string& name ) const
     {
-      return _map.find( key )->second;
+      return find( name.data(), name.size() );
     }
 
   private:
-    Map& _map;
+    /* FNV-1a */
+    static unsigned hash( const char* first, std::size_t length )
+    {
+      unsigned h = 2166136261u;
+      for ( std::size_t i = 0u; i < length; ++i )
+      {
+        h = ( h ^ static_cast<unsigned char>( first[i] ) ) * 16777619u;
+      }
+      return h;
+    }
+
+    std::vector<std::string> names;
+    std::vector<unsigned> slots;
   };
 
-  template<typename Map>
-  map_access_functor<Map> make_map_access_functor( Map& map )
+  inline bool is_blank( char c )
   {
-    return map_access_functor<Map>( map );
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  bool lookup_lines( const std::vector<std::string>& names, const variable_table& table, std::vector<unsigned>& line_indices, std::string* error )
+  {
+    for ( const auto& name : names )
+    {
+      unsigned index = table.find( name );
+      if ( index == variable_table::npos )
+      {
+        if ( error )
+        {
+          *error = "Unknown variable: " + name;
+        }
+        return false;
+      }
+      line_indices.push_back( index );
+    }
+    return true;
+  }
+
+  /* appends the gate in [first, last), which must not contain comments, to batch */
+  bool lex_gate( const char* first, const char* last, const variable_table& table, revlib_gate_batch& batch, std::string* error )
+  {
+    const char* it = first;
+    while ( it != last && !is_blank( *it ) ) { ++it; }
+
+    revlib_gate_batch::record r;
+    r.module = 0u;
+    r.first = batch.variables.size();
+
+    const auto& modules = batch.module_names;
+    auto module = std::find_if( modules.begin(), modules.end(), [first, it]( const std::string& name ) {
+        return name.size() == std::size_t( it - first ) && std::equal( first, it, name.begin() ); } );
+
+    if ( module != modules.end() )
+    {
+      r.kind = revlib_gate_batch::module;
+      r.module = module - modules.begin();
+    }
+    else
+    {
+      switch ( *first )
+      {
+      case 't':
+        r.kind = revlib_gate_batch::toffoli;
+        break;
+
+      case 'p':
+        r.kind = revlib_gate_batch::peres;
+        break;
+
+      case 'f':
+        r.kind = revlib_gate_batch::fredkin;
+        break;
+
+      default:
+        if ( error )
+        {
+          *error = "unknown gate command: " + std::string( first, it );
+        }
+        return false;
+      }
+    }
+
+    while ( true )
+    {
+      while ( it != last && is_blank( *it ) ) { ++it; }
+      if ( it == last ) { break; }
+
+      const char* token = it;
+      while ( it != last && !is_blank( *it ) ) { ++it; }
+
+      bool polarity = *token != '-';
+      if ( !polarity ) { ++token; }
+
+      unsigned index = table.find( token, it - token );
+      if ( index == variable_table::npos )
+      {
+        if ( error )
+        {
+          *error = "Unknown variable in gate: " + std::string( token, it );
+        }
+        batch.variables.erase( batch.variables.begin() + r.first, batch.variables.end() );
+        return false;
+      }
+
+      batch.variables.push_back( make_var( index, polarity ) );
+    }
+
+    r.size = batch.variables.size() - r.first;
+    if ( !r.size )
+    {
+      if ( error )
+      {
+        *error = "Gate without lines: " + std::string( first, last );
+      }
+      return false;
+    }
+
+    batch.gates.push_back( r );
+    return true;
   }
 
   bool parse_string_list( const std::string& line, std::vector<std::string>& params )
@@ -145,402 +291,700 @@ namespace revkit
   }
 
 
-  bool revlib_parser( std::istream& in, revlib_processor& reader, const std::string& base_directory, bool read_gates, std::string* error )
+  /* gates between .begin and .end are collected and passed in batches */
+  const std::size_t batch_size = 4096u;
+
+  /* part of a chunk of the gate section lexed by a worker thread */
+  struct chunk_segment
   {
-    std::string line;
+    enum kind_type { gates, line, failure };
+
+    kind_type kind;
+    const char* first;
+    const char* last;
+    revlib_gate_batch batch;
+    std::string message;
+  };
 
-    unsigned numvars = 0;
-    unsigned truth_table_index = 0;
-    std::stack<std::map<std::string, unsigned> > variable_indices;
-    std::vector<std::string> module_names;
+  void lex_chunk( const char* first, const char* last, const variable_table& table, const std::vector<std::string>& module_names, std::vector<chunk_segment>& segments )
+  {
+    chunk_segment current;
+    current.kind = chunk_segment::gates;
+    current.first = first;
+    current.batch.module_names = module_names;
 
-    while ( in.good() && getline( in, line ) )
+    const char* pos = first;
+    while ( pos != last )
     {
-      /* clear previous annotations */
-      reader.clear_annotations();
+      const char* eol = std::find( pos, last, '\n' );
+      const char* lfirst = pos;
+      const char* llast = eol;
+      pos = ( eol == last ) ? last : eol + 1;
 
-      /* extract comments */
-      if ( boost::iterator_range<std::string::iterator> result = boost::algorithm::find_first( line, "#" ) )
+      while ( lfirst != llast && is_blank( *lfirst ) ) { ++lfirst; }
+      if ( lfirst == llast )
       {
-        std::string comment( result.begin() + 1u, line.end() );
+        continue;
+      }
 
-        if ( !comment.empty() && comment.at( 0u ) == '@' )
-        {
-          std::string sannotations( comment.begin() + 1u, comment.end() );
-          std::vector<boost::fusion::vector<std::string, std::string> > annotations;
-          boost::algorithm::trim( sannotations );
-          parse_annotations( sannotations, annotations );
+      if ( *lfirst != '.' && *lfirst != '-' && *lfirst != '0' && *lfirst != '1' && std::find( lfirst, llast, '#' ) == llast )
+      {
+        while ( is_blank( *( llast - 1 ) ) ) { --llast; }
 
-          for ( const auto& pair : annotations )
+        std::string message;
+        if ( !lex_gate( lfirst, llast, table, current.batch, &message ) )
+        {
+          if ( !current.batch.gates.empty() )
           {
-            reader.add_annotation( boost::fusion::at_c<0>( pair ), boost::fusion::at_c<1>( pair ) );
+            current.last = lfirst;
+            segments.push_back( std::move( current ) );
           }
+
+          /* the sequential parser reports the error at this position */
+          chunk_segment failure;
+          failure.kind = chunk_segment::failure;
+          failure.first = lfirst;
+          failure.last = last;
+          failure.message = message;
+          segments.push_back( std::move( failure ) );
+          return;
         }
-        else
+
+        if ( current.batch.gates.size() >= batch_size )
         {
-          reader.on_comment( comment );
+          current.last = pos;
+          segments.push_back( current );
+          current.batch.clear();
+          current.first = pos;
         }
-
-        line.erase( result.begin(), line.end() );
+        continue;
       }
 
-      boost::algorithm::trim( line );
-
-      /* skip empty lines */
-      if ( !line.size() )
+      /* lines with comments, annotations or commands are handled in order by the caller */
+      if ( !current.batch.gates.empty() )
       {
-        continue;
+        current.last = lfirst;
+        segments.push_back( current );
+        current.batch.clear();
       }
 
-      std::vector<std::string> params;
-      boost::algorithm::split( params, line, boost::algorithm::is_any_of( " " ) );
+      chunk_segment special;
+      special.kind = chunk_segment::line;
+      special.first = lfirst;
+      special.last = eol;
+      segments.push_back( std::move( special ) );
+
+      current.first = pos;
+    }
+
+    if ( !current.batch.gates.empty() )
+    {
+      current.last = last;
+      segments.push_back( std::move( current ) );
+    }
+  }
+
+  class revlib_parser_impl
+  {
+  public:
+    enum line_result { line_ok, line_error, line_stop };
+
+    revlib_parser_impl( revlib_processor& reader, const std::string& base_directory, bool read_gates, std::string* error )
+      : reader( reader ),
+        base_directory( base_directory ),
+        read_gates( read_gates ),
+        error( error )
+    {
+    }
 
-      /* It is possible that there are empty elements in params,
-         e.g. when line contains two spaces between identifiers instead of one.
-         These should be removed. */
-      std::vector<std::string>::iterator newEnd = std::remove( params.begin(), params.end(), "" );
-      params.erase( newEnd, params.end() );
+    bool parse_stream( std::istream& in )
+    {
+      std::string line;
 
-      /* By means of the first element we can determine the command */
-      std::string command = params.front();
-      params.erase( params.begin() );
+      while ( in.good() && getline( in, line ) )
+      {
+        switch ( process_line( line ) )
+        {
+        case line_error:
+          return false;
+        case line_stop:
+          return true;
+        default:
+          break;
+        }
+      }
 
-      if ( command == "#" )
+      if ( in.bad() )
       {
-        /* All parameters combined are considered as comment */
-        reader.on_comment( boost::algorithm::join( params, " " ) );
+        if ( error )
+        {
+          *error = "Cannot read the input stream, it may be corrupt or truncated";
+        }
+        return false;
       }
-      else if ( command == ".version" )
+
+      flush();
+      return true;
+    }
+
+    bool parse_memory( const char* first, const char* last, unsigned num_threads )
+    {
+      /* header up to the first .begin */
+      line_result r = parse_range( first, last, true );
+      if ( r != line_ok || first == last )
       {
-        /* All parameters combined are considered as version */
-        reader.on_version( boost::algorithm::join( params, " " ) );
+        return r != line_error;
       }
-      else if ( command == ".numvars" )
+
+      if ( num_threads > 1u && !variable_indices.empty() && batch.gates.empty() )
       {
-        if ( params.size() != 1 )
+        if ( !parse_gates_parallel( first, last, num_threads ) )
         {
-          if ( error )
-          {
-            *error = "Invalid number of parameters for .numvars command";
-          }
           return false;
         }
+      }
+
+      return parse_range( first, last, false ) != line_error;
+    }
+
+  private:
+    /* parses lines from first to last, or until the gate section starts */
+    line_result parse_range( const char*& first, const char* last, bool until_gates )
+    {
+      std::string line;
+
+      while ( first != last && !( until_gates && in_gates ) )
+      {
+        const char* eol = std::find( first, last, '\n' );
+        line.assign( first, eol );
+        first = ( eol == last ) ? last : eol + 1;
 
-        try
+        line_result r = process_line( line );
+        if ( r != line_ok )
         {
-          numvars = boost::lexical_cast<unsigned>( params.front() );
-          reader.on_numvars( numvars );
-        }
-        catch ( boost::bad_lexical_cast& )
-        {
-          if ( error )
-          {
-            *error = "Invalid parameter for .numvars command";
-          }
-          return false;
+          return r;
         }
       }
-      else if ( command == ".variables" )
+
+      flush();
+      return line_ok;
+    }
+
+    /* lexes the gate section in chunks and replays the callbacks in order;
+       first is advanced to where sequential parsing has to continue */
+    bool parse_gates_parallel( const char*& first, const char* last, unsigned num_threads )
+    {
+      /* chunks of at least 64K each and split at line boundaries */
+      num_threads = std::max( 1u, std::min<unsigned>( num_threads, ( last - first ) >> 16u ) );
+      if ( num_threads == 1u )
+      {
+        return true;
+      }
+
+      std::vector<const char*> bounds( num_threads + 1u, last );
+      bounds[0u] = first;
+      for ( unsigned i = 1u; i < num_threads; ++i )
       {
-        if ( params.size() != numvars )
+        const char* b = std::max( bounds[i - 1u], first + ( last - first ) / num_threads * i );
+        b = std::find( b, last, '\n' );
+        bounds[i] = ( b == last ) ? last : b + 1;
+      }
+
+      std::vector<std::vector<chunk_segment> > chunks( num_threads );
+      std::vector<std::thread> workers;
+      for ( unsigned i = 0u; i < num_threads; ++i )
+      {
+        workers.push_back( std::thread( lex_chunk, bounds[i], bounds[i + 1u], std::cref( variable_indices.top() ), std::cref( batch.module_names ), std::ref( chunks[i] ) ) );
+      }
+      for ( auto& worker : workers )
+      {
+        worker.join();
+      }
+
+      std::string line;
+      for ( auto& segments : chunks )
+      {
+        for ( auto& segment : segments )
         {
-          if ( error )
+          switch ( segment.kind )
           {
-            *error = "Variable count does not fit numvars";
+          case chunk_segment::gates:
+            reader.clear_annotations();
+            reader.on_gates( segment.batch );
+            break;
+
+          case chunk_segment::line:
+            line.assign( segment.first, segment.last );
+            if ( process_line( line ) == line_error )
+            {
+              return false;
+            }
+
+            /* commands may change the parser state, continue sequentially */
+            if ( *segment.first == '.' )
+            {
+              first = segment.last;
+              return true;
+            }
+            break;
+
+          case chunk_segment::failure:
+            if ( error )
+            {
+              *error = segment.message;
+            }
+            return false;
           }
-          return false;
         }
+      }
 
-        /* fill the index map later used when processing the gates */
-        std::map<std::string, unsigned> map;
-        for ( std::vector<std::string>::const_iterator it = params.begin(); it != params.end(); ++it )
-        {
-          map.insert( std::make_pair( *it, it - params.begin() ) );
-        }
-        variable_indices.push( map );
+      first = last;
+      return true;
+    }
 
-        reader.on_variables( params.begin(), params.end() );
+    void flush()
+    {
+      if ( !batch.gates.empty() )
+      {
+        reader.on_gates( batch );
+        batch.clear();
       }
-      else if ( command == ".inputs" )
+    }
+
+    line_result process_line( std::string& line )
+    {
+      /* fast path for gate lines without comments and annotations */
+      if ( in_gates && !variable_indices.empty() )
       {
-        // since the inputs can contain spaces in quotes we have to deal with
-        // them specifically
-        std::string inputs_str( line.begin() + command.size() + 1u, line.end() );
-        boost::algorithm::trim( inputs_str );
-        std::vector<std::string> inputs;
+        const char* first = line.data();
+        const char* last = first + line.size();
+        while ( first != last && is_blank( *first ) ) { ++first; }
 
-        if ( !parse_string_list( inputs_str, inputs ) )
+        if ( first == last )
         {
-          if ( error )
-          {
-            *error = "Cannot parse .input command";
-          }
-          return false;
+          return line_ok;
         }
 
-        if ( inputs.size() != numvars )
+        if ( *first != '.' && *first != '-' && *first != '0' && *first != '1' && std::find( first, last, '#' ) == last )
         {
-          if ( error )
+          while ( is_blank( *( last - 1 ) ) ) { --last; }
+
+          /* annotations of a previous line do not apply to batched gates */
+          if ( batch.gates.empty() )
           {
-            *error = "Input count does not fit numvars";
+            reader.clear_annotations();
+          }
+
+          if ( !lex_gate( first, last, variable_indices.top(), batch, error ) )
+          {
+            return line_error;
           }
-          return false;
-        }
 
-        reader.on_inputs( inputs.begin(), inputs.end() );
+          if ( batch.gates.size() >= batch_size )
+          {
+            flush();
+          }
+          return line_ok;
+        }
       }
-      else if ( command == ".outputs" )
+
+      /* keep the order of callbacks */
+      flush();
+
+      return parse_line( line );
+    }
+
+    line_result parse_line( std::string& line );
+
+    revlib_processor& reader;
+    const std::string& base_directory;
+    bool read_gates;
+    std::string* error;
+
+    unsigned numvars = 0u;
+    unsigned truth_table_index = 0u;
+    std::stack<variable_table> variable_indices;
+    revlib_gate_batch batch;
+    bool in_gates = false;
+  };
+
+  revlib_parser_impl::line_result revlib_parser_impl::parse_line( std::string& line )
+  {
+    /* clear previous annotations */
+    reader.clear_annotations();
+
+    /* extract comments */
+    if ( boost::iterator_range<std::string::iterator> result = boost::algorithm::find_first( line, "#" ) )
+    {
+      std::string comment( result.begin() + 1u, line.end() );
+
+      if ( !comment.empty() && comment.at( 0u ) == '@' )
       {
-        // see .inputs
-        std::string outputs_str( line.begin() + command.size() + 1u, line.end() );
-        boost::algorithm::trim( outputs_str );
-        std::vector<std::string> outputs;
+        std::string sannotations( comment.begin() + 1u, comment.end() );
+        std::vector<boost::fusion::vector<std::string, std::string> > annotations;
+        boost::algorithm::trim( sannotations );
+        parse_annotations( sannotations, annotations );
 
-        if ( !parse_string_list( outputs_str, outputs ) )
+        for ( const auto& pair : annotations )
         {
-          if ( error )
-          {
-            *error = "Cannot parse .output command";
-          }
-          return false;
+          reader.add_annotation( boost::fusion::at_c<0>( pair ), boost::fusion::at_c<1>( pair ) );
         }
+      }
+      else
+      {
+        reader.on_comment( comment );
+      }
+
+      line.erase( result.begin(), line.end() );
+    }
+
+    boost::algorithm::trim( line );
+
+    /* skip empty lines */
+    if ( !line.size() )
+    {
+      return line_ok;
+    }
+
+    std::vector<std::string> params;
+    boost::algorithm::split( params, line, boost::algorithm::is_any_of( " " ) );
 
-        if ( outputs.size() != numvars )
+    /* It is possible that there are empty elements in params,
+       e.g. when line contains two spaces between identifiers instead of one.
+       These should be removed. */
+    std::vector<std::string>::iterator newEnd = std::remove( params.begin(), params.end(), "" );
+    params.erase( newEnd, params.end() );
+
+    /* By means of the first element we can determine the command */
+    std::string command = params.front();
+    params.erase( params.begin() );
+
+    if ( command == "#" )
+    {
+      /* All parameters combined are considered as comment */
+      reader.on_comment( boost::algorithm::join( params, " " ) );
+    }
+    else if ( command == ".version" )
+    {
+      /* All parameters combined are considered as version */
+      reader.on_version( boost::algorithm::join( params, " " ) );
+    }
+    else if ( command == ".numvars" )
+    {
+      if ( params.size() != 1 )
+      {
+        if ( error )
         {
-          if ( error )
-          {
-            *error = "Output count does not fit numvars";
-          }
-          return false;
+          *error = "Invalid number of parameters for .numvars command";
         }
+        return line_error;
+      }
 
-        reader.on_outputs( outputs.begin(), outputs.end() );
+      try
+      {
+        numvars = boost::lexical_cast<unsigned>( params.front() );
+        reader.on_numvars( numvars );
       }
-      else if ( command == ".constants" )
+      catch ( boost::bad_lexical_cast& )
       {
-        if ( params.size() != 1 || params.front().size() != numvars )
+        if ( error )
         {
-          if ( error )
-          {
-            *error = "Constant count does not fit numvars";
-          }
-          return false;
+          *error = "Invalid parameter for .numvars command";
         }
-
-        std::vector<constant> constants( numvars );
-        std::transform( params.front().begin(), params.front().end(), constants.begin(), transform_to_constants() );
-
-        reader.on_constants( constants.begin(), constants.end() );
+        return line_error;
       }
-      else if ( command == ".garbage" )
+    }
+    else if ( command == ".variables" )
+    {
+      if ( params.size() != numvars )
       {
-        if ( params.size() != 1 || params.front().size() != numvars )
+        if ( error )
         {
-          if ( error )
-          {
-            *error = "Garbage count does not fit numvars";
-          }
-          return false;
+          *error = "Variable count does not fit numvars";
         }
+        return line_error;
+      }
+
+      /* fill the index table later used when processing the gates */
+      variable_indices.push( variable_table( params ) );
 
-        std::vector<bool> garbage( numvars );
-        std::transform( params.front().begin(), params.front().end(), garbage.begin(), transform_to_garbage() );
+      reader.on_variables( params.begin(), params.end() );
+    }
+    else if ( command == ".inputs" )
+    {
+      // since the inputs can contain spaces in quotes we have to deal with
+      // them specifically
+      std::string inputs_str( line.begin() + command.size() + 1u, line.end() );
+      boost::algorithm::trim( inputs_str );
+      std::vector<std::string> inputs;
 
-        reader.on_garbage( garbage.begin(), garbage.end() );
+      if ( !parse_string_list( inputs_str, inputs ) )
+      {
+        if ( error )
+        {
+          *error = "Cannot parse .input command";
+        }
+        return line_error;
       }
-      else if ( command == ".inputbus" )
+
+      if ( inputs.size() != numvars )
       {
-        if ( params.size() < 2u )
+        if ( error )
         {
-          if ( error )
-          {
-            *error = "Too few arguments in .inputbus command";
-          }
-          return false;
+          *error = "Input count does not fit numvars";
         }
+        return line_error;
+      }
 
-        std::vector<unsigned> line_indices( params.size() - 1u );
-        std::transform( params.begin() + 1u, params.end(), line_indices.begin(), make_map_access_functor( variable_indices.top() ) );
+      reader.on_inputs( inputs.begin(), inputs.end() );
+    }
+    else if ( command == ".outputs" )
+    {
+      // see .inputs
+      std::string outputs_str( line.begin() + command.size() + 1u, line.end() );
+      boost::algorithm::trim( outputs_str );
+      std::vector<std::string> outputs;
 
-        reader.on_inputbus( params.front(), line_indices );
-      }
-      else if ( command == ".outputbus" )
+      if ( !parse_string_list( outputs_str, outputs ) )
       {
-        if ( params.size() < 2u )
+        if ( error )
         {
-          if ( error )
-          {
-            *error = "Too few arguments in .outputbus command";
-          }
-          return false;
+          *error = "Cannot parse .output command";
         }
+        return line_error;
+      }
 
-        std::vector<unsigned> line_indices( params.size() - 1u );
-        std::transform( params.begin() + 1u, params.end(), line_indices.begin(), make_map_access_functor( variable_indices.top() ) );
-
-        reader.on_outputbus( params.front(), line_indices );
+      if ( outputs.size() != numvars )
+      {
+        if ( error )
+        {
+          *error = "Output count does not fit numvars";
+        }
+        return line_error;
       }
-      else if ( command == ".state" )
+
+      reader.on_outputs( outputs.begin(), outputs.end() );
+    }
+    else if ( command == ".constants" )
+    {
+      if ( params.size() != 1 || params.front().size() != numvars )
       {
-        if ( params.size() < 2u )
+        if ( error )
         {
-          if ( error )
-          {
-            *error = "Too few arguments in .state command";
-          }
-          return false;
+          *error = "Constant count does not fit numvars";
         }
+        return line_error;
+      }
 
-        boost::optional<unsigned> initial_value;
+      std::vector<constant> constants( numvars );
+      std::transform( params.front().begin(), params.front().end(), constants.begin(), transform_to_constants() );
 
-        if ( is_number( params.back() ) )
+      reader.on_constants( constants.begin(), constants.end() );
+    }
+    else if ( command == ".garbage" )
+    {
+      if ( params.size() != 1 || params.front().size() != numvars )
+      {
+        if ( error )
         {
-          if ( params.size() == 2u )
-          {
-            if ( error )
-            {
-              *error = "Too few arguments in .state command";
-            }
-            return false;
-          }
-
-          initial_value = boost::lexical_cast<unsigned>( params.back() );
+          *error = "Garbage count does not fit numvars";
         }
+        return line_error;
+      }
 
-        unsigned offset = initial_value ? 1u : 0u;
-
-        std::vector<unsigned> line_indices( params.size() - 1u - offset );
-        std::transform( params.begin() + 1u, params.end() - offset, line_indices.begin(), make_map_access_functor( variable_indices.top() ) );
+      std::vector<bool> garbage( numvars );
+      std::transform( params.front().begin(), params.front().end(), garbage.begin(), transform_to_garbage() );
 
-        reader.on_state( params.front(), line_indices, initial_value.get_value_or( 0u ) );
+      reader.on_garbage( garbage.begin(), garbage.end() );
+    }
+    else if ( command == ".inputbus" )
+    {
+      if ( params.size() < 2u )
+      {
+        if ( error )
+        {
+          *error = "Too few arguments in .inputbus command";
+        }
+        return line_error;
       }
-      else if ( command == ".module" )
+
+      std::vector<unsigned> line_indices;
+      if ( variable_indices.empty() || !lookup_lines( std::vector<std::string>( params.begin() + 1u, params.end() ), variable_indices.top(), line_indices, error ) )
       {
-        assert( params.size() <= 2u );
-        std::string name = params.front();
+        return line_error;
+      }
 
-        boost::optional<std::string> filename;
-        if ( params.size() == 2u )
+      reader.on_inputbus( params.front(), line_indices );
+    }
+    else if ( command == ".outputbus" )
+    {
+      if ( params.size() < 2u )
+      {
+        if ( error )
         {
-          filename = base_directory + "/" + params.back();
+          *error = "Too few arguments in .outputbus command";
         }
+        return line_error;
+      }
+
+      std::vector<unsigned> line_indices;
+      if ( variable_indices.empty() || !lookup_lines( std::vector<std::string>( params.begin() + 1u, params.end() ), variable_indices.top(), line_indices, error ) )
+      {
+        return line_error;
+      }
 
-        if ( filename && !boost::filesystem::exists( *filename ) )
+      reader.on_outputbus( params.front(), line_indices );
+    }
+    else if ( command == ".state" )
+    {
+      if ( params.size() < 2u )
+      {
+        if ( error )
         {
-          if ( error )
-          {
-            *error = boost::str( boost::format( "File for module %s not found" ) % name );
-          }
-          return false;
+          *error = "Too few arguments in .state command";
         }
+        return line_error;
+      }
 
-        module_names += name;
+      boost::optional<unsigned> initial_value;
 
-        reader.on_module( name, filename );
-      }
-      else if ( command == ".begin" )
+      if ( is_number( params.back() ) )
       {
-        if ( params.size() != 0 )
+        if ( params.size() == 2u )
         {
           if ( error )
           {
-            *error = "Wrong number of parameters for .begin command";
+            *error = "Too few arguments in .state command";
           }
-          return false;
+          return line_error;
         }
 
-        reader.on_begin();
+        initial_value = boost::lexical_cast<unsigned>( params.back() );
+      }
+
+      unsigned offset = initial_value ? 1u : 0u;
+
+      std::vector<unsigned> line_indices;
+      if ( variable_indices.empty() || !lookup_lines( std::vector<std::string>( params.begin() + 1u, params.end() - offset ), variable_indices.top(), line_indices, error ) )
+      {
+        return line_error;
+      }
 
-        if ( !read_gates )
+      reader.on_state( params.front(), line_indices, initial_value.get_value_or( 0u ) );
+    }
+    else if ( command == ".module" )
+    {
+      assert( params.size() <= 2u );
+      std::string name = params.front();
+
+      boost::optional<std::string> filename;
+      if ( params.size() == 2u )
+      {
+        filename = base_directory + "/" + params.back();
+      }
+
+      if ( filename && !boost::filesystem::exists( *filename ) )
+      {
+        if ( error )
         {
-          return true;
+          *error = boost::str( boost::format( "File for module %s not found" ) % name );
         }
+        return line_error;
       }
-      else if ( command == ".end" )
+
+      batch.module_names.push_back( name );
+
+      reader.on_module( name, filename );
+    }
+    else if ( command == ".begin" )
+    {
+      if ( params.size() != 0 )
       {
-        if ( params.size() != 0 )
+        if ( error )
         {
-          if ( error )
-          {
-            *error = "Wrong number of parameters for .end command";
-          }
-          return false;
+          *error = "Wrong number of parameters for .begin command";
         }
+        return line_error;
+      }
+
+      reader.on_begin();
+      in_gates = true;
 
-        if ( !variable_indices.empty() )
+      if ( !read_gates )
+      {
+        return line_stop;
+      }
+    }
+    else if ( command == ".end" )
+    {
+      if ( params.size() != 0 )
+      {
+        if ( error )
         {
-          variable_indices.pop();
+          *error = "Wrong number of parameters for .end command";
         }
-        reader.on_end();
+        return line_error;
       }
-      else
+
+      if ( !variable_indices.empty() )
+      {
+        variable_indices.pop();
+      }
+      in_gates = false;
+      reader.on_end();
+    }
+    else
+    {
+      if ( command[0] == '-' || command[0] == '1' || command[0] == '0' )
       {
-        if ( command[0] == '-' || command[0] == '1' || command[0] == '0' )
+        // truth table line
+        if ( params.size() )
         {
-          // truth table line
-          if ( params.size() )
+          if ( error )
           {
-            if ( error )
-            {
-              *error = "Params in truth table line";
-            }
-            return false;
+            *error = "Params in truth table line";
           }
-
-          std::vector<boost::optional<bool> > cube( command.size() );
-          std::transform( command.begin(), command.end(), cube.begin(), transform_to_constants() );
-
-          reader.on_truth_table_line( truth_table_index++, cube.begin(), cube.end() );
+          return line_error;
         }
-        else
-        {
-          using boost::adaptors::transformed;
-
-          // gate
-          std::vector<variable> line_indices;
-          boost::push_back( line_indices, params | transformed( [&variable_indices]( const std::string& s ) {
-                      bool polarity = s[0] != '-';
-                      return make_var( variable_indices.top()[polarity ? s : s.substr( 1u )], polarity );
-                  } ) );
 
-          boost::any gate_type;
+        std::vector<boost::optional<bool> > cube( command.size() );
+        std::transform( command.begin(), command.end(), cube.begin(), transform_to_constants() );
 
-          if ( boost::range::find( module_names, command ) != module_names.end() )
-          {
-            module_tag module_t;
-            module_t.name = command;
-            gate_type = module_t;
-          }
-          else
+        reader.on_truth_table_line( truth_table_index++, cube.begin(), cube.end() );
+      }
+      else
+      {
+        // gate (with comments or annotations)
+        if ( variable_indices.empty() )
+        {
+          if ( error )
           {
-            switch ( command[0] )
-            {
-            case 't':
-              gate_type = toffoli_tag();
-              break;
-
-            case 'p':
-              gate_type = peres_tag();
-              break;
-
-            case 'f':
-              gate_type = fredkin_tag();
-              break;
-
-            default:
-              if ( error )
-              {
-                *error = "unknown gate command: " + command;
-              }
-            }
+            *error = "Gate before .variables command";
           }
+          return line_error;
+        }
 
-          reader.on_gate( gate_type, line_indices );
+        if ( !lex_gate( line.data(), line.data() + line.size(), variable_indices.top(), batch, error ) )
+        {
+          return line_error;
         }
+
+        reader.on_gates( batch );
+        batch.clear();
       }
     }
 
-    return true;
+    return line_ok;
+  }
+
+  bool revlib_parser( std::istream& in, revlib_processor& reader, const std::string& base_directory, bool read_gates, std::string* error )
+  {
+    return revlib_parser_impl( reader, base_directory, read_gates, error ).parse_stream( in );
+  }
+
+  bool revlib_parser( const char* first, const char* last, revlib_processor& reader, const std::string& base_directory, bool read_gates, unsigned num_threads, std::string* error )
+  {
+    return revlib_parser_impl( reader, base_directory, read_gates, error ).parse_memory( first, last, num_threads );
   }
 
 }
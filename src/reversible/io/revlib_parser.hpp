@@ -63,6 +63,29 @@ namespace revkit
    */
   bool revlib_parser( std::istream& in, revlib_processor& reader, const std::string& base_directory = std::string( "." ), bool read_gates = true, std::string* error = 0 );
 
+  /**
+   * @brief A parser for the RevLib file format on a buffer in memory
+   *
+   * Same as revlib_parser(std::istream&, revlib_processor&, const std::string&, bool, std::string*)
+   * but the gate section is split at line boundaries into chunks
+   * which are lexed by \p num_threads threads.  The callbacks of
+   * \p reader are still called in file order from the calling thread.
+   *
+   * @param first  Begin of the buffer containing the file
+   * @param last   End of the buffer containing the file
+   * @param reader An instance of the revlib_processor
+   * @param base_directory A base directory to look for included files
+   * @param read_gates Decides whether gates should be parsed
+   * @param num_threads Number of threads to lex the gate section
+   * @param error A pointer to a string. In case the parsing fails,
+   *              and \p error is not null, a error message is stored
+   *
+   * @return true on success, false otherwise
+   *
+   * @since  2.0
+   */
+  bool revlib_parser( const char* first, const char* last, revlib_processor& reader, const std::string& base_directory = std::string( "." ), bool read_gates = true, unsigned num_threads = 1u, std::string* error = 0 );
+
 }
 
 #endif /* REVLIB_PARSER_HPP */
@@ -19,9 +19,17 @@
 
 #include <iostream>
 
+#include "../target_tags.hpp"
+
 namespace revkit
 {
 
+  void revlib_gate_batch::clear()
+  {
+    gates.clear();
+    variables.clear();
+  }
+
   ////////////////////////////// class revlib_processor
   class revlib_processor::priv
   {
@@ -105,6 +113,42 @@ namespace revkit
   {
   }
 
+  void revlib_processor::on_gates( const revlib_gate_batch& batch ) const
+  {
+    std::vector<variable> line_indices;
+
+    for ( const auto& r : batch.gates )
+    {
+      boost::any gate_type;
+
+      switch ( r.kind )
+      {
+      case revlib_gate_batch::toffoli:
+        gate_type = toffoli_tag();
+        break;
+
+      case revlib_gate_batch::peres:
+        gate_type = peres_tag();
+        break;
+
+      case revlib_gate_batch::fredkin:
+        gate_type = fredkin_tag();
+        break;
+
+      case revlib_gate_batch::module:
+        {
+          module_tag module_t;
+          module_t.name = batch.module_names.at( r.module );
+          gate_type = module_t;
+        }
+        break;
+      }
+
+      line_indices.assign( batch.variables.begin() + r.first, batch.variables.begin() + r.first + r.size );
+      on_gate( gate_type, line_indices );
+    }
+  }
+
   void revlib_processor::on_truth_table_line( unsigned line_index, const std::vector<boost::optional<bool> >::const_iterator first, const std::vector<boost::optional<bool> >::const_iterator last ) const
   {
   }
@@ -40,6 +40,38 @@
 namespace revkit
 {
 
+  /**
+   * @brief Gates collected by the revlib_parser in one batch
+   *
+   * Each record refers to the slice [first, first + size) of
+   * \p variables which holds all connected lines of the gate,
+   * with the target lines last as in revlib_processor::on_gate.
+   * For module gates \p module is an index into \p module_names.
+   *
+   * @since  2.0
+   */
+  struct revlib_gate_batch
+  {
+    enum gate_kind { toffoli, peres, fredkin, module };
+
+    struct record
+    {
+      gate_kind kind;
+      unsigned module;
+      unsigned first;
+      unsigned size;
+    };
+
+    std::vector<record> gates;
+    std::vector<variable> variables;
+    std::vector<std::string> module_names;
+
+    /**
+     * @brief Removes all gates but keeps the module names
+     */
+    void clear();
+  };
+
   /**
    * @brief Base class for actions on the revlib_parser
    *
@@ -80,6 +112,7 @@ namespace revkit
 
   private:
     friend bool revlib_parser( std::istream& in, revlib_processor& reader, const std::string&, bool read_gates, std::string* error );
+    friend class revlib_parser_impl;
 
   protected:
     /**
@@ -301,6 +334,20 @@ namespace revkit
      */
     virtual void on_gate( const boost::any& target_type, const std::vector<variable>& line_indices ) const;
 
+    /**
+     * @brief Called with a batch of parsed gates
+     *
+     * The parser collects consecutive gate lines without comments
+     * and annotations and passes them in bulk.  The default
+     * implementation calls on_gate for each record, processors
+     * which read large files should override this method instead.
+     *
+     * @param batch Parsed gates
+     *
+     * @since  2.0
+     */
+    virtual void on_gates( const revlib_gate_batch& batch ) const;
+
     /**
      * @brief Called when a truth table line is parsed
      *
@@ -0,0 +1,441 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stream_realization.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/filesystem/path.hpp>
+
+#include <core/io/compressed_stream.hpp>
+#include <reversible/target_tags.hpp>
+
+#include "binary_realization_p.hpp"
+#include "read_binary_realization.hpp"
+#include "read_realization.hpp"
+#include "revlib_parser.hpp"
+
+namespace revkit
+{
+
+  ////////////////////////////// class gate_sink
+  gate_sink::~gate_sink()
+  {
+  }
+
+  void gate_sink::on_header( const circuit& meta )
+  {
+  }
+
+  void gate_sink::on_end()
+  {
+  }
+
+  ////////////////////////////// class costs_sink
+  void costs_sink::on_header( const circuit& meta )
+  {
+    lines = meta.lines();
+    module_costs.clear();
+  }
+
+  void costs_sink::on_gate( const gate& g, const std::map<std::string, std::string>& annotations )
+  {
+    if ( is_module( g ) )
+    {
+      const circuit* module = boost::any_cast<module_tag>( g.type() ).reference.get();
+
+      auto it = module_costs.find( module );
+      if ( it == module_costs.end() )
+      {
+        it = module_costs.insert( std::make_pair( module, revkit::costs( *module, f ) ) ).first;
+      }
+      costs += it->second;
+    }
+    else
+    {
+      costs += f( g, lines );
+    }
+  }
+
+  ////////////////////////////// class statistics_sink
+  statistics_sink::statistics_sink()
+    : _transistor_costs( revkit::transistor_costs() ),
+      _quantum_costs( sk2013_quantum_costs() )
+  {
+  }
+
+  void statistics_sink::on_header( const circuit& meta )
+  {
+    _lines = meta.lines();
+    _line_usage.assign( _lines, 0ull );
+    _transistor_costs.on_header( meta );
+    _quantum_costs.on_header( meta );
+  }
+
+  void statistics_sink::on_gate( const gate& g, const std::map<std::string, std::string>& annotations )
+  {
+    ++_num_gates;
+    _transistor_costs.on_gate( g, annotations );
+    _quantum_costs.on_gate( g, annotations );
+
+    for ( const auto& c : g.controls() )
+    {
+      ++_line_usage[c.line()];
+    }
+    for ( const auto& t : g.targets() )
+    {
+      ++_line_usage[t];
+    }
+  }
+
+  unsigned long long statistics_sink::num_gates() const
+  {
+    return _num_gates;
+  }
+
+  unsigned statistics_sink::lines() const
+  {
+    return _lines;
+  }
+
+  cost_t statistics_sink::transistor_costs() const
+  {
+    return _transistor_costs.costs;
+  }
+
+  cost_t statistics_sink::quantum_costs() const
+  {
+    return _quantum_costs.costs;
+  }
+
+  const std::vector<unsigned long long>& statistics_sink::line_usage() const
+  {
+    return _line_usage;
+  }
+
+  ////////////////////////////// class write_realization_sink
+  void write_realization_sink::on_header( const circuit& meta )
+  {
+    write_realization_header( meta, w, settings );
+  }
+
+  void write_realization_sink::on_gate( const gate& g, const std::map<std::string, std::string>& annotations )
+  {
+    write_realization_gate( g, &annotations, w );
+  }
+
+  void write_realization_sink::on_end()
+  {
+    w << ".end\n";
+    w.flush();
+  }
+
+  ////////////////////////////// class negative_controls_to_positive_sink
+  void negative_controls_to_positive_sink::on_header( const circuit& meta )
+  {
+    next.on_header( meta );
+  }
+
+  void negative_controls_to_positive_sink::on_gate( const gate& g, const std::map<std::string, std::string>& annotations )
+  {
+    const gate::control_container controls = g.controls();
+    const std::map<std::string, std::string> no_annotations;
+
+    auto nots = [&]() {
+      for ( const auto& n : controls )
+      {
+        if ( !n.polarity() )
+        {
+          gate not_gate;
+          not_gate.add_target( n.line() );
+          not_gate.set_type( toffoli_tag() );
+          next.on_gate( not_gate, no_annotations );
+        }
+      }
+    };
+
+    nots();
+
+    gate ng;
+    for ( const auto& c : controls )   { ng.add_control( make_var( c.line() ) ); }
+    for ( const auto& t : g.targets() ) { ng.add_target( t );                     }
+    ng.set_type( g.type() );
+    next.on_gate( ng, annotations );
+
+    nots();
+  }
+
+  void negative_controls_to_positive_sink::on_end()
+  {
+    next.on_end();
+  }
+
+  ////////////////////////////// class reverse_sink
+  reverse_sink::~reverse_sink()
+  {
+    for ( const auto& chunk : chunks )
+    {
+      std::fclose( chunk.first );
+    }
+  }
+
+  void reverse_sink::on_header( const circuit& meta )
+  {
+    this->meta = &meta;
+    spill_at = chunk_size;
+
+    module_index.clear();
+    module_names.clear();
+    for ( const auto& module : meta.modules() )
+    {
+      module_index.insert( std::make_pair( module.first, module_names.size() ) );
+      module_names.push_back( module.first );
+    }
+
+    next.on_header( meta );
+  }
+
+  void reverse_sink::on_gate( const gate& g, const std::map<std::string, std::string>& annotations )
+  {
+    offsets.push_back( words.size() );
+    binary_format::pack_gate( g, module_index, words );
+
+    if ( offsets.size() >= spill_at )
+    {
+      std::FILE* file = std::tmpfile();
+      if ( file && std::fwrite( words.data(), sizeof( std::uint32_t ), words.size(), file ) == words.size() )
+      {
+        chunks.push_back( std::make_pair( file, words.size() ) );
+        words.clear();
+        offsets.clear();
+        spill_at = chunk_size;
+      }
+      else
+      {
+        /* keep the gates in memory and try again after the next chunk */
+        if ( file )
+        {
+          std::fclose( file );
+        }
+        spill_at += chunk_size;
+      }
+    }
+  }
+
+  void reverse_sink::emit( const std::vector<std::uint32_t>& words, const std::vector<unsigned>& offsets )
+  {
+    const std::map<std::string, std::string> no_annotations;
+
+    for ( auto it = offsets.rbegin(); it != offsets.rend(); ++it )
+    {
+      gate g;
+      binary_format::unpack_gate( binary_gate( &words[*it] ), *meta, module_names, g );
+      next.on_gate( g, no_annotations );
+    }
+  }
+
+  void reverse_sink::on_end()
+  {
+    emit( words, offsets );
+    words.clear();
+    offsets.clear();
+
+    bool read_failed = false;
+    for ( auto it = chunks.rbegin(); it != chunks.rend(); ++it )
+    {
+      words.resize( it->second );
+      std::rewind( it->first );
+      if ( std::fread( words.data(), sizeof( std::uint32_t ), words.size(), it->first ) != words.size() )
+      {
+        read_failed = true;
+        break;
+      }
+
+      offsets.clear();
+      for ( std::size_t pos = 0u; pos < words.size(); pos += binary_gate( &words[pos] ).size() )
+      {
+        offsets.push_back( pos );
+      }
+
+      emit( words, offsets );
+    }
+
+    for ( const auto& chunk : chunks )
+    {
+      std::fclose( chunk.first );
+    }
+    chunks.clear();
+    words.clear();
+    offsets.clear();
+
+    /* the gate stream is incomplete, hence it is not ended */
+    if ( read_failed )
+    {
+      throw std::runtime_error( "Cannot read temporary file of reverse_sink" );
+    }
+
+    next.on_end();
+  }
+
+  ////////////////////////////// stream_realization
+  /* reads the meta-data into a circuit and passes the gates of the main circuit to a sink */
+  class stream_processor : public circuit_processor
+  {
+  public:
+    stream_processor( circuit& meta, gate_sink& sink )
+      : circuit_processor( meta ), meta( meta ), sink( sink ) {}
+
+  protected:
+    void on_module( const std::string& name, const boost::optional<std::string>& filename ) const
+    {
+      circuit_processor::on_module( name, filename );
+
+      /* modules without file are defined inline up to the next .end */
+      if ( !filename )
+      {
+        ++module_depth;
+      }
+    }
+
+    void on_begin() const
+    {
+      if ( !module_depth )
+      {
+        sink.on_header( meta );
+      }
+    }
+
+    void on_gates( const revlib_gate_batch& batch ) const
+    {
+      if ( module_depth )
+      {
+        circuit_processor::on_gates( batch );
+        return;
+      }
+
+      std::map<std::string, std::string> annotations;
+      for ( const auto& p : *current_annotations() )
+      {
+        annotations.insert( std::make_pair( p.first, boost::any_cast<std::string>( p.second ) ) );
+      }
+
+      for ( const auto& r : batch.gates )
+      {
+        auto first = batch.variables.begin() + r.first;
+        auto last = first + r.size;
+
+        gate g;
+        unsigned num_targets = 1u;
+
+        switch ( r.kind )
+        {
+        case revlib_gate_batch::toffoli:
+          g.set_type( toffoli_tag() );
+          break;
+
+        case revlib_gate_batch::fredkin:
+          g.set_type( fredkin_tag() );
+          num_targets = 2u;
+          break;
+
+        case revlib_gate_batch::peres:
+          g.set_type( peres_tag() );
+          num_targets = 2u;
+          break;
+
+        case revlib_gate_batch::module:
+          {
+            module_tag module_t;
+            module_t.name = batch.module_names.at( r.module );
+            module_t.reference = meta.modules().find( module_t.name )->second;
+            num_targets = module_t.reference->lines();
+            g.set_type( module_t );
+          }
+          break;
+        }
+
+        assert( r.size >= num_targets );
+        std::for_each( first, last - num_targets, [&g]( variable l ) { g.add_control( l ); } );
+        std::for_each( last - num_targets, last, [&g]( variable l ) { g.add_target( l.line() ); } );
+
+        sink.on_gate( g, annotations );
+      }
+    }
+
+    void on_end() const
+    {
+      if ( module_depth )
+      {
+        --module_depth;
+        circuit_processor::on_end();
+      }
+      else
+      {
+        sink.on_end();
+      }
+    }
+
+  private:
+    circuit& meta;
+    gate_sink& sink;
+    mutable unsigned module_depth = 0u;
+  };
+
+  bool stream_realization( std::istream& in, gate_sink& sink, const std::string& base_directory, std::string* error )
+  {
+    circuit meta;
+    stream_processor processor( meta, sink );
+
+    try
+    {
+      return revlib_parser( in, processor, base_directory, true, error );
+    }
+    catch ( const std::runtime_error& e )
+    {
+      if ( error )
+      {
+        *error = e.what();
+      }
+      return false;
+    }
+  }
+
+  bool stream_realization( const std::string& filename, gate_sink& sink, std::string* error )
+  {
+    compressed_ifstream is( filename );
+
+    if ( !is.good() )
+    {
+      if ( error )
+      {
+        *error = "Cannot open " + filename;
+      }
+      return false;
+    }
+
+    return stream_realization( is, sink, boost::filesystem::path( filename ).parent_path().string(), error );
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
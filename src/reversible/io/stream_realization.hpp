@@ -0,0 +1,268 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file stream_realization.hpp
+ *
+ * @brief Streaming access to the gates of a RevLib realization
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef STREAM_REALIZATION_HPP
+#define STREAM_REALIZATION_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <reversible/circuit.hpp>
+#include <reversible/io/write_realization.hpp>
+#include <reversible/utils/costs.hpp>
+
+namespace revkit
+{
+
+  /**
+   * @brief Receiver of gates from stream_realization
+   *
+   * A sink gets the meta-data of the circuit first, then every
+   * gate in order, and finally on_end().  Gates are not stored,
+   * i.e. references passed to on_gate are only valid during the
+   * call.  Sinks can be chained to build transformations.
+   *
+   * @since  2.0
+   */
+  class gate_sink
+  {
+  public:
+    virtual ~gate_sink();
+
+    /**
+     * @brief Called before the first gate
+     *
+     * @param meta Circuit with lines, names, buses and modules but without gates,
+     *             valid until on_end() has been called
+     *
+     * @since  2.0
+     */
+    virtual void on_header( const circuit& meta );
+
+    /**
+     * @brief Called for each gate
+     *
+     * @param g           Gate
+     * @param annotations Annotations of the gate
+     *
+     * @since  2.0
+     */
+    virtual void on_gate( const gate& g, const std::map<std::string, std::string>& annotations ) = 0;
+
+    /**
+     * @brief Called after the last gate
+     *
+     * @since  2.0
+     */
+    virtual void on_end();
+  };
+
+  /**
+   * @brief Accumulates the costs of all gates by a gate cost function
+   *
+   * The costs of module gates are computed from the module as in costs(),
+   * once per module.
+   *
+   * @since  2.0
+   */
+  class costs_sink : public gate_sink
+  {
+  public:
+    explicit costs_sink( const costs_by_gate_func& f ) : f( f ) {}
+
+    void on_header( const circuit& meta );
+    void on_gate( const gate& g, const std::map<std::string, std::string>& annotations );
+
+    cost_t costs = 0ull;
+
+  private:
+    costs_by_gate_func f;
+    unsigned lines = 0u;
+    std::map<const circuit*, cost_t> module_costs;
+  };
+
+  /**
+   * @brief Accumulates the values of print_statistics and the usage of each line
+   *
+   * @since  2.0
+   */
+  class statistics_sink : public gate_sink
+  {
+  public:
+    statistics_sink();
+
+    void on_header( const circuit& meta );
+    void on_gate( const gate& g, const std::map<std::string, std::string>& annotations );
+
+    unsigned long long num_gates() const;
+    unsigned lines() const;
+    cost_t transistor_costs() const;
+    cost_t quantum_costs() const;
+
+    /**
+     * @brief Number of gates (controls or targets) on each line
+     *
+     * @since  2.0
+     */
+    const std::vector<unsigned long long>& line_usage() const;
+
+  private:
+    unsigned long long _num_gates = 0ull;
+    unsigned _lines = 0u;
+    costs_sink _transistor_costs;
+    costs_sink _quantum_costs;
+    std::vector<unsigned long long> _line_usage;
+  };
+
+  /**
+   * @brief Writes the gates as RevLib realization
+   *
+   * @since  2.0
+   */
+  class write_realization_sink : public gate_sink
+  {
+  public:
+    explicit write_realization_sink( std::ostream& os, const write_realization_settings& settings = write_realization_settings() )
+      : w( os ), settings( settings ) {}
+
+    void on_header( const circuit& meta );
+    void on_gate( const gate& g, const std::map<std::string, std::string>& annotations );
+    void on_end();
+
+  private:
+    buffered_writer w;
+    write_realization_settings settings;
+  };
+
+  /**
+   * @brief Streaming version of negative_controls_to_positive
+   *
+   * @since  2.0
+   */
+  class negative_controls_to_positive_sink : public gate_sink
+  {
+  public:
+    explicit negative_controls_to_positive_sink( gate_sink& next ) : next( next ) {}
+
+    void on_header( const circuit& meta );
+    void on_gate( const gate& g, const std::map<std::string, std::string>& annotations );
+    void on_end();
+
+  private:
+    gate_sink& next;
+  };
+
+  /**
+   * @brief Streaming version of reverse_circuit
+   *
+   * Gates are collected in chunks of \p chunk_size gates, full
+   * chunks are moved to temporary files.  If a temporary file cannot
+   * be written, the gates stay in memory until the next attempt one
+   * chunk later.  After the last gate the chunks are passed in
+   * reverse order to \p next.  Annotations are not preserved.
+   *
+   * If a temporary file cannot be read back, on_end() throws a
+   * \b std::runtime_error without calling on_end() of \p next,
+   * which stream_realization reports as an error.
+   *
+   * @since  2.0
+   */
+  class reverse_sink : public gate_sink
+  {
+  public:
+    explicit reverse_sink( gate_sink& next, unsigned chunk_size = 1u << 20u )
+      : next( next ), chunk_size( chunk_size ) {}
+    ~reverse_sink();
+
+    void on_header( const circuit& meta );
+    void on_gate( const gate& g, const std::map<std::string, std::string>& annotations );
+    void on_end();
+
+  private:
+    void emit( const std::vector<std::uint32_t>& words, const std::vector<unsigned>& offsets );
+
+    gate_sink& next;
+    unsigned chunk_size;
+    std::size_t spill_at = 0u;
+
+    const circuit* meta = 0;
+    std::map<std::string, unsigned> module_index;
+    std::vector<std::string> module_names;
+
+    std::vector<std::uint32_t> words;
+    std::vector<unsigned> offsets;
+    std::vector<std::pair<std::FILE*, std::size_t> > chunks;
+  };
+
+  /**
+   * @brief Reads a realization and passes its gates to a sink
+   *
+   * In contrast to read_realization the gates are not stored,
+   * so the memory consumption does not depend on the number of
+   * gates.  Modules are read completely and are part of the
+   * meta-data.
+   *
+   * @code
+   * statistics_sink stats;
+   * stream_realization( "circuit.real", stats );
+   * std::cout << stats.num_gates() << std::endl;
+   * @endcode
+   *
+   * A sink can abort with a \b std::runtime_error, whose message
+   * is then returned as error.
+   *
+   * @param in             Input stream containing the realization
+   * @param sink           Receiver of the gates
+   * @param base_directory Directory to look for module files
+   * @param error          If not-null, an error message is written
+   *                       to this parameter in case the function fails
+   *
+   * @return true on success, false otherwise
+   *
+   * @since  2.0
+   */
+  bool stream_realization( std::istream& in, gate_sink& sink, const std::string& base_directory = std::string( "." ), std::string* error = 0 );
+
+  /**
+   * @brief Reads a realization from a file and passes its gates to a sink
+   *
+   * @since  2.0
+   */
+  bool stream_realization( const std::string& filename, gate_sink& sink, std::string* error = 0 );
+
+}
+
+#endif /* STREAM_REALIZATION_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
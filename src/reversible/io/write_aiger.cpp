@@ -0,0 +1,256 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "write_aiger.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <core/io/buffered_writer.hpp>
+#include <core/io/compressed_stream.hpp>
+
+#include "../circuit.hpp"
+#include "../target_tags.hpp"
+
+extern "C"
+{
+#include <aiger.h>
+}
+
+namespace revkit
+{
+
+  /* creates AND gates with structural hashing and constant propagation */
+  class aig_builder
+  {
+  public:
+    explicit aig_builder( aiger* aig ) : aig( aig ) {}
+
+    unsigned add_input( const std::string& name )
+    {
+      unsigned lit = aiger_var2lit( ++maxvar );
+      aiger_add_input( aig, lit, name.c_str() );
+      return lit;
+    }
+
+    unsigned and_lit( unsigned a, unsigned b )
+    {
+      if ( a == aiger_false || b == aiger_false || a == aiger_not( b ) ) { return aiger_false; }
+      if ( a == aiger_true || a == b ) { return b; }
+      if ( b == aiger_true ) { return a; }
+
+      if ( a < b ) { std::swap( a, b ); }
+
+      std::uint64_t key = ( std::uint64_t( a ) << 32u ) | b;
+      auto it = strash.find( key );
+      if ( it != strash.end() )
+      {
+        return it->second;
+      }
+
+      unsigned lhs = aiger_var2lit( ++maxvar );
+      aiger_add_and( aig, lhs, a, b );
+      strash.insert( std::make_pair( key, lhs ) );
+      return lhs;
+    }
+
+    unsigned or_lit( unsigned a, unsigned b )
+    {
+      return aiger_not( and_lit( aiger_not( a ), aiger_not( b ) ) );
+    }
+
+    unsigned xor_lit( unsigned a, unsigned b )
+    {
+      return or_lit( and_lit( a, aiger_not( b ) ), and_lit( aiger_not( a ), b ) );
+    }
+
+    unsigned mux_lit( unsigned c, unsigned t, unsigned e )
+    {
+      return or_lit( and_lit( c, t ), and_lit( aiger_not( c ), e ) );
+    }
+
+    /* balanced tree to keep the depth logarithmic */
+    unsigned and_tree( std::vector<unsigned> lits )
+    {
+      if ( lits.empty() )
+      {
+        return aiger_true;
+      }
+
+      while ( lits.size() > 1u )
+      {
+        std::vector<unsigned> next;
+        for ( unsigned i = 0u; i + 1u < lits.size(); i += 2u )
+        {
+          next.push_back( and_lit( lits[i], lits[i + 1u] ) );
+        }
+        if ( lits.size() % 2u )
+        {
+          next.push_back( lits.back() );
+        }
+        lits.swap( next );
+      }
+
+      return lits.front();
+    }
+
+  private:
+    aiger* aig;
+    unsigned maxvar = 0u;
+    std::unordered_map<std::uint64_t, unsigned> strash;
+  };
+
+  bool add_gates_to_aig( aig_builder& builder, const circuit& circ, std::vector<unsigned>& lits, std::string* error )
+  {
+    for ( const auto& g : circ )
+    {
+      std::vector<unsigned> controls;
+      for ( const auto& v : g.controls() )
+      {
+        controls.push_back( v.polarity() ? lits[v.line()] : aiger_not( lits[v.line()] ) );
+      }
+
+      if ( is_toffoli( g ) )
+      {
+        unsigned t = g.targets().front();
+        lits[t] = builder.xor_lit( lits[t], builder.and_tree( controls ) );
+      }
+      else if ( is_fredkin( g ) )
+      {
+        unsigned t1 = g.targets().at( 0u );
+        unsigned t2 = g.targets().at( 1u );
+        unsigned swap = builder.and_lit( builder.and_tree( controls ), builder.xor_lit( lits[t1], lits[t2] ) );
+        lits[t1] = builder.xor_lit( lits[t1], swap );
+        lits[t2] = builder.xor_lit( lits[t2], swap );
+      }
+      else if ( is_peres( g ) )
+      {
+        unsigned t1 = g.targets().at( 0u );
+        unsigned t2 = g.targets().at( 1u );
+        unsigned c = controls.front();
+        lits[t2] = builder.xor_lit( lits[t2], builder.and_lit( c, lits[t1] ) );
+        lits[t1] = builder.xor_lit( lits[t1], c );
+      }
+      else if ( is_module( g ) )
+      {
+        const module_tag& tag = boost::any_cast<module_tag>( g.type() );
+        const auto& targets = g.targets();
+
+        std::vector<unsigned> module_lits;
+        for ( const auto& t : targets )
+        {
+          module_lits.push_back( lits[t] );
+        }
+
+        if ( !add_gates_to_aig( builder, *tag.reference, module_lits, error ) )
+        {
+          return false;
+        }
+
+        unsigned c = builder.and_tree( controls );
+        for ( unsigned i = 0u; i < targets.size(); ++i )
+        {
+          lits[targets[i]] = builder.mux_lit( c, module_lits[i], lits[targets[i]] );
+        }
+      }
+      else
+      {
+        if ( error )
+        {
+          *error = "Unsupported gate type for AIGER";
+        }
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool write_aiger( const circuit& circ, std::ostream& os, const write_aiger_settings& settings, std::string* error )
+  {
+    aiger* aig = aiger_init();
+    aig_builder builder( aig );
+
+    /* inputs need the smallest variable indexes */
+    std::vector<unsigned> lits( circ.lines() );
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
+    {
+      const constant& c = circ.constants()[i];
+      lits[i] = c ? ( *c ? aiger_true : aiger_false ) : builder.add_input( circ.inputs()[i] );
+    }
+
+    if ( !add_gates_to_aig( builder, circ, lits, error ) )
+    {
+      aiger_reset( aig );
+      return false;
+    }
+
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
+    {
+      if ( !circ.garbage()[i] )
+      {
+        aiger_add_output( aig, lits[i], circ.outputs()[i].c_str() );
+      }
+    }
+
+    buffered_writer w( os );
+    aiger_write_generic( aig, settings.binary ? aiger_binary_mode : aiger_ascii_mode, &w,
+                         []( char ch, void* state ) { static_cast<buffered_writer*>( state )->put( ch ); return int( static_cast<unsigned char>( ch ) ); } );
+    w.flush();
+
+    aiger_reset( aig );
+    return true;
+  }
+
+  bool write_aiger( const circuit& circ, const std::string& filename, const write_aiger_settings& settings, std::string* error )
+  {
+    compressed_ofstream os( filename );
+
+    if ( !os.is_open() )
+    {
+      if ( error )
+      {
+        *error = "Cannot write " + filename;
+      }
+      return false;
+    }
+
+    if ( !write_aiger( circ, os, settings, error ) )
+    {
+      return false;
+    }
+
+    if ( !os.close() )
+    {
+      if ( error )
+      {
+        *error = "Cannot write " + filename;
+      }
+      return false;
+    }
+
+    return true;
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,105 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file write_aiger.hpp
+ *
+ * @brief Writes a circuit as And-Inverter graph in AIGER format
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef WRITE_AIGER_HPP
+#define WRITE_AIGER_HPP
+
+#include <iostream>
+#include <string>
+
+namespace revkit
+{
+
+  class circuit;
+
+  /**
+   * @brief Settings for write_aiger
+   *
+   * @since  2.0
+   */
+  struct write_aiger_settings
+  {
+    /**
+     * @brief Writes the binary format (*.aig) if true, otherwise the ASCII format (*.aag)
+     *
+     * Default value is \b true
+     *
+     * @since  2.0
+     */
+    bool binary = true;
+  };
+
+  /**
+   * @brief Writes a circuit as And-Inverter graph in AIGER format
+   *
+   * Every gate is translated into AND gates on the literals of
+   * the current line values, e.g. a Toffoli gate becomes an AND
+   * tree over its controls and an XOR with its target.  Module
+   * gates are inlined.  Structurally equal AND gates are shared
+   * and constants are propagated.
+   *
+   * Constant inputs are not written as inputs and garbage
+   * outputs are not written as outputs.  Input and output
+   * names are stored in the symbol table.
+   *
+   * Only Toffoli, Fredkin, Peres, and module gates are supported.
+   *
+   * @param circ     Circuit
+   * @param os       Output stream
+   * @param settings Settings
+   * @param error    A pointer to a string. In case the circuit cannot
+   *                 be translated, and \p error is not null, a error message is stored
+   *
+   * @return true on success, false otherwise
+   *
+   * @since  2.0
+   */
+  bool write_aiger( const circuit& circ, std::ostream& os, const write_aiger_settings& settings = write_aiger_settings(), std::string* error = 0 );
+
+  /**
+   * @brief Writes a circuit as And-Inverter graph to an AIGER file
+   *
+   * @param circ     Circuit
+   * @param filename Filename of the file to be created
+   * @param settings Settings
+   * @param error    A pointer to a string. In case the file cannot be written,
+   *                 and \p error is not null, a error message is stored
+   *
+   * @return true on success, false otherwise
+   *
+   * @since  2.0
+   */
+  bool write_aiger( const circuit& circ, const std::string& filename, const write_aiger_settings& settings = write_aiger_settings(), std::string* error = 0 );
+
+}
+
+#endif /* WRITE_AIGER_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,299 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "write_binary_realization.hpp"
+
+#include <cassert>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include <reversible/target_tags.hpp>
+
+#include "binary_realization_p.hpp"
+#include "read_binary_realization.hpp"
+
+namespace revkit
+{
+
+  /* collects words and writes them in large blocks */
+  class binary_writer
+  {
+  public:
+    explicit binary_writer( std::ostream& os ) : os( os )
+    {
+      buffer.reserve( block_size );
+    }
+
+    ~binary_writer()
+    {
+      flush();
+    }
+
+    void put( std::uint32_t word )
+    {
+      buffer.push_back( word );
+      if ( buffer.size() == block_size )
+      {
+        flush();
+      }
+    }
+
+    void put( const std::string& s )
+    {
+      put( static_cast<std::uint32_t>( s.size() ) );
+      put_chars( s.begin(), s.end() );
+    }
+
+    template<typename Iterator>
+    void put_chars( Iterator first, Iterator last )
+    {
+      std::uint32_t word = 0u;
+      unsigned pos = 0u;
+
+      for ( ; first != last; ++first )
+      {
+        reinterpret_cast<char*>( &word )[pos] = *first;
+        if ( ++pos == 4u )
+        {
+          put( word );
+          word = 0u;
+          pos = 0u;
+        }
+      }
+
+      if ( pos )
+      {
+        put( word );
+      }
+    }
+
+    void flush()
+    {
+      os.write( reinterpret_cast<const char*>( buffer.data() ), buffer.size() * sizeof( std::uint32_t ) );
+      buffer.clear();
+    }
+
+  private:
+    static const std::size_t block_size = 1u << 16u;
+
+    std::ostream& os;
+    std::vector<std::uint32_t> buffer;
+  };
+
+  void write_buses( const bus_collection& buses, binary_writer& w )
+  {
+    w.put( static_cast<std::uint32_t>( buses.buses().size() ) );
+
+    for ( const auto& bus : buses.buses() )
+    {
+      boost::optional<unsigned> initial_value = buses.initial_value( bus.first );
+
+      w.put( bus.first );
+      w.put( initial_value ? 1u : 0u );
+      w.put( initial_value.get_value_or( 0u ) );
+      w.put( static_cast<std::uint32_t>( bus.second.size() ) );
+      for ( unsigned l : bus.second )
+      {
+        w.put( l );
+      }
+    }
+  }
+
+  namespace binary_format
+  {
+    void pack_gate( const gate& g, const std::map<std::string, unsigned>& module_index, std::vector<std::uint32_t>& words )
+    {
+      std::uint32_t kind;
+      if ( is_toffoli( g ) )
+      {
+        kind = binary_gate::toffoli;
+      }
+      else if ( is_fredkin( g ) )
+      {
+        kind = binary_gate::fredkin;
+      }
+      else if ( is_peres( g ) )
+      {
+        kind = binary_gate::peres;
+      }
+      else
+      {
+        assert( is_module( g ) );
+        kind = binary_gate::module;
+      }
+
+      const gate::control_container controls = g.controls();
+      const gate::target_container targets = g.targets();
+
+      words.push_back( kind | ( static_cast<std::uint32_t>( targets.size() ) << 8u ) );
+      words.push_back( static_cast<std::uint32_t>( controls.size() ) );
+      if ( kind == binary_gate::module )
+      {
+        words.push_back( module_index.find( boost::any_cast<module_tag>( g.type() ).name )->second );
+      }
+      for ( const auto& c : controls )
+      {
+        words.push_back( ( c.line() << 1u ) | ( c.polarity() ? 1u : 0u ) );
+      }
+      for ( const auto& t : targets )
+      {
+        words.push_back( t );
+      }
+    }
+  }
+
+  unsigned gate_words( const gate& g )
+  {
+    return 2u + ( is_module( g ) ? 1u : 0u ) + g.size();
+  }
+
+  void write_circuit( const circuit& circ, binary_writer& w )
+  {
+    w.put( circ.lines() );
+    w.put( circ.circuit_name() );
+
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
+    {
+      w.put( i < circ.inputs().size() ? circ.inputs()[i] : "i" + std::to_string( i ) );
+    }
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
+    {
+      w.put( i < circ.outputs().size() ? circ.outputs()[i] : "o" + std::to_string( i ) );
+    }
+
+    std::string constants( circ.lines(), '-' );
+    std::string garbage( circ.lines(), '-' );
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
+    {
+      if ( i < circ.constants().size() && circ.constants()[i] )
+      {
+        constants[i] = *circ.constants()[i] ? '1' : '0';
+      }
+      if ( i < circ.garbage().size() && circ.garbage()[i] )
+      {
+        garbage[i] = '1';
+      }
+    }
+    w.put_chars( constants.begin(), constants.end() );
+    w.put_chars( garbage.begin(), garbage.end() );
+
+    write_buses( circ.inputbuses(), w );
+    write_buses( circ.outputbuses(), w );
+    write_buses( circ.statesignals(), w );
+
+    /* modules are referenced by their position in the (sorted) module map */
+    std::map<std::string, unsigned> module_index;
+    w.put( static_cast<std::uint32_t>( circ.modules().size() ) );
+    for ( const auto& module : circ.modules() )
+    {
+      module_index.insert( std::make_pair( module.first, module_index.size() ) );
+      w.put( module.first );
+      write_circuit( *module.second, w );
+    }
+
+    /* gates */
+    std::uint64_t num_words = 0u;
+    for ( const auto& g : circ )
+    {
+      num_words += gate_words( g );
+    }
+    assert( num_words <= 0xffffffffu );
+
+    w.put( circ.num_gates() );
+    w.put( static_cast<std::uint32_t>( num_words ) );
+
+    std::vector<std::pair<unsigned, const gate*> > annotated;
+    std::vector<std::uint32_t> words;
+
+    unsigned index = 0u;
+    for ( const auto& g : circ )
+    {
+      words.clear();
+      binary_format::pack_gate( g, module_index, words );
+      for ( std::uint32_t word : words )
+      {
+        w.put( word );
+      }
+
+      if ( circ.annotations( g ) )
+      {
+        annotated.push_back( std::make_pair( index, &g ) );
+      }
+      ++index;
+    }
+
+    /* annotations */
+    std::uint32_t num_annotations = 0u;
+    for ( const auto& p : annotated )
+    {
+      num_annotations += circ.annotations( *p.second )->size();
+    }
+
+    w.put( num_annotations );
+    for ( const auto& p : annotated )
+    {
+      for ( const auto& a : *circ.annotations( *p.second ) )
+      {
+        w.put( p.first );
+        w.put( a.first );
+        w.put( a.second );
+      }
+    }
+  }
+
+  void write_binary_realization( const circuit& circ, std::ostream& os )
+  {
+    binary_writer w( os );
+    w.put( binary_format::magic );
+    w.put( binary_format::version );
+    write_circuit( circ, w );
+  }
+
+  bool write_binary_realization( const circuit& circ, const std::string& filename, std::string* error )
+  {
+    std::ofstream os( filename.c_str(), std::ios::out | std::ios::binary );
+    if ( !os.good() )
+    {
+      if ( error )
+      {
+        *error = "Cannot open " + filename;
+      }
+      return false;
+    }
+
+    write_binary_realization( circ, os );
+
+    if ( !os.good() )
+    {
+      if ( error )
+      {
+        *error = "Cannot write " + filename;
+      }
+      return false;
+    }
+
+    return true;
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,78 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file write_binary_realization.hpp
+ *
+ * @brief Generator for the binary realization format
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef WRITE_BINARY_REALIZATION_HPP
+#define WRITE_BINARY_REALIZATION_HPP
+
+#include <iosfwd>
+#include <string>
+
+#include <reversible/circuit.hpp>
+
+namespace revkit
+{
+
+  /**
+   * @brief Writes a circuit in binary format to an output stream
+   *
+   * The binary format stores the same information as a RevLib
+   * realization, i.e. meta-data, buses, modules, gates and
+   * annotations, but the gates are kept in a packed array which
+   * can be loaded with read_binary_realization without parsing.
+   * The format uses the byte order of the host.
+   *
+   * Only Toffoli, Fredkin, Peres, and module gates are supported.
+   *
+   * @param circ Circuit to write
+   * @param os   Output stream, must be opened in binary mode
+   *
+   * @since  2.0
+   */
+  void write_binary_realization( const circuit& circ, std::ostream& os );
+
+  /**
+   * @brief Writes a circuit in binary format to a file
+   *
+   * @param circ     Circuit to write
+   * @param filename Filename of the file to be created
+   * @param error    If not-null, an error message is written
+   *                 to this parameter in case the function fails
+   *
+   * @return true on success, false otherwise
+   *
+   * @since  2.0
+   */
+  bool write_binary_realization( const circuit& circ, const std::string& filename, std::string* error = 0 );
+
+}
+
+#endif /* WRITE_BINARY_REALIZATION_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
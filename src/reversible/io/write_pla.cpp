@@ -19,67 +19,71 @@
 
 #include <fstream>
 
-#include <boost/algorithm/string/join.hpp>
-#include <boost/range/adaptors.hpp>
-#include <boost/range/algorithm.hpp>
-#include <boost/range/iterator_range.hpp>
+#include <core/io/buffered_writer.hpp>
+#include <core/io/compressed_stream.hpp>
 
 namespace revkit
 {
 
 void write_pla( const binary_truth_table& pla, const std::string& filename )
 {
-  std::filebuf fb;
-  fb.open( filename.c_str(), std::ios::out );
-
-  std::ostream os( &fb );
+  compressed_ofstream os( filename );
+  buffered_writer w( os );
 
   auto bit_to_char = []( const boost::optional<bool>& b ) {
     return b ? (*b ? '1' : '0') : '-';
   };
 
+  auto write_names = [&w]( const char* command, const std::vector<std::string>& names ) {
+    w << command;
+    for ( const auto& name : names )
+    {
+      w << ' ' << name;
+    }
+    w << '\n';
+  };
+
   bool first = true;
 
   for ( binary_truth_table::const_iterator it = pla.begin(); it != pla.end(); ++it )
   {
-    using boost::adaptors::transformed;
-
     if ( first )
     {
       unsigned num_inputs = std::distance( it->first.first, it->first.second );
       unsigned num_outputs = std::distance( it->second.first, it->second.second );
 
-      os << ".i " << num_inputs << std::endl;
-      os << ".o " << num_outputs << std::endl;
+      w << ".i " << num_inputs << '\n';
+      w << ".o " << num_outputs << '\n';
 
       if ( num_inputs == pla.inputs().size() )
       {
-        os << ".ilb " << boost::join( pla.inputs(), " " ) << std::endl;
+        write_names( ".ilb", pla.inputs() );
       }
 
       if ( num_outputs == pla.outputs().size() )
       {
-        os << ".ob " << boost::join( pla.outputs(), " " ) << std::endl;
+        write_names( ".ob", pla.outputs() );
       }
 
       first = false;
     }
 
-    for ( const auto& b : boost::make_iterator_range( it->first ) ) {
-      os << bit_to_char( b );
+    for ( auto b = it->first.first; b != it->first.second; ++b )
+    {
+      w << bit_to_char( *b );
     }
-    //boost::for_each( boost::make_iterator_range( it->first ) | transformed( bit_to_char ), [&os]( char c ) { os << c; } );
-    os << " ";
-    for ( const auto& b : boost::make_iterator_range( it->second ) ) {
-      os << bit_to_char( b );
+    w << ' ';
+    for ( auto b = it->second.first; b != it->second.second; ++b )
+    {
+      w << bit_to_char( *b );
     }
-    //boost::for_each( boost::make_iterator_range( it->second ) | transformed( bit_to_char ), [&os]( char c ) { os << c; } );
-    os << std::endl;
+    w << '\n';
   }
 
-  os << ".e" << std::endl;
+  w << ".e\n";
+  w.flush();
 
-  fb.close();
+  os.close();
 
 }
 
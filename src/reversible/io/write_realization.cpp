@@ -19,51 +19,46 @@
 
 #include <fstream>
 
-#include <boost/algorithm/string/join.hpp>
-#include <boost/algorithm/string/replace.hpp>
-#include <boost/assign/std/vector.hpp>
 #include <boost/format.hpp>
-#include <boost/iterator/counting_iterator.hpp>
-#include <boost/range/algorithm.hpp>
-#include <boost/spirit/include/karma.hpp>
 
+#include <core/io/compressed_stream.hpp>
 #include <core/version.hpp>
 #include <reversible/circuit.hpp>
 #include <reversible/target_tags.hpp>
 
-using namespace boost::assign;
-
 namespace revkit
 {
 
-  struct constant_to_char
+  inline void write_line( buffered_writer& w, unsigned line )
   {
-    char operator()( const constant& c )
-    {
-      return ( c ? ( *c ? '1' : '0' ) : '-' );
-    }
-  };
+    w << 'x' << line;
+  }
 
-  struct garbage_to_char
+  inline void write_quoted( buffered_writer& w, const std::string& name )
   {
-    char operator()( bool g )
+    if ( name.find( ' ' ) != std::string::npos )
     {
-      return g ? '1' : '-';
+      w << '"' << name << '"';
     }
-  };
-
-  struct line_to_variable
-  {
-    std::string operator()( const variable& v ) const
+    else
     {
-      return boost::str( boost::format( "%sx%d" ) % ( v.polarity() ? "" : "-" ) % v.line() );
+      w << name;
     }
+  }
 
-    std::string operator()( const unsigned& l ) const
+  void write_bus_collection( buffered_writer& w, const char* command, const bus_collection& buses )
+  {
+    for ( const auto& bus : buses.buses() )
     {
-      return boost::str( boost::format( "x%d" ) % l );
+      w << command << ' ' << bus.first;
+      for ( unsigned l : bus.second )
+      {
+        w << ' ';
+        write_line( w, l );
+      }
+      w << '\n';
     }
-  };
+  }
 
   write_realization_settings::write_realization_settings()
     : version( "2.0" ),
@@ -71,169 +66,166 @@ namespace revkit
   {
   }
 
-  void write_realization( const circuit& circ, std::ostream& os, const write_realization_settings& settings )
+  void write_realization_header( const circuit& circ, buffered_writer& w, const write_realization_settings& settings )
   {
-    unsigned oldsize = 0;
-
     if ( !settings.header.empty() )
     {
-      std::string header = settings.header;
-      boost::algorithm::replace_all( header, "\n", "\n# " );
-      os << "# " << header << std::endl;
+      w << "# ";
+      for ( char c : settings.header )
+      {
+        w << c;
+        if ( c == '\n' )
+        {
+          w << "# ";
+        }
+      }
+      w << '\n';
     }
 
     if ( !settings.version.empty() )
     {
-      os << ".version " << settings.version << std::endl;
+      w << ".version " << settings.version << '\n';
     }
 
-    os << ".numvars " << circ.lines() << std::endl;
-
-    std::vector<std::string> variables( circ.lines() );
+    w << ".numvars " << circ.lines() << '\n';
 
+    w << ".variables";
     for ( unsigned i = 0u; i < circ.lines(); ++i )
     {
-      variables[i] = boost::str( boost::format( "x%d" ) % i );
+      w << ' ';
+      write_line( w, i );
     }
+    w << '\n';
 
-    std::vector<std::string> _inputs( circ.inputs().begin(), circ.inputs().end() );
-    oldsize = _inputs.size();
-    _inputs.resize( circ.lines() );
-
-    for ( unsigned i = oldsize; i < circ.lines(); ++i )
+    w << ".inputs";
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
     {
-      _inputs[i] = boost::str( boost::format( "i%d" ) % i );
+      w << ' ';
+      if ( i < circ.inputs().size() )
+      {
+        write_quoted( w, circ.inputs()[i] );
+      }
+      else
+      {
+        w << 'i' << i;
+      }
     }
+    w << '\n';
 
-    std::vector<std::string> _outputs( circ.outputs().begin(), circ.outputs().end() );
-    oldsize = _outputs.size();
-    _outputs.resize( circ.lines() );
-
-    for ( unsigned i = oldsize; i < circ.lines(); ++i )
+    w << ".outputs";
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
     {
-      _outputs[i] = boost::str( boost::format( "o%d" ) % i );
+      w << ' ';
+      if ( i < circ.outputs().size() )
+      {
+        write_quoted( w, circ.outputs()[i] );
+      }
+      else
+      {
+        w << 'o' << i;
+      }
     }
+    w << '\n';
 
-    os << ".variables " << boost::algorithm::join( variables, " " ) << std::endl;
-
-    namespace karma = boost::spirit::karma;
-    namespace ascii = boost::spirit::ascii;
-
-    os << ".inputs";
-    //std::ostream_iterator<char> outit( os );
-    //karma::generate_delimited( outit, *( karma::no_delimit['"' << karma::string] << '"' ), ascii::space, _inputs );
-
-    for ( const auto& _input : _inputs )
+    w << ".constants ";
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
     {
-      std::string quote = ( _input.find( " " ) != std::string::npos ) ? "\"" : "";
-      os << boost::format( " %s%s%s" ) % quote % _input % quote;
+      const constant c = i < circ.constants().size() ? circ.constants()[i] : constant();
+      w << ( c ? ( *c ? '1' : '0' ) : '-' );
     }
+    w << '\n';
 
-    os << std::endl;
-
-    os << ".outputs";
-    //karma::generate_delimited( outit, *( karma::no_delimit['"' << karma::string] << '"' ), ascii::space, _outputs );
-
-    for ( const auto& _output : _outputs )
+    w << ".garbage ";
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
     {
-      std::string quote = ( _output.find( " " ) != std::string::npos ) ? "\"" : "";
-      os << boost::format( " %s%s%s" ) % quote % _output % quote;
+      w << ( i < circ.garbage().size() && circ.garbage()[i] ? '1' : '-' );
     }
+    w << '\n';
 
-    os << std::endl;
+    write_bus_collection( w, ".inputbus", circ.inputbuses() );
+    write_bus_collection( w, ".outputbus", circ.outputbuses() );
+    write_bus_collection( w, ".state", circ.statesignals() );
 
-    std::string _constants( circ.lines(), '-' );
-    std::transform( circ.constants().begin(), circ.constants().end(), _constants.begin(), constant_to_char() );
+    for ( const auto& module : circ.modules() )
+    {
+      w << ".module " << module.first << '\n';
 
-    std::string _garbage( circ.lines(), '-' );
-    std::transform( circ.garbage().begin(), circ.garbage().end(), _garbage.begin(), garbage_to_char() );
+      write_realization_settings module_settings;
+      module_settings.version.clear();
+      module_settings.header.clear();
+      write_realization( *module.second, w, module_settings );
+    }
 
-    os << ".constants " << _constants << std::endl
-       << ".garbage " << _garbage << std::endl;
+    w << ".begin\n";
+  }
 
-    for ( const auto& bus : circ.inputbuses().buses() )
+  void write_realization_gate( const gate& g, const std::map<std::string, std::string>* annotations, buffered_writer& w )
+  {
+    if ( is_toffoli( g ) )
     {
-      std::vector<std::string> lines;
-      std::transform( bus.second.begin(), bus.second.end(), std::back_inserter( lines ), line_to_variable() );
-      os << ".inputbus " << bus.first << " " << boost::algorithm::join( lines, " " ) << std::endl;
+      w << 't' << g.size();
     }
-
-    for ( const auto& bus : circ.outputbuses().buses() )
+    else if ( is_fredkin( g ) )
     {
-      std::vector<std::string> lines;
-      std::transform( bus.second.begin(), bus.second.end(), std::back_inserter( lines ), line_to_variable() );
-      os << ".outputbus " << bus.first << " " << boost::algorithm::join( lines, " " ) << std::endl;
+      w << 'f' << g.size();
     }
-
-    for ( const auto& bus : circ.statesignals().buses() )
+    else if ( is_peres( g ) )
     {
-      std::vector<std::string> lines;
-      std::transform( bus.second.begin(), bus.second.end(), std::back_inserter( lines ), line_to_variable() );
-      os << ".state " << bus.first << " " << boost::algorithm::join( lines, " " ) << std::endl;
+      w << 'p';
     }
-
-    for ( const auto& module : circ.modules() )
+    else if ( is_module( g ) )
     {
-      os << ".module " << module.first << std::endl;
-
-      write_realization_settings module_settings;
-      module_settings.version.clear();
-      module_settings.header.clear();
-      write_realization( *module.second, os, module_settings );
+      w << boost::any_cast<module_tag>( g.type() ).name;
     }
 
-    os << ".begin" << std::endl;
+    // Peres is special
+    for ( const auto& c : g.controls() )
+    {
+      w << ( c.polarity() ? " " : " -" );
+      write_line( w, c.line() );
+    }
 
-    std::string cmd;
+    for ( const auto& t : g.targets() )
+    {
+      w << ' ';
+      write_line( w, t );
+    }
 
-    for ( const auto& g : circ )
+    if ( annotations && !annotations->empty() )
     {
-      if ( is_toffoli( g ) )
-      {
-        cmd = boost::str( boost::format( "t%d" ) % g.size() );
-      }
-      else if ( is_fredkin( g ) )
+      w << " #@";
+      for ( const auto& p : *annotations )
       {
-        cmd = boost::str( boost::format( "f%d" ) % g.size() );
+        w << ' ' << p.first << "=\"" << p.second << '"';
       }
-      else if ( is_peres( g ) )
-      {
-        cmd = "p";
-      }
-      else if ( is_module( g ) )
-      {
-        cmd = boost::any_cast<module_tag>( g.type() ).name;
-      }
-
-      std::vector<std::string> lines;
+    }
 
-      // Peres is special
-      boost::transform( g.controls(), std::back_inserter( lines ), line_to_variable() );
-      boost::transform( g.targets(), std::back_inserter( lines ), line_to_variable() );
+    w << '\n';
+  }
 
-      os << cmd << " " << boost::algorithm::join( lines, " " );
+  void write_realization( const circuit& circ, buffered_writer& w, const write_realization_settings& settings )
+  {
+    write_realization_header( circ, w, settings );
 
+    for ( const auto& g : circ )
+    {
       boost::optional<const std::map<std::string, std::string>&> annotations = circ.annotations( g );
-      if ( annotations )
-      {
-        std::string sannotations;
-        for ( const auto& p : *annotations )
-        {
-          sannotations += boost::str( boost::format( " %s=\"%s\"" ) % p.first % p.second );
-        }
-        os << " #@" << sannotations;
-      }
-
-      os << std::endl;
+      write_realization_gate( g, annotations ? &*annotations : 0, w );
     }
 
-    os << ".end" << std::endl;
+    w << ".end\n";
+  }
+
+  void write_realization( const circuit& circ, std::ostream& os, const write_realization_settings& settings )
+  {
+    buffered_writer w( os );
+    write_realization( circ, w, settings );
   }
 
   bool write_realization( const circuit& circ, const std::string& filename, const write_realization_settings& settings, std::string* error )
   {
-    std::filebuf fb;
-    if ( !fb.open( filename.c_str(), std::ios::out ) )
+    compressed_ofstream os( filename );
+    if ( !os.is_open() )
     {
       if ( error )
       {
@@ -242,11 +234,16 @@ namespace revkit
       return false;
     }
 
-    std::ostream os( &fb );
-
     write_realization( circ, os, settings );
 
-    fb.close();
+    if ( !os.close() )
+    {
+      if ( error )
+      {
+        *error = "Cannot write " + filename;
+      }
+      return false;
+    }
 
     return true;
   }
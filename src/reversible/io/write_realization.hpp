@@ -28,8 +28,10 @@
 #define WRITE_REALIZATION_HPP
 
 #include <iosfwd>
+#include <map>
 #include <string>
 
+#include <core/io/buffered_writer.hpp>
 #include <reversible/circuit.hpp>
 
 namespace revkit
@@ -85,6 +87,33 @@ namespace revkit
     std::string header;
   };
 
+  /**
+   * @brief Writes the part of a realization before the gates
+   *
+   * Writes the meta-data, buses and modules of \p circ followed by
+   * the \b .begin command.  Together with write_realization_gate
+   * this allows writing gates which are not stored in a circuit.
+   * The realization has to be closed with a \b .end line.
+   *
+   * @param circ     Circuit with the meta-data, its gates are ignored
+   * @param w        Output buffer
+   * @param settings Settings (see write_realization_settings)
+   *
+   * @since  2.0
+   */
+  void write_realization_header( const circuit& circ, buffered_writer& w, const write_realization_settings& settings = write_realization_settings() );
+
+  /**
+   * @brief Writes a single gate line of a realization
+   *
+   * @param g           Gate
+   * @param annotations Annotations of the gate, can be null
+   * @param w           Output buffer
+   *
+   * @since  2.0
+   */
+  void write_realization_gate( const gate& g, const std::map<std::string, std::string>* annotations, buffered_writer& w );
+
   /**
    * @brief Writes a circuit as RevLib realization to an output stream
    *
@@ -113,6 +142,16 @@ namespace revkit
    */
   void write_realization( const circuit& circ, std::ostream& os, const write_realization_settings& settings = write_realization_settings() );
 
+  /**
+   * @brief Writes a circuit as RevLib realization to an output buffer
+   *
+   * The other write_realization functions use this one, the buffer
+   * is flushed when \p w is destroyed.
+   *
+   * @since  2.0
+   */
+  void write_realization( const circuit& circ, buffered_writer& w, const write_realization_settings& settings = write_realization_settings() );
+
   /**
    * @brief Writes a circuit as RevLib realization to a file
    *
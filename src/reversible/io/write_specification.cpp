@@ -19,19 +19,15 @@
 
 #include <fstream>
 
-#include <boost/algorithm/string/join.hpp>
-#include <boost/algorithm/string/replace.hpp>
-#include <boost/assign/std/vector.hpp>
 #include <boost/format.hpp>
 #include <boost/iterator/counting_iterator.hpp>
-#include <boost/spirit/include/karma.hpp>
 
 #include <core/version.hpp>
+#include <core/io/buffered_writer.hpp>
+#include <core/io/compressed_stream.hpp>
 
 #include "io_utils_p.hpp"
 
-using namespace boost::assign;
-
 namespace revkit
 {
 
@@ -59,66 +55,57 @@ namespace revkit
 
   bool write_specification( const binary_truth_table& spec, const std::string& filename, const write_specification_settings& settings )
   {
-    std::filebuf fb;
-    fb.open( filename.c_str(), std::ios::out );
-
-    std::ostream os( &fb );
+    compressed_ofstream os( filename );
 
     if ( spec.num_inputs() < spec.num_outputs() )
     {
       return false;
     }
 
-    unsigned oldsize = 0;
+    buffered_writer w( os );
 
     if ( settings.header.size() )
     {
-      std::string header = settings.header;
-      boost::algorithm::replace_all( header, "\n", "\n# " );
-      os << "# " << header << std::endl;
+      w << "# ";
+      for ( char c : settings.header )
+      {
+        w << c;
+        if ( c == '\n' )
+        {
+          w << "# ";
+        }
+      }
+      w << '\n';
     }
 
-    os << ".version " << settings.version << std::endl
-       << ".numvars " << spec.num_inputs() << std::endl;
-
-    std::vector<std::string> variables( spec.num_inputs() );
+    w << ".version " << settings.version << '\n'
+      << ".numvars " << spec.num_inputs() << '\n';
 
+    w << ".variables";
     for ( unsigned i = 0u; i < spec.num_inputs(); ++i )
     {
-      variables[i] = boost::str( boost::format( "x%d" ) % i );
-    }
-
-    std::vector<std::string> _inputs = spec.inputs();
-    oldsize = _inputs.size();
-    _inputs.resize( spec.num_inputs() );
-
-    for ( unsigned i = oldsize; i < spec.num_inputs(); ++i )
-    {
-      _inputs[i] = boost::str( boost::format( "i%d" ) % i );
+      w << " x" << i;
     }
+    w << '\n';
 
-    std::vector<std::string> _outputs = spec.outputs();
-    oldsize = _outputs.size();
-    _outputs.resize( spec.num_inputs() );
-
-    for ( unsigned i = oldsize; i < spec.num_inputs(); ++i )
-    {
-      _outputs[i] = boost::str( boost::format( "o%d" ) % i );
-    }
-
-    os << ".variables " << boost::algorithm::join( variables, " " ) << std::endl;
-
-    namespace karma = boost::spirit::karma;
-    namespace ascii = boost::spirit::ascii;
-
-    os << ".inputs ";
-    std::ostream_iterator<char> outit( os );
-    karma::generate_delimited( outit, *( karma::no_delimit['"' << karma::string] << '"' ), ascii::space, _inputs );
-    os << std::endl;
+    auto write_names = [&w, &spec]( const char* command, const std::vector<std::string>& names, char prefix ) {
+      w << command;
+      for ( unsigned i = 0u; i < spec.num_inputs(); ++i )
+      {
+        if ( i < names.size() )
+        {
+          w << '"' << names[i] << "\" ";
+        }
+        else
+        {
+          w << '"' << prefix << i << "\" ";
+        }
+      }
+      w << '\n';
+    };
 
-    os << ".outputs ";
-    karma::generate_delimited( outit, *( karma::no_delimit['"' << karma::string] << '"' ), ascii::space, _outputs );
-    os << std::endl;
+    write_names( ".inputs ", spec.inputs(), 'i' );
+    write_names( ".outputs ", spec.outputs(), 'o' );
 
     std::string _constants( spec.num_inputs(), '-' );
     std::transform( spec.constants().begin(), spec.constants().end(), _constants.begin(), tristate_to_char() );
@@ -127,9 +114,9 @@ namespace revkit
     std::vector<bool> garbage = spec.garbage();
     std::transform( garbage.begin(), garbage.end(), _garbage.begin(), garbage_to_char() );
 
-    os << ".constants " << _constants << std::endl
-       << ".garbage " << _garbage << std::endl
-       << ".begin" << std::endl;
+    w << ".constants " << _constants << '\n'
+      << ".garbage " << _garbage << '\n'
+      << ".begin\n";
 
     typedef std::map<unsigned, std::pair<binary_truth_table::out_const_iterator, binary_truth_table::out_const_iterator> > table_type;
     table_type table;
@@ -148,6 +135,7 @@ namespace revkit
 
     table_type::const_iterator itTable = table.begin();
     unsigned position = 0;
+    std::string outLine;
 
     /* output permutation */
     std::vector<unsigned> output_order = settings.output_order;
@@ -164,7 +152,7 @@ namespace revkit
 
       for ( unsigned i = position; i < to; ++i )
       {
-        os << std::string( spec.num_inputs(), '-' ) << std::endl;
+        w.fill( spec.num_inputs(), '-' ) << '\n';
       }
 
       // break if done
@@ -174,22 +162,23 @@ namespace revkit
       }
 
       // now the actual line
-      std::string outLine( spec.num_inputs(), '-' );
+      outLine.assign( spec.num_inputs(), '-' );
       for ( binary_truth_table::out_const_iterator itOut = itTable->second.first; itOut != itTable->second.second; ++itOut )
       {
         outLine.at( output_order.at( itOut - itTable->second.first ) ) = tristate_to_char()( *itOut );
       }
 
-      os << outLine << std::endl;
+      w << outLine << '\n';
 
       position = to + 1;
       ++itTable;
 
     } while ( true );
 
-    os << ".end" << std::endl;
+    w << ".end\n";
+    w.flush();
 
-    fb.close();
+    os.close();
 
     return true;
   }
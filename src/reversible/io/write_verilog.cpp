@@ -17,541 +17,714 @@
 
 #include "write_verilog.hpp"
 
+#include <algorithm>
 #include <fstream>
-#include <sstream>
-
-#include <boost/algorithm/string/join.hpp>
-#include <boost/assign/std/vector.hpp>
-#include <boost/format.hpp>
-#include <boost/range/adaptors.hpp>
-#include <boost/range/algorithm.hpp>
-#include <boost/range/algorithm_ext/push_back.hpp>
+#include <string>
+#include <vector>
+
 #include <boost/none.hpp>
 #include <boost/optional.hpp>
 
+#include <core/io/buffered_writer.hpp>
+
 #include "../circuit.hpp"
 #include "../target_tags.hpp"
-
-using namespace boost::assign;
+#include "../functions/flatten_circuit.hpp"
 
 namespace revkit
 {
 
-  const std::string& add_wire( std::vector<std::string>& wires )
+  /* bus and position in the bus for each line */
+  struct line_bus_index
   {
-    wires += boost::str( boost::format( "tmp%d" ) % wires.size() );
-    return wires.back();
-  }
-
-  bool get_controls( std::vector<std::string>& controls, const gate& g, std::stringstream& body, std::vector<std::string>& wires, const std::vector<std::string>& current_signals, const std::vector<constant>& current_constants )
-  {
-    unsigned line;
-
-    for ( const auto& v : g.controls() )
+    line_bus_index( const bus_collection& buses, unsigned lines )
+      : bus( lines, 0 ),
+        pos( lines, 0u )
     {
-      line = v.line();
-      if ( current_constants.at( line ) ) // is constant
-      {
-        if ( *current_constants.at( line ) == v.polarity() ) // constant matches polarity
-        {
-          continue;
-        }
-        else // is constant 0
-        {
-          return false;
-        }
-      }
-      else
+      for ( const auto& b : buses.buses() )
       {
-        std::string csignal = current_signals.at( line );
-        if ( !v.polarity() )
+        for ( unsigned i = 0u; i < b.second.size(); ++i )
         {
-          csignal = add_wire( wires );
-          body << "  not( " << csignal << ", " << current_signals.at( line ) << " );" << std::endl;
+          if ( !bus[b.second[i]] )
+          {
+            bus[b.second[i]] = &b.first;
+            pos[b.second[i]] = i;
+          }
         }
-        controls += csignal;
       }
     }
 
-    return true;
-  }
+    std::vector<const std::string*> bus;
+    std::vector<unsigned> pos;
+  };
 
-  write_verilog_settings::write_verilog_settings()
-    : propagate_constants( true )
+  /* either the wire tmp<id> or the name of a line (negative id) */
+  struct verilog_signal
   {
-  }
+    static verilog_signal wire( unsigned id ) { return verilog_signal( int( id ) ); }
+    static verilog_signal line( unsigned line ) { return verilog_signal( -1 - int( line ) ); }
 
-  void write_verilog( const circuit& circ, std::ostream& os, const write_verilog_settings& settings )
-  {
-    using boost::adaptors::map_keys;
+    int id;
 
-    // create a flip flop if there are state variables
-    if ( !circ.statesignals().buses().empty() )
+  private:
+    explicit verilog_signal( int id ) : id( id ) {}
+  };
+
+  /* writes the module body, or only counts wires if no writer is given */
+  class verilog_body
+  {
+  public:
+    verilog_body( const std::vector<std::string>& names, buffered_writer* w )
+      : names( names ),
+        w( w )
     {
-      os << "module DFF( CK, D, Q );" << std::endl
-         << "  input CK;" << std::endl
-         << "  input D;" << std::endl
-         << "  output Q;" << std::endl << std::endl
-         << "  reg ff;" << std::endl
-         << "  buf( ff, D );" << std::endl
-         << "  buf( Q, ff );" << std::endl
-         << "endmodule" << std::endl << std::endl;
     }
 
-    // main module body code
-    std::stringstream body;
-
-    std::vector<std::string> current_signals( circ.lines() );
-    std::vector<constant>    current_constants( circ.lines(), constant() );
+    verilog_signal add_wire()
+    {
+      return verilog_signal::wire( num_wires++ );
+    }
 
-    std::vector<std::string> wires;
+    unsigned wires() const
+    {
+      return num_wires;
+    }
 
-    std::copy( circ.inputs().begin(), circ.inputs().end(), current_signals.begin() );
+    verilog_body& operator<<( const char* s )
+    {
+      if ( w ) { *w << s; }
+      return *this;
+    }
 
-    if ( settings.propagate_constants )
+    verilog_body& operator<<( unsigned n )
     {
-      std::copy( circ.constants().begin(), circ.constants().end(), current_constants.begin() );
+      if ( w ) { *w << n; }
+      return *this;
     }
 
-    // adjust inputs: states
+    verilog_body& operator<<( const verilog_signal& s )
     {
-      for ( const auto& bus : circ.statesignals().buses() )
+      if ( w )
       {
-        for ( unsigned i = 0u; i < bus.second.size(); ++i )
+        if ( s.id >= 0 )
         {
-          std::replace( current_signals.begin(), current_signals.end(), circ.inputs().at( bus.second.at( i ) ), boost::str( boost::format( "%s_in[%d]" ) % bus.first % i ) );
+          *w << "tmp" << unsigned( s.id );
+        }
+        else
+        {
+          *w << names[-1 - s.id];
         }
       }
+      return *this;
     }
 
-    // adjust inputs: blocks
+  private:
+    const std::vector<std::string>& names;
+    buffered_writer* w;
+    unsigned num_wires = 0u;
+  };
+
+  bool get_controls( std::vector<verilog_signal>& controls, const gate& g, verilog_body& body, const std::vector<verilog_signal>& current_signals, const std::vector<constant>& current_constants )
+  {
+    unsigned line;
+
+    for ( const auto& v : g.controls() )
     {
-      for ( const auto& bus : circ.inputbuses().buses() )
+      line = v.line();
+      if ( current_constants[line] ) // is constant
       {
-        for ( unsigned i = 0u; i < bus.second.size(); ++i )
+        if ( *current_constants[line] == v.polarity() ) // constant matches polarity
+        {
+          continue;
+        }
+        else // is constant 0
         {
-          std::replace( current_signals.begin(), current_signals.end(), circ.inputs().at( bus.second.at( i ) ), boost::str( boost::format( "%s[%d]" ) % bus.first % i ) );
+          return false;
         }
       }
-    }
-
-    // adjust inputs: constants
-    if ( !settings.propagate_constants )
-    {
-      body << "  // constant assumptions: ";
-      std::vector<std::string> const_assignments;
-      for ( unsigned i = 0u; i < circ.lines(); ++i )
+      else
       {
-        if ( circ.constants().at( i ) )
+        verilog_signal csignal = current_signals[line];
+        if ( !v.polarity() )
         {
-          if ( circ.inputs().at( i ) == "0" || circ.inputs().at( i ) == "1" )
-          {
-            current_signals.at( i ) = boost::str( boost::format( "constant%d_%d" ) % ( *circ.constants().at( i ) ) % i );
-          }
-
-          const_assignments += boost::str( boost::format( "%s == %d" ) % current_signals.at( i ) % *circ.constants().at( i ) );
+          csignal = body.add_wire();
+          body << "  not( " << csignal << ", " << current_signals[line] << " );\n";
         }
+        controls.push_back( csignal );
       }
-      body << boost::algorithm::join( const_assignments, " && " ) << std::endl;
     }
 
-    // adjust inputs: force bad Verilog Code when using constants directly
-    for ( unsigned i = 0u; i < current_constants.size(); ++i )
+    return true;
+  }
+
+  /* AND over all controls as chain of two-input gates, returns the last operand */
+  verilog_signal and_chain( const std::vector<verilog_signal>& controls, verilog_body& body )
+  {
+    verilog_signal acc = controls.front();
+    for ( unsigned i = 1u; i + 1u < controls.size(); ++i )
     {
-      if ( current_constants.at( i ) )
-      {
-        current_signals.at( i ).clear();
-      }
+      verilog_signal tmp_wire = body.add_wire();
+      body << "  and( " << tmp_wire << ", " << acc << ", " << controls[i] << " );\n";
+      acc = tmp_wire;
     }
+    return acc;
+  }
 
-    unsigned pos = 0u;
-    for ( const auto& g : circ )
+  /* returns false if the gate type is not supported */
+  bool write_verilog_gate( const gate& g, verilog_body& body, std::vector<verilog_signal>& current_signals, std::vector<constant>& current_constants )
+  {
+    std::vector<verilog_signal> controls;
+
+    if ( is_toffoli( g ) )
     {
-      body << "  // gate " << pos++ << std::endl;
+      unsigned target_pos = g.targets().front();
+      verilog_signal target_signal = current_signals[target_pos];
+      constant target_constant = current_constants[target_pos];
 
-      if ( is_toffoli( g ) )
+      if ( get_controls( controls, g, body, current_signals, current_constants ) )
       {
-        unsigned target_pos = g.targets().front();
-        std::string target_signal = current_signals.at( target_pos );
-        constant target_constant = current_constants.at( target_pos );
+        verilog_signal new_target = target_signal;
 
-        std::vector<std::string> controls;
-        if ( get_controls( controls, g, body, wires, current_signals, current_constants ) )
+        switch ( controls.size() )
         {
-          switch ( controls.size() )
+        case 0:
+          if ( target_constant )
           {
-          case 0:
-            if ( target_constant )
-            {
-              current_constants.at( target_pos ) = !*target_constant;
-              continue;
-            }
-            else
-            {
-              body << "  not( " << add_wire( wires ) << ", " << target_signal << " );" << std::endl;
-            }
-            break;
+            current_constants[target_pos] = !*target_constant;
+            return true;
+          }
+          else
+          {
+            new_target = body.add_wire();
+            body << "  not( " << new_target << ", " << target_signal << " );\n";
+          }
+          break;
+
+        case 1:
+          new_target = body.add_wire();
+          if ( target_constant )
+          {
+            body << "  " << ( *target_constant ? "not" : "buf" ) << "( " << new_target << ", " << controls.front() << " );\n";
+          }
+          else
+          {
+            body << "  xor( " << new_target << ", " << target_signal << ", " << controls.front() << " );\n";
+          }
+          break;
+
+        default:
+          {
+            verilog_signal acc = and_chain( controls, body );
+
+            verilog_signal and_wire = body.add_wire();
+            body << "  and( " << and_wire << ", " << acc << ", " << controls.back() << " );\n";
 
-          case 1:
+            new_target = body.add_wire();
             if ( target_constant )
             {
-              body << "  " << ( *target_constant ? "not" : "buf" ) << "( " << add_wire( wires ) << ", " << controls.front() << " );" << std::endl;
+              body << "  " << ( *target_constant ? "not" : "buf" ) << "( " << new_target << ", " << and_wire << " );\n";
             }
             else
             {
-              body << "  xor( " << add_wire( wires ) << ", " << target_signal << ", " << controls.front() << " );" << std::endl;
+              body << "  xor( " << new_target << ", " << target_signal << ", " << and_wire << " );\n";
             }
             break;
-
-          default:
-            {
-              while ( controls.size() > 2u )
-              {
-                std::string tmp_wire = add_wire( wires );
-                body << "  and( " << tmp_wire << ", " << controls.at( 0u ) << ", " << controls.at( 1u ) << " );" << std::endl;
-                controls.erase( controls.begin() );
-                controls.erase( controls.begin() );
-                controls.insert( controls.begin(), tmp_wire );
-              }
-
-              std::string and_wire = add_wire( wires );
-              body << "  and( " << and_wire << ", " << boost::algorithm::join( controls, ", " ) << " );" << std::endl;
-
-              if ( target_constant )
-              {
-                body << "  " << ( *target_constant ? "not" : "buf" ) << "( " << add_wire( wires ) << ", " << and_wire << " );" << std::endl;
-              }
-              else
-              {
-                body << "  xor( " << add_wire( wires ) << ", " << target_signal << ", " << and_wire << " );" << std::endl;
-              }
-              break;
-            }
           }
-
-          // update current_signals and current_constants
-          current_signals.at( target_pos ) = wires.back();
-          current_constants.at( target_pos ) = boost::none;
         }
+
+        // update current_signals and current_constants
+        current_signals[target_pos] = new_target;
+        current_constants[target_pos] = boost::none;
       }
-      else if ( is_fredkin( g ) )
+    }
+    else if ( is_fredkin( g ) )
+    {
+      unsigned target_pos1 = g.targets()[0u];
+      unsigned target_pos2 = g.targets()[1u];
+      verilog_signal target_signal1 = current_signals[target_pos1];
+      verilog_signal target_signal2 = current_signals[target_pos2];
+      constant target_constant1 = current_constants[target_pos1];
+      constant target_constant2 = current_constants[target_pos2];
+
+      if ( get_controls( controls, g, body, current_signals, current_constants ) )
       {
-        unsigned target_pos1 = g.targets()[0u];
-        unsigned target_pos2 = g.targets()[1u];
-        std::string target_signal1 = current_signals.at( target_pos1 );
-        std::string target_signal2 = current_signals.at( target_pos2 );
-        constant target_constant1 = current_constants.at( target_pos1 );
-        constant target_constant2 = current_constants.at( target_pos2 );
-
-        std::vector<std::string> controls;
-        if ( get_controls( controls, g, body, wires, current_signals, current_constants ) )
+        boost::optional<verilog_signal> new_target1;
+        boost::optional<verilog_signal> new_target2;
+
+        switch ( controls.size() )
         {
-          std::string new_target1;
-          std::string new_target2;
+        case 0:
+          if ( target_constant1 )
+          {
+            current_constants[target_pos2] = *target_constant1;
+          }
+          else
+          {
+            new_target2 = body.add_wire();
+            body << "  buf( " << *new_target2 << ", " << target_signal1 << " );\n";
+          }
 
-          switch ( controls.size() )
+          if ( target_constant2 )
           {
-          case 0:
-            if ( target_constant1 )
-            {
-              current_constants.at( target_pos2 ) = *target_constant1;
-            }
-            else
-            {
-              new_target2 = add_wire( wires );
-              body << "  buf( " << new_target2 << ", " << target_signal1 << std::endl;
-            }
+            current_constants[target_pos1] = *target_constant2;
+          }
+          else
+          {
+            new_target1 = body.add_wire();
+            body << "  buf( " << *new_target1 << ", " << target_signal2 << " );\n";
+          }
+          break;
 
-            if ( target_constant2 )
-            {
-              current_constants.at( target_pos1 ) = *target_constant2;
-            }
-            else
+        case 1:
+          if ( target_constant1 && !target_constant2 )
+          {
+            // select inverse
+            verilog_signal not_controls = body.add_wire();
+            body << "  not( " << not_controls << ", " << controls.front() << " );\n";
+
+            new_target1 = body.add_wire();
+            new_target2 = body.add_wire();
+
+            body << "  " << ( *target_constant1 ? "or" : "and" ) << "( " << *new_target1 << ", " << ( *target_constant1 ? not_controls : controls.front() ) << ", " << target_signal2 << " );\n";
+            body << "  " << ( *target_constant1 ? "or" : "and" ) << "( " << *new_target2 << ", " << ( *target_constant1 ? controls.front() : not_controls ) << ", " << target_signal2 << " );\n";
+          }
+          else if ( !target_constant1 && target_constant2 )
+          {
+            // select inverse
+            verilog_signal not_controls = body.add_wire();
+            body << "  not( " << not_controls << ", " << controls.front() << " );\n";
+
+            new_target1 = body.add_wire();
+            new_target2 = body.add_wire();
+
+            body << "  " << ( *target_constant2 ? "or" : "and" ) << "( " << *new_target1 << ", " << ( *target_constant2 ? controls.front() : not_controls ) << ", " << target_signal1 << " );\n";
+            body << "  " << ( *target_constant2 ? "or" : "and" ) << "( " << *new_target2 << ", " << ( *target_constant2 ? not_controls : controls.front() ) << ", " << target_signal1 << " );\n";
+          }
+          else if ( target_constant1 && target_constant2 )
+          {
+            // only consider if constants are different
+            if ( *target_constant1 != *target_constant2 )
             {
-              new_target1 = add_wire( wires );
-              body << "  buf( " << new_target1 << ", " << target_signal2 << std::endl;
+              // select inverse
+              verilog_signal not_controls = body.add_wire();
+              body << "  not( " << not_controls << ", " << controls.front() << " );\n";
+
+              new_target1 = body.add_wire();
+              new_target2 = body.add_wire();
+
+              body << "  buf( " << *new_target1 << ", " << ( *target_constant1 ? not_controls : controls.front() ) << " );\n";
+              body << "  buf( " << *new_target2 << ", " << ( *target_constant1 ? controls.front() : not_controls ) << " );\n";
             }
-            break;
+          }
+          else
+          {
+            // select
+            verilog_signal ctrls = controls.front();
+
+            // select inverse
+            verilog_signal not_ctrls = body.add_wire();
+            body << "  not( " << not_ctrls << ", " << ctrls << " );\n";
+
+            // products
+            verilog_signal ct1  = body.add_wire();
+            verilog_signal ct2  = body.add_wire();
+            verilog_signal nct1 = body.add_wire();
+            verilog_signal nct2 = body.add_wire();
+
+            body << "  and( " << ct1  << ", " << ctrls << ", " << target_signal1 << " );\n";
+            body << "  and( " << ct2  << ", " << ctrls << ", " << target_signal2 << " );\n";
+            body << "  and( " << nct1 << ", " << not_ctrls << ", " << target_signal1 << " );\n";
+            body << "  and( " << nct2 << ", " << not_ctrls << ", " << target_signal2 << " );\n";
+
+            new_target1 = body.add_wire();
+            new_target2 = body.add_wire();
+
+            body << "  or( " << *new_target1 << ", " << ct2 << ", " << nct1 << " );\n";
+            body << "  or( " << *new_target2 << ", " << ct1 << ", " << nct2 << " );\n";
+          }
+          break;
+
+        default:
+          {
+            // select
+            verilog_signal acc = and_chain( controls, body );
+
+            verilog_signal ctrls = body.add_wire();
+            body << "  and( " << ctrls << ", " << acc << ", " << controls.back() << " );\n";
+
+            // select inverse
+            verilog_signal not_ctrls = body.add_wire();
+            body << "  not( " << not_ctrls << ", " << ctrls << " );\n";
 
-          case 1:
             if ( target_constant1 && !target_constant2 )
             {
-              // select inverse
-              std::string not_controls = add_wire( wires );
-              body << "  not( " << not_controls << ", " << controls.front() << " );" << std::endl;
-
-              new_target1 = add_wire( wires );
-              new_target2 = add_wire( wires );
+              new_target1 = body.add_wire();
+              new_target2 = body.add_wire();
 
-              body << "  " << ( *target_constant1 ? "or" : "and" ) << "( " << new_target1 << ( *target_constant1 ? not_controls : controls.front() ) << ", " << target_signal2 << " );" << std::endl;
-              body << "  " << ( *target_constant1 ? "or" : "and" ) << "( " << new_target2 << ( *target_constant1 ? controls.front() : not_controls ) << ", " << target_signal2 << " );" << std::endl;
+              body << "  " << ( *target_constant1 ? "or" : "and" ) << "( " << *new_target1 << ", " << ( *target_constant1 ? not_ctrls : ctrls ) << ", " << target_signal2 << " );\n";
+              body << "  " << ( *target_constant1 ? "or" : "and" ) << "( " << *new_target2 << ", " << ( *target_constant1 ? ctrls : not_ctrls ) << ", " << target_signal2 << " );\n";
             }
             else if ( !target_constant1 && target_constant2 )
             {
-              // select inverse
-              std::string not_controls = add_wire( wires );
-              body << "  not( " << not_controls << ", " << controls.front() << " );" << std::endl;
-
-              new_target1 = add_wire( wires );
-              new_target2 = add_wire( wires );
+              new_target1 = body.add_wire();
+              new_target2 = body.add_wire();
 
-              body << "  " << ( *target_constant2 ? "or" : "and" ) << "( " << new_target1 << ", " << ( *target_constant2 ? controls.front() : not_controls ) << ", " << target_signal1 << " );" << std::endl;
-              body << "  " << ( *target_constant2 ? "or" : "and" ) << "( " << new_target2 << ", " << ( *target_constant2 ? not_controls : controls.front() ) << ", " << target_signal1 << " );" << std::endl;
+              body << "  " << ( *target_constant2 ? "or" : "and" ) << "( " << *new_target1 << ", " << ( *target_constant2 ? ctrls : not_ctrls ) << ", " << target_signal1 << " );\n";
+              body << "  " << ( *target_constant2 ? "or" : "and" ) << "( " << *new_target2 << ", " << ( *target_constant2 ? not_ctrls : ctrls ) << ", " << target_signal1 << " );\n";
             }
             else if ( target_constant1 && target_constant2 )
             {
               // only consider if constants are different
               if ( *target_constant1 != *target_constant2 )
               {
-                // select inverse
-                std::string not_controls = add_wire( wires );
-                body << "  not( " << not_controls << ", " << controls.front() << " );" << std::endl;
-
-                new_target1 = add_wire( wires );
-                new_target2 = add_wire( wires );
+                new_target1 = body.add_wire();
+                new_target2 = body.add_wire();
 
-                body << "  buf(" << new_target1 << ", " << ( *target_constant1 ? not_controls : controls.front() ) << std::endl;
-                body << "  buf(" << new_target2 << ", " << ( *target_constant1 ? controls.front() : not_controls ) << std::endl;
+                body << "  buf( " << *new_target1 << ", " << ( *target_constant1 ? not_ctrls : ctrls ) << " );\n";
+                body << "  buf( " << *new_target2 << ", " << ( *target_constant1 ? ctrls : not_ctrls ) << " );\n";
               }
             }
             else
             {
-              // select
-              std::string ctrls = controls.front();
-
-              // select inverse
-              std::string not_ctrls = add_wire( wires );
-              body << boost::format( "  not( %s, %s );" ) % not_ctrls % ctrls << std::endl;
-
               // products
-              std::string ct1  = add_wire( wires );
-              std::string ct2  = add_wire( wires );
-              std::string nct1 = add_wire( wires );
-              std::string nct2 = add_wire( wires );
+              verilog_signal ct1  = body.add_wire();
+              verilog_signal ct2  = body.add_wire();
+              verilog_signal nct1 = body.add_wire();
+              verilog_signal nct2 = body.add_wire();
 
-              body << boost::format( "  and( %s, %s, %s );" ) % ct1  % ctrls % target_signal1 << std::endl;
-              body << boost::format( "  and( %s, %s, %s );" ) % ct2  % ctrls % target_signal2 << std::endl;
-              body << boost::format( "  and( %s, %s, %s );" ) % nct1 % not_ctrls % target_signal1 << std::endl;
-              body << boost::format( "  and( %s, %s, %s );" ) % nct2 % not_ctrls % target_signal2 << std::endl;
+              body << "  and( " << ct1  << ", " << ctrls << ", " << target_signal1 << " );\n";
+              body << "  and( " << ct2  << ", " << ctrls << ", " << target_signal2 << " );\n";
+              body << "  and( " << nct1 << ", " << not_ctrls << ", " << target_signal1 << " );\n";
+              body << "  and( " << nct2 << ", " << not_ctrls << ", " << target_signal2 << " );\n";
 
-              new_target1 = add_wire( wires );
-              new_target2 = add_wire( wires );
+              new_target1 = body.add_wire();
+              new_target2 = body.add_wire();
 
-              body << boost::format( "  or( %s, %s, %s );" ) % new_target1 % ct2 % nct1 << std::endl;
-              body << boost::format( "  or( %s, %s, %s );" ) % new_target2 % ct1 % nct2 << std::endl;
+              body << "  or( " << *new_target1 << ", " << ct2 << ", " << nct1 << " );\n";
+              body << "  or( " << *new_target2 << ", " << ct1 << ", " << nct2 << " );\n";
             }
             break;
+          }
+        }
 
-          default:
-            {
-              // select
-              while ( controls.size() > 2u )
-              {
-                std::string tmp_wire = add_wire( wires );
-                body << "  and( " << tmp_wire << ", " << controls.at( 0u ) << ", " << controls.at( 1u ) << " );" << std::endl;
-                controls.erase( controls.begin() );
-                controls.erase( controls.begin() );
-                controls.insert( controls.begin(), tmp_wire );
-              }
+        // update current_signals and current_constants
+        if ( new_target1 )
+        {
+          current_signals[target_pos1] = *new_target1;
+          current_constants[target_pos1] = boost::none;
+        }
 
-              std::string ctrls = add_wire( wires );
-              body << "  and( " << ctrls << ", " << boost::algorithm::join( controls, ", " ) << " );" << std::endl;
+        if ( new_target2 )
+        {
+          current_signals[target_pos2] = *new_target2;
+          current_constants[target_pos2] = boost::none;
+        }
+      }
+    }
+    else
+    {
+      return false;
+    }
 
-              // select inverse
-              std::string not_ctrls = add_wire( wires );
-              body << boost::format( "  not( %s, %s );" ) % not_ctrls % ctrls << std::endl;
+    return true;
+  }
 
-              if ( target_constant1 && !target_constant2 )
-              {
-                new_target1 = add_wire( wires );
-                new_target2 = add_wire( wires );
+  bool write_verilog_gates( const circuit& circ, verilog_body& body, std::vector<verilog_signal>& current_signals, std::vector<constant>& current_constants )
+  {
+    unsigned pos = 0u;
 
-                body << "  " << ( *target_constant1 ? "or" : "and" ) << "( " << new_target1 << ", " << ( *target_constant1 ? not_ctrls : ctrls ) << ", " << target_signal2 << " );" << std::endl;
-                body << "  " << ( *target_constant1 ? "or" : "and" ) << "( " << new_target2 << ", " << ( *target_constant1 ? ctrls : not_ctrls ) << ", " << target_signal2 << " );" << std::endl;
-              }
-              else if ( !target_constant1 && target_constant2 )
-              {
-                new_target1 = add_wire( wires );
-                new_target2 = add_wire( wires );
+    for ( const auto& g : circ )
+    {
+      body << "  // gate " << pos++ << "\n";
 
-                body << "  " << ( *target_constant2 ? "or" : "and" ) << "( " << new_target1 << ", " << ( *target_constant2 ? ctrls : not_ctrls ) << ", " << target_signal1 << " );" << std::endl;
-                body << "  " << ( *target_constant2 ? "or" : "and" ) << "( " << new_target2 << ", " << ( *target_constant2 ? not_ctrls : ctrls ) << ", " << target_signal1 << " );" << std::endl;
-              }
-              else if ( target_constant1 && target_constant2 )
-              {
-                // only consider if constants are different
-                if ( *target_constant1 != *target_constant2 )
-                {
-                  new_target1 = add_wire( wires );
-                  new_target2 = add_wire( wires );
-
-                  body << "  buf(" << new_target1 << ", " << ( *target_constant1 ? not_ctrls : ctrls ) << std::endl;
-                  body << "  buf(" << new_target2 << ", " << ( *target_constant1 ? ctrls : not_ctrls ) << std::endl;
-                }
-              }
-              else
-              {
-                // products
-                std::string ct1  = add_wire( wires );
-                std::string ct2  = add_wire( wires );
-                std::string nct1 = add_wire( wires );
-                std::string nct2 = add_wire( wires );
-
-                body << boost::format( "  and( %s, %s, %s );" ) % ct1  % ctrls % target_signal1 << std::endl;
-                body << boost::format( "  and( %s, %s, %s );" ) % ct2  % ctrls % target_signal2 << std::endl;
-                body << boost::format( "  and( %s, %s, %s );" ) % nct1 % not_ctrls % target_signal1 << std::endl;
-                body << boost::format( "  and( %s, %s, %s );" ) % nct2 % not_ctrls % target_signal2 << std::endl;
-
-                new_target1 = add_wire( wires );
-                new_target2 = add_wire( wires );
-
-                body << boost::format( "  or( %s, %s, %s );" ) % new_target1 % ct2 % nct1 << std::endl;
-                body << boost::format( "  or( %s, %s, %s );" ) % new_target2 % ct1 % nct2 << std::endl;
-              }
-              break;
-            }
-          }
+      if ( is_peres( g ) )
+      {
+        // Toffoli gate on the second target followed by a CNOT gate on the first one
+        gate toffoli;
+        toffoli.add_control( g.controls().front() );
+        toffoli.add_control( make_var( g.targets().at( 0u ) ) );
+        toffoli.add_target( g.targets().at( 1u ) );
+        toffoli.set_type( toffoli_tag() );
+
+        gate cnot;
+        cnot.add_control( g.controls().front() );
+        cnot.add_target( g.targets().at( 0u ) );
+        cnot.set_type( toffoli_tag() );
+
+        write_verilog_gate( toffoli, body, current_signals, current_constants );
+        write_verilog_gate( cnot, body, current_signals, current_constants );
+      }
+      else if ( !write_verilog_gate( g, body, current_signals, current_constants ) )
+      {
+        return false;
+      }
+    }
 
-          // update current_signals and current_constants
-          if ( !new_target1.empty() )
-          {
-            current_signals.at( target_pos1 ) = new_target1;
-            current_constants.at( target_pos1 ) = boost::none;
-          }
+    return true;
+  }
 
-          if ( !new_target2.empty() )
-          {
-            current_signals.at( target_pos2 ) = new_target2;
-            current_constants.at( target_pos2 ) = boost::none;
-          }
-        }
+  write_verilog_settings::write_verilog_settings()
+    : propagate_constants( true )
+  {
+  }
+
+  bool write_verilog( const circuit& circ, std::ostream& os, const write_verilog_settings& settings, std::string* error )
+  {
+    const unsigned lines = circ.lines();
+    line_bus_index inputbus_index( circ.inputbuses(), lines );
+    line_bus_index outputbus_index( circ.outputbuses(), lines );
+    line_bus_index state_index( circ.statesignals(), lines );
+
+    // modules are written as their gates
+    circuit flattened;
+    bool has_modules = std::any_of( circ.begin(), circ.end(), []( const gate& g ) { return is_module( g ); } );
+    if ( has_modules )
+    {
+      flatten_circuit( circ, flattened );
+    }
+    const circuit& gates = has_modules ? flattened : circ;
+
+    // names of the lines at the inputs
+    std::vector<std::string> names( circ.inputs().begin(), circ.inputs().end() );
+    std::vector<constant> current_constants( lines, constant() );
+
+    if ( settings.propagate_constants )
+    {
+      std::copy( circ.constants().begin(), circ.constants().end(), current_constants.begin() );
+    }
+
+    for ( unsigned i = 0u; i < lines; ++i )
+    {
+      // adjust inputs: states and blocks
+      if ( state_index.bus[i] )
+      {
+        names[i] = *state_index.bus[i] + "_in[" + std::to_string( state_index.pos[i] ) + ']';
       }
-      else
+      else if ( inputbus_index.bus[i] )
+      {
+        names[i] = *inputbus_index.bus[i] + '[' + std::to_string( inputbus_index.pos[i] ) + ']';
+      }
+
+      // adjust inputs: constants
+      if ( !settings.propagate_constants && circ.constants()[i] && ( circ.inputs()[i] == "0" || circ.inputs()[i] == "1" ) )
+      {
+        names[i] = "constant" + std::to_string( unsigned( *circ.constants()[i] ) ) + '_' + std::to_string( i );
+      }
+
+      // adjust inputs: force bad Verilog Code when using constants directly
+      if ( current_constants[i] )
       {
-        // TODO implement other gate types
-        assert( false );
+        names[i].clear();
       }
     }
 
+    std::vector<verilog_signal> initial_signals;
+    for ( unsigned i = 0u; i < lines; ++i )
+    {
+      initial_signals.push_back( verilog_signal::line( i ) );
+    }
+
+    // first pass: count wires for the declaration
+    unsigned num_wires;
+    {
+      std::vector<verilog_signal> current_signals( initial_signals );
+      std::vector<constant> constants( current_constants );
+      verilog_body counter( names, 0 );
+      if ( !write_verilog_gates( gates, counter, current_signals, constants ) )
+      {
+        if ( error )
+        {
+          *error = "Unsupported gate type for Verilog";
+        }
+        return false;
+      }
+      num_wires = counter.wires();
+    }
+
+    buffered_writer w( os );
+
+    // create a flip flop if there are state variables
+    if ( !circ.statesignals().buses().empty() )
+    {
+      w << "module DFF( CK, D, Q );\n"
+        << "  input CK;\n"
+        << "  input D;\n"
+        << "  output Q;\n\n"
+        << "  reg ff;\n"
+        << "  buf( ff, D );\n"
+        << "  buf( Q, ff );\n"
+        << "endmodule\n\n";
+    }
+
     // write top module code
     std::vector<std::string> inputs;
     std::vector<std::string> outputs;
 
     // inputs and outputs
-    for ( unsigned i = 0u; i < circ.lines(); ++i )
+    for ( unsigned i = 0u; i < lines; ++i )
     {
-      if ( ( !circ.constants().at( i ) || !settings.propagate_constants ) && circ.statesignals().find_bus( i ).empty() && circ.inputbuses().find_bus( i ).empty() )
+      if ( ( !circ.constants()[i] || !settings.propagate_constants ) && !state_index.bus[i] && !inputbus_index.bus[i] )
       {
-        std::string name = circ.inputs().at( i );
+        const std::string& name = circ.inputs()[i];
 
         if ( name == "0" || name == "1" )
         {
-          name = boost::str( boost::format( "constant%s_%d" ) % name % i );
+          inputs.push_back( "constant" + name + '_' + std::to_string( i ) );
+        }
+        else
+        {
+          inputs.push_back( name );
         }
-
-        inputs += name;
       }
 
-      if ( !circ.garbage().at( i ) && circ.statesignals().find_bus( i ).empty() && circ.outputbuses().find_bus( i ).empty() )
+      if ( !circ.garbage()[i] && !state_index.bus[i] && !outputbus_index.bus[i] )
       {
-        outputs += circ.outputs().at( i );
+        outputs.push_back( circ.outputs()[i] );
       }
     }
 
-    std::vector<std::string> signals;
-    boost::push_back( signals, inputs );
-    boost::push_back( signals, circ.inputbuses().buses() | map_keys );
-    boost::push_back( signals, outputs );
-    boost::push_back( signals, circ.outputbuses().buses() | map_keys );
-    boost::for_each( circ.statesignals().buses() | map_keys, [&signals](const std::string& name) { signals += name + "_out"; } );
-
-    os << "module top( clk, " << boost::algorithm::join( signals, ", " ) << " );" << std::endl;
-
-    os << "  input clk;" << std::endl;
+    bool first = true;
+    auto write_list = [&w, &first]( const std::string& name ) {
+      if ( !first ) { w << ", "; }
+      w << name;
+      first = false;
+    };
+
+    w << "module top( clk, ";
+    for ( const auto& name : inputs ) { write_list( name ); }
+    for ( const auto& bus : circ.inputbuses().buses() ) { write_list( bus.first ); }
+    for ( const auto& name : outputs ) { write_list( name ); }
+    for ( const auto& bus : circ.outputbuses().buses() ) { write_list( bus.first ); }
+    for ( const auto& bus : circ.statesignals().buses() ) { write_list( bus.first + "_out" ); }
+    w << " );\n";
+
+    w << "  input clk;\n";
     if ( inputs.size() )
     {
-      os << "  input " << boost::algorithm::join( inputs, ", " ) << ";" << std::endl;
+      first = true;
+      w << "  input ";
+      for ( const auto& name : inputs ) { write_list( name ); }
+      w << ";\n";
     }
 
     for ( const auto& bus : circ.inputbuses().buses() )
     {
-      os << boost::format( "  input [%d:0] %s;" ) % ( bus.second.size() - 1u ) % bus.first << std::endl;
+      w << "  input [" << unsigned( bus.second.size() - 1u ) << ":0] " << bus.first << ";\n";
     }
 
     if ( outputs.size() )
     {
-      os << "  output " << boost::algorithm::join( outputs, ", " ) << ";" << std::endl;
+      first = true;
+      w << "  output ";
+      for ( const auto& name : outputs ) { write_list( name ); }
+      w << ";\n";
     }
 
     for ( const auto& bus : circ.outputbuses().buses() )
     {
-      os << boost::format( "  output [%d:0] %s;" ) % ( bus.second.size() - 1u ) % bus.first << std::endl;
+      w << "  output [" << unsigned( bus.second.size() - 1u ) << ":0] " << bus.first << ";\n";
     }
 
-    os << "  wire " << boost::algorithm::join( wires, ", " ) << ";" << std::endl;
+    w << "  wire ";
+    for ( unsigned i = 0u; i < num_wires; ++i )
+    {
+      if ( i ) { w << ", "; }
+      w << "tmp" << i;
+    }
+    w << ";\n";
 
     for ( const auto& bus : circ.statesignals().buses() )
     {
-      os << boost::format( "  wire [%d:0] %s_in;" ) % ( bus.second.size() - 1u ) % bus.first << std::endl;
+      w << "  wire [" << unsigned( bus.second.size() - 1u ) << ":0] " << bus.first << "_in;\n";
     }
 
     for ( const auto& bus : circ.statesignals().buses() )
     {
-      os << boost::format( "  output [%d:0] %s_out;" ) % ( bus.second.size() - 1u ) % bus.first << std::endl;
+      w << "  output [" << unsigned( bus.second.size() - 1u ) << ":0] " << bus.first << "_out;\n";
     }
 
-    os << body.str() << std::endl;
+    // second pass: module body
+    verilog_body body( names, &w );
+
+    if ( !settings.propagate_constants )
+    {
+      body << "  // constant assumptions: ";
+      first = true;
+      for ( unsigned i = 0u; i < lines; ++i )
+      {
+        if ( circ.constants()[i] )
+        {
+          body << ( first ? "" : " && " ) << verilog_signal::line( i ) << " == " << unsigned( *circ.constants()[i] );
+          first = false;
+        }
+      }
+      body << "\n";
+    }
+
+    std::vector<verilog_signal> current_signals( initial_signals );
+    write_verilog_gates( gates, body, current_signals, current_constants );
+
+    w << "\n";
 
     // map outputs
-    os << "  // map outputs" << std::endl;
-    for ( unsigned i = 0u; i < circ.lines(); ++i )
+    w << "  // map outputs\n";
+    for ( unsigned i = 0u; i < lines; ++i )
     {
-      if ( !circ.garbage().at( i ) )
+      if ( !circ.garbage()[i] )
       {
-        std::string output_signal = circ.outputs().at( i );
+        body << "  buf( ";
 
+        // is state
+        if ( state_index.bus[i] )
+        {
+          w << *state_index.bus[i] << "_out[" << state_index.pos[i] << ']';
+        }
         // is in block?
-        std::string bus_name = circ.outputbuses().find_bus( i );
-        if ( !bus_name.empty() )
+        else if ( outputbus_index.bus[i] )
         {
-          const std::vector<unsigned>& line_indices = circ.outputbuses().get( bus_name );
-          unsigned pos_in_block = std::find( line_indices.begin(), line_indices.end(), i ) - line_indices.begin();
-          output_signal = boost::str( boost::format( "%s[%d]" ) % bus_name % pos_in_block );
+          w << *outputbus_index.bus[i] << '[' << outputbus_index.pos[i] << ']';
         }
-
-        // is state
-        std::vector<unsigned>::const_iterator itState;
-        if ( circ.statesignals().has_bus( i ) )
+        else
         {
-          output_signal = boost::str( boost::format( "%s_out[%d]" ) % circ.statesignals().find_bus( i ) % circ.statesignals().signal_index( i ) );
+          w << circ.outputs()[i];
         }
 
-        os << boost::format( "  buf( %s, %s );" ) % output_signal % current_signals.at( i ) << std::endl;
+        body << ", " << current_signals[i] << " );\n";
       }
     }
 
     // map state signals
-    os << std::endl << "  // map state signals" << std::endl;
+    w << "\n  // map state signals\n";
     for ( const auto& bus : circ.statesignals().buses() )
     {
       for ( unsigned i = 0u; i < bus.second.size(); ++i )
       {
-        os << boost::format( "  DFF( clk, %1%_out[%2%], %1%_in[%2%] );" ) % bus.first % i << std::endl;
+        w << "  DFF( clk, " << bus.first << "_out[" << i << "], " << bus.first << "_in[" << i << "] );\n";
       }
     }
 
-    os << "endmodule" << std::endl;
+    w << "endmodule\n";
+
+    return true;
   }
 
-  void write_verilog( const circuit& circ, const std::string& filename, const write_verilog_settings& settings )
+  bool write_verilog( const circuit& circ, const std::string& filename, const write_verilog_settings& settings, std::string* error )
   {
     std::filebuf fb;
-    fb.open( filename.c_str(), std::ios::out );
+    if ( !fb.open( filename.c_str(), std::ios::out ) )
+    {
+      if ( error )
+      {
+        *error = "Cannot write " + filename;
+      }
+      return false;
+    }
     std::ostream os( &fb );
 
-    write_verilog( circ, os, settings );
+    bool result = write_verilog( circ, os, settings, error );
 
     fb.close();
+    return result;
   }
 
 }
@@ -28,6 +28,7 @@
 #define WRITE_VERILOG_HPP
 
 #include <iostream>
+#include <string>
 
 namespace revkit
 {
@@ -69,13 +70,20 @@ namespace revkit
    *
    * This function dumps the circuit as a Verilog file.
    *
+   * Toffoli, Fredkin, Peres, and module gates are supported,
+   * modules are written as their gates.
+   *
    * @param circ Circuit
    * @param os Output Stream to write to
    * @param settings Settings
+   * @param error A pointer to a string. In case the circuit cannot
+   *              be translated, and \p error is not null, a error message is stored
+   *
+   * @return true on success, false otherwise, in which case nothing is written
    *
    * @since  1.1
    */
-  void write_verilog( const circuit& circ, std::ostream& os = std::cout, const write_verilog_settings& settings = write_verilog_settings() );
+  bool write_verilog( const circuit& circ, std::ostream& os = std::cout, const write_verilog_settings& settings = write_verilog_settings(), std::string* error = 0 );
 
   /**
    * @brief Writes a circuit to a Verilog file
@@ -85,10 +93,14 @@ namespace revkit
    * @param circ Circuit
    * @param filename Filename
    * @param settings Settings
+   * @param error A pointer to a string. In case the file cannot be written,
+   *              and \p error is not null, a error message is stored
+   *
+   * @return true on success, false otherwise
    *
    * @since  2.0
    */
-  void write_verilog( const circuit& circ, const std::string& filename, const write_verilog_settings& settings = write_verilog_settings() );
+  bool write_verilog( const circuit& circ, const std::string& filename, const write_verilog_settings& settings = write_verilog_settings(), std::string* error = 0 );
 
 }
 
@@ -17,10 +17,8 @@
 
 #include "adding_lines.hpp"
 
-#include <boost/dynamic_bitset.hpp>
-#include <boost/range/adaptors.hpp>
+#include <boost/algorithm/cxx11/all_of.hpp>
 #include <boost/range/algorithm.hpp>
-#include <boost/range/irange.hpp>
 
 #include <core/functor.hpp>
 #include <core/utils/timer.hpp>
@@ -31,62 +29,27 @@
 #include <reversible/functions/copy_circuit.hpp>
 #include <reversible/functions/copy_metadata.hpp>
 #include <reversible/utils/costs.hpp>
+#include <reversible/utils/gate_dag.hpp>
 
 namespace revkit
 {
 
-  template<typename Iterator, typename OutputIterator>
-  OutputIterator _make_factor( Iterator first, Iterator last, const boost::dynamic_bitset<>& factor, OutputIterator output )
+  /* gate with the targets of g only, a graph of these gates finds the next gate writing to a line */
+  gate target_gate( const gate& g )
   {
-    for ( Iterator it = first; it != last; ++it )
+    gate tg;
+    for ( unsigned t : g.targets() )
     {
-      if ( factor.test( it->index() ) )
-      {
-        *output++ = it->value();
-      }
+      tg.add_target( t );
     }
-
-    return output;
-  }
-
-  template<typename SinglePassRange, typename OutputIterator>
-  OutputIterator _make_factor( const SinglePassRange& range, const boost::dynamic_bitset<>& factor, OutputIterator output )
-  {
-    return _make_factor( boost::begin( range ), boost::end( range ), factor, output );
+    return tg;
   }
 
-  template<typename SinglePassRange, typename OutputContainer>
-  void make_factor( const SinglePassRange& range, const boost::dynamic_bitset<>& factor, OutputContainer& output )
+  /* controls are not sorted, hence each control of the factor is looked up */
+  bool has_factor( const gate& g, const gate::control_container& factor )
   {
-    _make_factor( range | boost::adaptors::indexed( 0u ), factor, std::insert_iterator<OutputContainer>( output, output.begin() ) );
-  }
-
-  unsigned find_suitable_gates( const circuit& base, unsigned index, const gate::control_container& factor )
-  {
-    using boost::adaptors::transformed;
-
-    // last gate?
-    if ( index == base.num_gates() )
-    {
-      return index;
-    }
-
-    // only Toffoli gates
-    if ( !is_toffoli( base[index] ) )
-    {
-      return index;
-    }
-
-    // NOTE check for helper line?
-    // has target in controls?
-    auto container = factor | transformed( []( variable v ) { return v.line(); } );
-    if ( boost::find( container, base[index].targets().front() ) != boost::end( container ) )
-    {
-      return index;
-    }
-
-    // check next gate
-    return find_suitable_gates( base, index + 1, factor );
+    gate::control_container controls = g.controls();
+    return boost::algorithm::all_of( factor, [&controls]( const variable& v ) { return boost::find( controls, v ) != controls.end(); } );
   }
 
   int calculate_cost_reduction( const circuit& base, unsigned start, unsigned end, const gate::control_container& factor, unsigned helper_line, const cost_function& cf )
@@ -105,7 +68,7 @@ namespace revkit
     /* modify circuit */
     for ( auto& g : tmp )
     {
-      if ( !boost::includes( g.controls(), factor ) ) continue;
+      if ( !has_factor( g, factor ) ) continue;
 
       g.add_control( make_var( helper_line ) );
       for ( const auto& v : factor )
@@ -121,6 +84,206 @@ namespace revkit
     return original_costs - new_costs;
   }
 
+  /*
+   * Finds the best factor of the gate at index.
+   *
+   * Bit b of a factor refers to the b-th control of the gate.  A factor
+   * stays valid until its first line is written or a gate which is not
+   * a Toffoli gate follows, the bound for each control is looked up once.
+   * Factors are extended one control at a time and only as long as
+   * another gate within the bound contains them, since the set of such
+   * gates only shrinks for larger factors.  A factor which only the gate
+   * itself contains is never worth it, it replaces one gate by three.
+   */
+  class factor_search
+  {
+  public:
+    factor_search( const circuit& circ, const gate_dag& dag, const gate_dag& writes, const std::vector<unsigned>& non_toffoli_gates,
+                   unsigned index, unsigned helper_line, const cost_function& cf )
+      : circ( circ ),
+        index( index ),
+        helper_line( helper_line ),
+        cf( cf ),
+        gate_cf( boost::get<costs_by_gate_func>( &cf ) ),
+        single_gate_factors( !is_single_gate_factor_free( cf ) ),
+        controls( circ[index].controls() ),
+        best_cost_reduction( 0 ),
+        best_factor( 0ull ),
+        best_j( 0u )
+    {
+      /* only Toffoli gates */
+      unsigned end = circ.num_gates();
+      auto it = boost::lower_bound( non_toffoli_gates, index );
+      if ( it != non_toffoli_gates.end() )
+      {
+        end = *it;
+      }
+
+      /* controls beyond 63 are not considered */
+      if ( controls.size() > 63u )
+      {
+        controls.erase( controls.begin() + 63u, controls.end() );
+      }
+
+      /* bound of each control and the controls of the current gate in the following gates */
+      std::map<unsigned, unsigned long long> masks;
+      for ( unsigned b = 0u; b < controls.size(); ++b )
+      {
+        unsigned line = controls[b].line();
+        unsigned w = index ? writes.next( index - 1u, line ) : writes.first( line );
+        ends.push_back( std::min( end, w == gate_dag::none ? circ.num_gates() : w ) );
+
+        for ( unsigned i = index; i != gate_dag::none && i < ends[b]; i = dag.next( i, line ) )
+        {
+          gate::control_container cs = circ[i].controls();
+          if ( boost::find( cs, controls[b] ) != cs.end() )
+          {
+            masks[i] |= 1ull << b;
+          }
+        }
+      }
+
+      std::vector<std::pair<unsigned, unsigned long long> > support;
+      for ( const auto& p : masks )
+      {
+        if ( p.first == index || bit_count( p.second ) > 1u )
+        {
+          support.push_back( p );
+        }
+      }
+
+      search( 0ull, 0u, end, support );
+    }
+
+    /* best factor as bits of the controls, 0 if there is none */
+    unsigned long long factor() const
+    {
+      return best_factor;
+    }
+
+    /* upper bound of the best factor */
+    unsigned j() const
+    {
+      return best_j;
+    }
+
+    gate::control_container make_factor( unsigned long long factor ) const
+    {
+      gate::control_container factored;
+      for ( unsigned b = 0u; b < controls.size(); ++b )
+      {
+        if ( ( factor >> b ) & 1ull )
+        {
+          factored.push_back( controls[b] );
+        }
+      }
+      return factored;
+    }
+
+  private:
+    /* factoring a single gate costs at least as much as it saves, e.g., 8 * ( k - 1 ) vs. 2 * 8 * k transistors for k controls */
+    static bool is_single_gate_factor_free( const cost_function& cf )
+    {
+      if ( const costs_by_gate_func* f = boost::get<costs_by_gate_func>( &cf ) )
+      {
+        return f->target<transistor_costs>();
+      }
+
+      const costs_by_circuit_func* f = boost::get<costs_by_circuit_func>( &cf );
+      return f->target<gate_costs>() || f->target<line_costs>();
+    }
+
+    static unsigned bit_count( unsigned long long v )
+    {
+      unsigned c = 0u;
+      for ( ; v; v &= v - 1ull ) ++c;
+      return c;
+    }
+
+    void search( unsigned long long factor, unsigned next_bit, unsigned j, const std::vector<std::pair<unsigned, unsigned long long> >& support )
+    {
+      for ( unsigned b = next_bit; b < controls.size(); ++b )
+      {
+        unsigned long long extended = factor | ( 1ull << b );
+        unsigned extended_j = std::min( j, ends[b] );
+
+        std::vector<std::pair<unsigned, unsigned long long> > extended_support;
+        for ( const auto& p : support )
+        {
+          if ( p.first < extended_j && ( p.second & extended ) == extended )
+          {
+            extended_support.push_back( p );
+          }
+        }
+
+        /* only the current gate is left, which does not pay off for all cost functions */
+        if ( extended_support.size() < 2u && !single_gate_factors ) continue;
+
+        if ( factor )
+        {
+          long long cost_reduction = calculate( extended, extended_j, extended_support );
+          if ( cost_reduction > best_cost_reduction || ( cost_reduction == best_cost_reduction && best_factor && extended < best_factor ) )
+          {
+            best_cost_reduction = cost_reduction;
+            best_factor = extended;
+            best_j = extended_j;
+          }
+        }
+
+        search( extended, b + 1u, extended_j, extended_support );
+      }
+    }
+
+    long long calculate( unsigned long long factor, unsigned j, const std::vector<std::pair<unsigned, unsigned long long> >& support ) const
+    {
+      gate::control_container factored = make_factor( factor );
+
+      if ( !gate_cf )
+      {
+        return calculate_cost_reduction( circ, index, j, factored, helper_line, cf );
+      }
+
+      /* with costs per gate only the changed gates and the helper gates count */
+      long long cost_reduction = 0;
+      for ( const auto& p : support )
+      {
+        gate g = circ[p.first];
+        cost_reduction += ( *gate_cf )( g, circ.lines() );
+
+        g.add_control( make_var( helper_line ) );
+        for ( const auto& v : factored )
+        {
+          g.remove_control( v );
+        }
+        cost_reduction -= ( *gate_cf )( g, circ.lines() );
+      }
+
+      gate helper;
+      for ( const auto& v : factored )
+      {
+        helper.add_control( v );
+      }
+      helper.add_target( helper_line );
+      helper.set_type( toffoli_tag() );
+
+      return cost_reduction - 2 * (long long)( *gate_cf )( helper, circ.lines() );
+    }
+
+    const circuit& circ;
+    unsigned index;
+    unsigned helper_line;
+    const cost_function& cf;
+    const costs_by_gate_func* gate_cf;
+    bool single_gate_factors;
+
+    gate::control_container controls;
+    std::vector<unsigned> ends;
+
+    long long best_cost_reduction;
+    unsigned long long best_factor;
+    unsigned best_j;
+  };
+
   bool adding_lines( circuit& circ, const circuit& base, properties::ptr settings, properties::ptr statistics )
   {
 
@@ -140,10 +303,39 @@ namespace revkit
     // copy circuit
     copy_circuit( base, circ );
 
+    /* gates on each line and positions of the gates which end a factor */
+    gate_dag dag( circ );
+    gate_dag writes( circuit( circ.lines() ) );
+    for ( unsigned i = 0u; i < circ.num_gates(); ++i )
+    {
+      writes.insert( i, target_gate( circ[i] ) );
+    }
+    std::vector<unsigned> non_toffoli_gates;
+    for ( unsigned i = 0u; i < circ.num_gates(); ++i )
+    {
+      if ( !is_toffoli( circ[i] ) )
+      {
+        non_toffoli_gates.push_back( i );
+      }
+    }
+
+    /* keeps the graph and the positions in sync with the circuit */
+    auto insert_helper_gate = [&]( unsigned index, const gate::control_container& factored, unsigned helper_line ) {
+      insert_toffoli( circ, index, factored, helper_line );
+      dag.insert( index, circ[index] );
+      writes.insert( index, target_gate( circ[index] ) );
+      for ( auto& i : non_toffoli_gates )
+      {
+        if ( i >= index ) ++i;
+      }
+    };
+
     for ( unsigned h = 0u; h < additional_lines; ++h )
     {
       /* add one helper line */
       unsigned helper_line = add_line_to_circuit( circ, "helper", "helper", false, true );
+      dag.add_line();
+      writes.add_line();
 
       /* last inserted helper gate (to be removed in the end) */
       unsigned last_helper_gate_index = 0u;
@@ -152,64 +344,41 @@ namespace revkit
       while ( current_index < circ.num_gates() )
       {
         /* best factor */
-        unsigned best_cost_reduction = 0u;
-        unsigned best_factor = 0u;
-        unsigned best_j = 0u;
-
-        /* control lines of the current gate */
-        const gate& current_gate = circ[current_index];
-
-        /* generate each factor */
-        for ( unsigned F : boost::irange( 1u, 1u << current_gate.controls().size() ) )
-        {
-          boost::dynamic_bitset<> factor( current_gate.controls().size(), F );
-          if ( factor.count() <= 1u ) continue; /* only consider factors of size > 1 */
-
-          /* create factor */
-          gate::control_container factored;
-          make_factor( current_gate.controls(), factor, factored );
-
-          /* determine upper bound */
-          unsigned j = find_suitable_gates( circ, current_index, factored );
-
-          /* calculate cost reduction */
-          int cost_reduction = calculate_cost_reduction( circ, current_index, j, factored, helper_line, cf );
-
-          /* better? */
-          if ( cost_reduction > (int)best_cost_reduction )
-          {
-            best_cost_reduction = (unsigned)cost_reduction; /* in this case cost_reduction is greater than 0 */
-            best_factor = F;
-            best_j = j;
-          }
-        }
+        factor_search search( circ, dag, writes, non_toffoli_gates, current_index, helper_line, cf );
+        unsigned best_j = search.j();
 
         /* was a factor found? */
-        if ( best_factor != 0u )
+        if ( search.factor() != 0ull )
         {
-          gate::control_container factored;
-          make_factor( current_gate.controls(), boost::dynamic_bitset<>( current_gate.controls().size(), best_factor), factored );
+          gate::control_container factored = search.make_factor( search.factor() );
 
-          /* apply factor */
-          for ( unsigned i : boost::irange( current_index, best_j ) )
+          /* apply factor, all affected gates are on the first line of the factor */
+          unsigned factor_line = factored.front().line();
+          for ( unsigned i = current_index; i != gate_dag::none && i < best_j; )
           {
-            if ( !boost::includes( circ[i].controls(), factored ) ) continue;
+            unsigned next = dag.next( i, factor_line );
 
-            circ[i].add_control( make_var( helper_line ) );
-            for ( const auto& control : factored )
+            if ( has_factor( circ[i], factored ) )
             {
-              circ[i].remove_control( control );
+              circ[i].add_control( make_var( helper_line ) );
+              for ( const auto& control : factored )
+              {
+                circ[i].remove_control( control );
+              }
+              dag.update( i, circ[i] );
             }
+
+            i = next;
           }
 
           /* toffoli gate at the beginning */
-          insert_toffoli( circ, current_index, factored, helper_line );
+          insert_helper_gate( current_index, factored, helper_line );
 
           /* update best_j, since we inserted a gate before */
           ++best_j;
 
           /* toffoli gate at the end */
-          insert_toffoli( circ, best_j, factored, helper_line );
+          insert_helper_gate( best_j, factored, helper_line );
           last_helper_gate_index = best_j;
 
           /* update again */
@@ -229,6 +398,12 @@ namespace revkit
       if ( last_helper_gate_index != 0u )
       {
         circ.remove_gate_at( last_helper_gate_index );
+        dag.remove( last_helper_gate_index );
+        writes.remove( last_helper_gate_index );
+        for ( auto& i : non_toffoli_gates )
+        {
+          if ( i > last_helper_gate_index ) --i;
+        }
       }
     }
 
@@ -237,7 +412,7 @@ namespace revkit
 
   optimization_func adding_lines_func( properties::ptr settings, properties::ptr statistics )
   {
-    optimization_func f = [&settings, &statistics]( circuit& circ, const circuit& base ) {
+    optimization_func f = [settings, statistics]( circuit& circ, const circuit& base ) {
       return adding_lines( circ, base, settings, statistics );
     };
     f.init( settings, statistics );
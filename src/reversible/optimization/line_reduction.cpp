@@ -17,12 +17,6 @@
 
 #include "line_reduction.hpp"
 
-#include <sys/types.h>
-#include <sys/resource.h>
-#include <sys/wait.h>
-#include <stdio.h>
-#include <unistd.h>
-
 #include <memory>
 
 #include <boost/assign/std/set.hpp>
@@ -34,6 +28,7 @@
 #include <boost/tuple/tuple.hpp>
 
 #include <core/utils/timer.hpp>
+#include <core/utils/worker_pool.hpp>
 
 #include <reversible/circuit.hpp>
 #include <reversible/truth_table.hpp>
@@ -42,90 +37,17 @@
 #include <reversible/functions/expand_circuit.hpp>
 #include <reversible/functions/find_lines.hpp>
 #include <reversible/io/print_circuit.hpp>
-#include <reversible/io/write_realization.hpp>
-#include <reversible/io/read_realization.hpp>
 
 #include <reversible/simulation/partial_simulation.hpp>
 #include <reversible/simulation/simple_simulation.hpp>
 #include <reversible/synthesis/embed_truth_table.hpp>
 #include <reversible/synthesis/transformation_based_synthesis.hpp>
+#include <reversible/utils/gate_dag.hpp>
 
 using namespace boost::assign;
 
 namespace revkit
 {
-#ifndef __WIN32
-  template<typename Func>
-  bool timed_synthesis( circuit& circ, Func& func, binary_truth_table const& spec, unsigned timeout )
-  {
-    if ( timeout == 0u )
-    {
-      return func( circ, spec );
-    }
-
-    char name[] =  "revkit_synthesis_XXXXXXX";
-    int fd = mkstemp( name );
-
-    if ( fd == -1 )
-    {
-      return false;
-    }
-    close( fd );
-
-    pid_t pid = fork ();
-
-    if ( pid == 0 )
-    {
-      struct rlimit r;
-      r.rlim_cur = r.rlim_max = timeout;
-      setrlimit( RLIMIT_CPU, &r );
-
-      bool result = func( circ, spec );
-
-      if ( result )
-      {
-        write_realization( circ, name );
-      }
-
-      _exit( 0 );
-    }
-    else
-    {
-      int status;
-      pid_t w;
-
-      do {
-        w = waitpid( pid, &status, 0 );
-
-        if ( w == -1 )
-        {
-          perror( "waitpid" );
-          exit( EXIT_FAILURE );
-        }
-
-        if ( WIFEXITED( status ) ) {
-        } else if ( WIFSIGNALED( status ) ) {
-        } else if ( WIFSTOPPED( status ) ) {
-        } else if ( WIFCONTINUED( status ) ) {
-        }
-      } while ( !WIFEXITED( status ) && !WIFSIGNALED( status ) );
-
-      circuit newCirc;
-      if ( !read_realization( newCirc, name ) )
-        return false;
-      else
-        copy_circuit( newCirc, circ );
-
-      remove( name );
-
-      return true;
-    }
-
-    assert ( false && "This should never be reached." );
-  }
-#endif
-
-
   struct has_control_at
   {
     explicit has_control_at( unsigned i ) : _i( i ) {}
@@ -139,20 +61,6 @@ namespace revkit
     unsigned _i;
   };
 
-  struct has_control_or_target_at
-  {
-    explicit has_control_or_target_at( unsigned i ) : _i( i ) {}
-
-    bool operator()( const gate& g ) const
-    {
-      return boost::find_if( g.controls(), [this]( const variable& v ) { return v.line() == this->_i; } ) != boost::end( g.controls() )
-        || boost::find( g.targets(), _i ) != boost::end( g.targets() );
-    }
-
-  private:
-    unsigned _i;
-  };
-
   //// embed_and_synthesize ////
 
   embed_and_synthesize::embed_and_synthesize()
@@ -170,11 +78,35 @@ namespace revkit
       return false;
     }
 
-#ifdef __WIN32
-    return synthesis( circ, spec );
-#else
-    return timed_synthesis( circ, synthesis, spec, timeout );
-#endif
+    if ( timeout == 0u )
+    {
+      return synthesis( circ, spec );
+    }
+
+    if ( !workers )
+    {
+      workers.reset( new worker_pool() );
+    }
+
+    /* an abandoned job may still run after returning, hence it owns its data.  The
+       synthesis finds the token in cancellation_token::current(), such that its
+       settings, which are shared with the caller, are not changed. */
+    auto job_synthesis = std::make_shared<truth_table_synthesis_func>( synthesis );
+    auto job_spec = std::make_shared<binary_truth_table>( spec );
+    auto job_circ = std::make_shared<circuit>();
+    auto job_result = std::make_shared<bool>( false );
+
+    bool finished = workers->run( [job_synthesis, job_spec, job_circ, job_result]( const cancellation_token& ) {
+        *job_result = ( *job_synthesis )( *job_circ, *job_spec );
+      }, timeout );
+
+    if ( !finished || !*job_result )
+    {
+      return false;
+    }
+
+    copy_circuit( *job_circ, circ );
+    return true;
   }
 
   /*
@@ -182,22 +114,25 @@ namespace revkit
    * and that each garbage line has at least one control as
    * last line type
    */
-  unsigned find_best_garbage_line( const circuit& circ, const std::vector<unsigned>& lines_to_skip, const std::vector<unsigned>& original_lines, unsigned& last_control_position )
+  unsigned find_best_garbage_line( const circuit& circ, const gate_dag& dag, const std::vector<unsigned>& lines_to_skip, const std::vector<unsigned>& original_lines, unsigned& last_control_position )
   {
     std::map<unsigned, unsigned> garbage_to_last_control;
 
     for ( unsigned i = 0u; i < circ.lines(); ++i ) {
       if ( circ.garbage().at( i ) && std::find( lines_to_skip.begin(), lines_to_skip.end(), original_lines.at( i ) ) == lines_to_skip.end() ) {
-        circuit::const_reverse_iterator itPosition = std::find_if( circ.rbegin(), circ.rend(), has_control_at( i ) );
+        /* walk back along the gates on the line */
+        unsigned position = dag.last( i );
+        while ( position != gate_dag::none && !has_control_at( i )( circ[position] ) )
+        {
+          position = dag.previous( position, i );
+        }
 
         /* unoptimized circuit? */
-        if ( itPosition == circ.rend() )
+        if ( position == gate_dag::none )
         {
           continue;
         }
 
-        unsigned position = circ.rend() - 1 - itPosition;
-
         garbage_to_last_control.insert( std::make_pair( i, position ) );
       }
     }
@@ -215,25 +150,32 @@ namespace revkit
     }
   }
 
-  unsigned num_non_empty_lines( const circuit& circ, unsigned from, unsigned length )
-  {
-    std::set<unsigned> c;
-    find_non_empty_lines( circ.begin() + from, circ.begin() + from + length, std::insert_iterator<std::set<unsigned> >( c, c.begin() ) );
-    return c.size();
-  }
-
   std::pair<circuit, std::vector<unsigned> > find_window_with_max_lines( const circuit& circ, unsigned end, unsigned max_lines )
   {
-    unsigned start = end;
+    /* grow the window to the left while keeping track of its lines */
+    boost::dynamic_bitset<> window_lines( circ.lines() );
+    unsigned num_lines = 0u;
+
+    unsigned start = end + 1u;
+    while ( start > 0 ) {
+      std::vector<unsigned> gate_lines;
+      find_non_empty_lines( circ[start - 1], std::back_inserter( gate_lines ) );
+
+      unsigned added = 0u;
+      for ( unsigned l : gate_lines ) {
+        if ( !window_lines.test( l ) ) ++added;
+      }
+      if ( num_lines + added > max_lines ) {
+        break;
+      }
 
-    while ( num_non_empty_lines( circ, start, end - start + 1 ) <= max_lines && start > 0 ) {
+      for ( unsigned l : gate_lines ) {
+        window_lines.set( l );
+      }
+      num_lines += added;
       --start;
     }
 
-    if ( num_non_empty_lines( circ, start, end - start + 1 ) > max_lines ) {
-      ++start;
-    }
-
     std::vector<unsigned> filter;
     find_non_empty_lines( circ.begin() + start, circ.begin() + end + 1, std::back_inserter( filter ) );
     circuit rcircuit;
@@ -241,7 +183,7 @@ namespace revkit
     return std::make_pair( rcircuit, filter );
   }
 
-  unsigned find_constant_line( const circuit& circ, unsigned window_end )
+  unsigned find_constant_line( const circuit& circ, const gate_dag& dag, unsigned window_end )
   {
     unsigned best_line = circ.lines();
     unsigned min_gate_index = circ.num_gates();
@@ -255,10 +197,10 @@ namespace revkit
         unsigned index = it - circ.constants().begin();
 
         // if line is empty until window_end
-        if ( std::find_if( circ.begin(), circ.begin() + window_end, has_control_or_target_at( index ) ) == circ.begin() + window_end )
+        unsigned gate_index = dag.first( index );
+        if ( gate_index == gate_dag::none || gate_index >= window_end )
         {
-          unsigned gate_index = std::find_if( circ.begin(), circ.end(), has_control_or_target_at( index ) ) - circ.begin();
-          if ( gate_index >= circ.num_gates() ) // this would imply an empty line, optimization
+          if ( gate_index == gate_dag::none ) // this would imply an empty line, optimization
           {
             continue;
           }
@@ -277,7 +219,7 @@ namespace revkit
 
   /* returns a set of the function of the line, which is 0,1 if it is supposed to be the constant line,
      2 if it needs to be used afterwards, or -1 if it is not needed anymore. */
-  void garbage_to_ov( const circuit& circ, const circuit& window, const std::vector<unsigned>& line_mapping,
+  void garbage_to_ov( const circuit& circ, const gate_dag& dag, const circuit& window, const std::vector<unsigned>& line_mapping,
                       unsigned garbage_line, std::vector<short>& ov, bool constant_value )
   {
     for ( unsigned i = 0u; i < window.lines(); ++i )
@@ -294,7 +236,8 @@ namespace revkit
       }
       else
       {
-        if ( std::find_if( circ.begin() + window.offset() + window.num_gates(), circ.end(), has_control_or_target_at( mapped_line ) ) == circ.end() )
+        unsigned last_gate = dag.last( mapped_line );
+        if ( last_gate == gate_dag::none || last_gate < window.offset() + window.num_gates() )
         {
           ov += -1;
         }
@@ -498,10 +441,18 @@ namespace revkit
     std::vector<unsigned> lines_to_skip;
     unsigned max_lines = max_window_lines;
 
+    /* rebuilt only after the circuit changed */
+    std::unique_ptr<gate_dag> dag;
+
     while ( true )
     {
+      if ( !dag )
+      {
+        dag.reset( new gate_dag( circ ) );
+      }
+
       unsigned last_control_position;
-      unsigned garbage_line = find_best_garbage_line( circ, lines_to_skip, original_lines, last_control_position );
+      unsigned garbage_line = find_best_garbage_line( circ, *dag, lines_to_skip, original_lines, last_control_position );
 
       if ( garbage_line == circ.lines() )
       {
@@ -518,7 +469,7 @@ namespace revkit
       boost::tie( window, index_map ) = find_window_with_max_lines( circ, last_control_position, max_lines );
 
       /* find constant line */
-      unsigned constant_line = find_constant_line( circ, window.offset() + window.num_gates() );
+      unsigned constant_line = find_constant_line( circ, *dag, window.offset() + window.num_gates() );
       if ( constant_line == circ.lines() )
       {
         if ( statistics )
@@ -569,9 +520,7 @@ namespace revkit
       else
       {
         std::vector<unsigned> before_filter;
-        find_non_empty_lines( circ.begin(), circ.begin() + window.offset() + window.num_gates(), std::back_inserter( before_filter ) );
-        std::sort( before_filter.begin(), before_filter.end() );
-        before_filter.resize( std::unique( before_filter.begin(), before_filter.end() ) - before_filter.begin() );
+        dag->non_empty_lines( 0u, window.offset() + window.num_gates(), before_filter );
 
         /* determine the number of window variables (no constants) */
         std::vector<constant> before_window_constants;
@@ -642,7 +591,7 @@ namespace revkit
 
       std::vector<short> ov;
       std::vector<unsigned> order;
-      garbage_to_ov( circ, window, index_map, garbage_line, ov, *circ.constants().at( constant_line ) );
+      garbage_to_ov( circ, *dag, window, index_map, garbage_line, ov, *circ.constants().at( constant_line ) );
       ov_to_order_vector( ov, order );
 
       /* create specification */
@@ -693,6 +642,7 @@ namespace revkit
       }
       insert_circuit( circ, window_offset, new_window_expanded );
       remove_line( circ, constant_line, garbage_line );
+      dag.reset();
     }
 
     if ( statistics )
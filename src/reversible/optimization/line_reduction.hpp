@@ -28,6 +28,7 @@
 #define LINE_REDUCTION_HPP
 
 #include <iostream>
+#include <memory>
 
 #include <core/properties.hpp>
 #include <reversible/truth_table.hpp>
@@ -39,6 +40,7 @@ namespace revkit
 {
 
   class circuit;
+  class worker_pool;
 
   /**
    * @brief Functor for re-synthesis in the revkit::line_reduction algorithm
@@ -94,10 +96,29 @@ namespace revkit
      * The time is given in milliseconds. If time is 0u,
      * no timeout is used. The default value is 0u.
      *
+     * With a time-out the synthesis algorithm runs on a worker
+     * thread and finds a \ref revkit::cancellation_token "cancellation_token"
+     * in cancellation_token::current(), which all synthesis
+     * algorithms for truth tables check.  Once the time-out has
+     * passed the result is discarded.  An algorithm which does not
+     * stop within the time-out once more is abandoned as described
+     * in \ref revkit::worker_pool "worker_pool" and may still
+     * update its statistics.
+     *
      * @since  1.1
      */
     unsigned timeout;
 
+    /**
+     * @brief Worker thread for the synthesis with a time-out
+     *
+     * Created on the first call with a time-out and shared
+     * by the copies of this functor.
+     *
+     * @since  2.0
+     */
+    std::shared_ptr<worker_pool> workers;
+
     /**
      * @brief Functor operator implementation
      *
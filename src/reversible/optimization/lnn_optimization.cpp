@@ -26,9 +26,17 @@
 #include <reversible/functions/copy_circuit.hpp>
 #include <reversible/functions/copy_metadata.hpp>
 #include <reversible/functions/add_gates.hpp>
+#include <reversible/functions/expand_circuit.hpp>
 
-#include <stack>
+#include <algorithm>
+#include <chrono>
 #include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <stack>
+#include <thread>
 
 namespace revkit
 {
@@ -41,6 +49,7 @@ namespace revkit
     LNN_OPTIMIZATION_NAIVE,
     LNN_OPTIMIZATION_LOCAL_REORDER,
     LNN_OPTIMIZATION_GLOBAL_REORDER,
+    LNN_OPTIMIZATION_ANNEALING,
   };
 
   /**
@@ -50,65 +59,6 @@ namespace revkit
     return u1 < u2 ? u2-u1-1 : u1-u2-1;
   }
 
-/**
- * @brief Function providing the mapping of a specific new allocated line to its index
- *
- * @param src Source line which should be looked up
- * @param allocation Array representing the lines and their current position
- * @param length Length of the allocation array
- *
- * @return The line index of the source line in the allocation
- *
- */
-  unsigned lookup(unsigned src, unsigned allocation[], unsigned length)
-  {
-    for(unsigned index = 0; index < length; index++)
-      if(allocation[index] == src)
-        return index;
-    return 0;
-  }
-
-/**
- * @brief Function providing the mapping of two specific new allocated lines to their indices
- *
- * @param src1 First source line which should be looked up
- * @param src2 Second source line which should be looked up
- * @param allocation Array representing the lines and their current position
- * @param length Length of the allocation array
- *
- * @return the indices of two source lines in the allocation
- *
- */
-  std::pair<unsigned,unsigned> lookup2(unsigned src1, unsigned src2, unsigned allocation[], unsigned length)
-  {
-    unsigned i1 = 0;
-    unsigned i2 = 0;
-    for(unsigned index = 0; index < length; index++){
-        if(allocation[index] == src1)
-    i1 = index;
-        if(allocation[index] == src2)
-    i2 = index;
-    }
-    return std::make_pair(i1,i2);
-  }
-
-  /**
-   * @brief Function calculating the nearest neighbor cost (nnc) of a gate wrt. a line permutation (allocation)
-   *
-   * @param g Specific gate for which the nnc should be calculated
-   * @param allocation Array representing the lines and their current position
-   * @param len Length of the allocation array
-   *
-   * @return the nnc of the gate
-   */
-  unsigned nnc(const gate& g, unsigned *allocation, unsigned len){
-    if(g.size() == 2 && g.controls().front().line() < len && g.targets().front() < len ){
-      auto ctrltar = lookup2(g.controls().front().line(),g.targets().front(), allocation, len);
-      return nnc_func(ctrltar.first, ctrltar.second);
-    }
-    return 0;
-  }
-
   /**
    * @brief Function calculating the nearest neighbor cost (nnc) of a gate
    *
@@ -222,10 +172,10 @@ namespace revkit
    * @brief Function applies a permutation on a gate permuting its control and target line
    *
    * @param src_gate The gate to transform
-   * @param allocation Array representing the lines and their current position
+   * @param allocation Position of each line
    * @return the transformed gate
    */
-  inline gate transform_gate(const gate src_gate, unsigned* allocation){
+  inline gate transform_gate(const gate& src_gate, const std::vector<unsigned>& allocation){
     gate transformedgate;
     transformedgate.set_type(src_gate.type());
     transformedgate.add_target(allocation[src_gate.targets().front()]);
@@ -235,43 +185,6 @@ namespace revkit
     return transformedgate;
   }
 
-  /**
-   * @brief Function applies a permutation on a gate permuting its control and target line
-   *
-   * @param src_gate The gate to transform
-   * @param allocation Array representing the lines and their current position
-   * @param len the length of the allocation array
-   * @return the transformed gate
-   */
-  inline gate transform_gate2(const gate src_gate, unsigned* allocation, unsigned len){
-    gate transformedgate;
-    transformedgate.set_type(src_gate.type());
-
-    if(src_gate.size() == 1){
-      auto tar = lookup(src_gate.targets().front(), allocation, len);
-      transformedgate.add_target(tar);
-    }else{
-      auto ctrltar = lookup2(src_gate.controls().front().line(),src_gate.targets().front(), allocation, len);
-      transformedgate.add_control(make_var(ctrltar.first));
-      transformedgate.add_target(ctrltar.second);
-    }
-    return transformedgate;
-  }
-
-  /**
-   * @brief Function creates and initiates an allocation array
-   *
-   * @return the allocation array
-   */
-  unsigned* init_allocation(unsigned lines){
-    unsigned *allocation;
-    allocation = new unsigned[lines];
-    for(unsigned i=0; i<lines; ++i)
-      allocation[i] = i;
-    return allocation;
-  }
-
-
 /**
  * @brief After switching lines in other functions and changing the allocation, this function maps the allocation on the output and garbage strings
  *
@@ -332,43 +245,83 @@ namespace revkit
   }
 
   /**
-   * @brief Modifies the allocation by swaping two entries in the allocation table
+   * @brief Lines and their current positions
    *
-   * @param allocation Array representing the lines and their current position
-   * @param l1 first line to swap
-   * @param l2 second line to swap
-   * @param length Length of the allocation array
+   * line_at[p] is the line at position p and position[l] the position of line l.
    */
-  inline void modify_allocation(unsigned* allocation, unsigned l1, unsigned l2, unsigned length ){
-    if(l1 < length && l2 < length){
-      //switch allocation table entries
-      allocation[l2] += allocation[l1];
-      allocation[l1] =  allocation[l2]-allocation[l1];
-      allocation[l2] -= allocation[l1];
+  struct line_allocation
+  {
+    explicit line_allocation(unsigned lines) : line_at(lines), position(lines) {
+      for(unsigned i = 0; i < lines; ++i)
+        line_at[i] = position[i] = i;
+    }
+
+    inline void swap_positions(unsigned p1, unsigned p2){
+      std::swap(line_at[p1], line_at[p2]);
+      position[line_at[p1]] = p1;
+      position[line_at[p2]] = p2;
     }
+
+    std::vector<unsigned> line_at;
+    std::vector<unsigned> position;
+  };
+
+/**
+ * @brief Assigns the gates of base to circ where each line is moved to its position in the allocation
+ *
+ * Inputs, outputs, constant and garbage lines are moved with their lines.
+ *
+ * @param circ Empty target circuit
+ * @param base Source circuit providing metadata and gates
+ * @param allocation Positions of the lines
+ */
+  void apply_allocation(circuit& circ, const circuit& base, const line_allocation& allocation){
+    copy_metadata(base,circ);
+    expand_circuit(base, circ, base.lines(), allocation.position);
+
+    std::vector<std::string> in( base.lines() ), out( base.lines() );
+    std::vector<constant> constants( base.lines() );
+    std::vector<bool> garbage( base.lines() );
+
+    for ( unsigned u = 0; u < base.lines(); u++ ){
+      unsigned l = allocation.line_at[u];
+      in[u] = base.inputs()[l];
+      out[u] = base.outputs()[l];
+      constants[u] = base.constants()[l];
+      garbage[u] = base.garbage()[l];
+    }
+
+    circ.set_inputs(in);
+    circ.set_outputs(out);
+    circ.set_constants(constants);
+    circ.set_garbage(garbage);
   }
 
 /**
  * @brief applies the optimization of the heuristic one-side-swapping lnn_optimization_mode on a circuit wrt. moving the target line towards the control line or the control line towards the target line
  *
- * @param circ Target circuit of the performing action
+ * @param circ Target circuit of the performing action, if 0 only the swaps are counted
  * @param base Source circuit providing metadata and gates
  * @param towardstarget this param is set if the control lines should be moved by swap gates towards the target line
  *
  * @return the number of swaps in the circuit
  */
-  unsigned apply_directed_local_reordering_scheme(circuit& circ, const circuit& base, bool towardstarget){
-    copy_metadata(base,circ);
+  unsigned apply_directed_local_reordering_scheme(circuit* circ, const circuit& base, bool towardstarget){
+    if(circ)
+      copy_metadata(base,*circ);
     unsigned num_swap_gates = 0;
 
-    unsigned* allocation = init_allocation(base.lines());
+    line_allocation allocation(base.lines());
 
     for ( const gate& g : base ){
-      unsigned nnc_val = nnc(g, allocation, base.lines());
-      if(nnc_val>0){
-
-        auto ctrltar = lookup2(g.controls().front().line(),g.targets().front(), allocation, base.lines());
+      unsigned nnc_val = 0;
+      std::pair<unsigned,unsigned> ctrltar;
+      if(g.size() == 2 && !g.controls().empty() && g.controls().front().line() < base.lines() && g.targets().front() < base.lines()){
+        ctrltar = std::make_pair(allocation.position[g.controls().front().line()], allocation.position[g.targets().front()]);
+        nnc_val = nnc_func(ctrltar.first, ctrltar.second);
+      }
 
+      if(nnc_val>0){
         bool direction = towardstarget ?
           (ctrltar.first > ctrltar.second):
           (ctrltar.first < ctrltar.second);
@@ -379,21 +332,19 @@ namespace revkit
             std::make_pair(s - i , s - 1 -i) :
             std::make_pair(s + i , s + 1 +i) ;
 
-          append_swap_gate(circ , swap.first, swap.second);
+          if(circ)
+            append_swap_gate(*circ , swap.first, swap.second);
           num_swap_gates++;
-          modify_allocation(allocation, swap.first, swap.second, base.lines());
+          allocation.swap_positions(swap.first, swap.second);
         }
-
-        circ.append_gate() = transform_gate2(g, allocation, base.lines());
-
       }
-      else
-        circ.append_gate() = transform_gate2(g, allocation, base.lines());
+
+      if(circ)
+        circ->append_gate() = transform_gate(g, allocation.position);
     }
 
-    //clean up
-    permute_outputs_and_garbage_lines(circ, allocation, base.lines());
-    delete allocation;
+    if(circ)
+      permute_outputs_and_garbage_lines(*circ, allocation.line_at.data(), base.lines());
 
     return num_swap_gates;
   }
@@ -401,144 +352,154 @@ namespace revkit
 /**
  * @brief applies the optimization of the heuristic one-side-swapping lnn_optimization_mode on a circuit.
  *
+ * Both directions are evaluated without building a circuit, only the better one is built.
+ *
  * @param circ Target circuit of the performing action
  * @param base Source circuit providing metadata and gates
  *
  * @return the nnc of the circuit
  */
   unsigned apply_local_reordering_scheme(circuit& circ, const circuit& base){
-    circuit c1;
-    circuit c2;
-    copy_metadata(base,c1);
-    copy_metadata(base,c2);
-    unsigned cost1 = apply_directed_local_reordering_scheme(c1, base, true);
-    unsigned cost2 = apply_directed_local_reordering_scheme(c2, base, false);
-    copy_circuit( cost1 < cost2 ? c1 : c2 ,circ);
-    return (cost1 < cost2 ? cost1 : cost2);
+    unsigned cost1 = apply_directed_local_reordering_scheme(0, base, true);
+    unsigned cost2 = apply_directed_local_reordering_scheme(0, base, false);
+    return apply_directed_local_reordering_scheme(&circ, base, cost1 < cost2);
   }
 
-  void switch_lines(circuit& circ, const circuit& base, unsigned l1, unsigned l2 ){
-    for( gate cg : base) {
-      gate g(cg);
-      switch( cg.size() ){
-      case 2:
-        if(cg.controls().front().line() == l1)
-          g = set_gate_control_line(cg,l2);
-        else if (cg.controls().front().line() == l2 )
-          g = set_gate_control_line(cg,l1);
-        //no break - check target line in case 1
-      case 1:
-        if( cg.targets().front() == l1)
-          g = set_gate_control_line(g,l2);
-        else if( cg.targets().front() == l2 )
-          g = set_gate_control_line(g,l1);
-        circ.append_gate() = g;
-        break;
+  /**
+   * @brief Nearest neighbor costs of a circuit under a line allocation
+   *
+   * Keeps the number of gates acting on each pair of lines, such that
+   * the costs do not depend on the circuit after construction and the
+   * change of the costs when two lines are swapped is computed from
+   * the interactions of these two lines only.
+   */
+  class nnc_engine
+  {
+  public:
+    explicit nnc_engine(const circuit& base) : allocation(base.lines()), interactions(base.lines()), cost(0) {
+      std::vector<std::pair<unsigned,unsigned> > pairs;
+      for ( const gate& g : base ){
+        if(g.size() != 2) continue;
+
+        std::vector<unsigned> lines;
+        for(const auto& v : g.controls())
+          lines.push_back(v.line());
+        for(unsigned t : g.targets())
+          lines.push_back(t);
+
+        if(lines[0] != lines[1])
+          pairs.push_back(std::make_pair(std::min(lines[0], lines[1]), std::max(lines[0], lines[1])));
       }
-    }
+      std::sort(pairs.begin(), pairs.end());
 
-    //change circuit metadata: inputs, outputs, constant and garbage lines
-    std::vector<std::string> out = base.outputs();
-    std::string tmp_out;
-    std::vector<std::string> in = base.inputs();
-    std::string tmp_in;
-    std::vector<bool> garbage = base.garbage();
-    bool tmp_garbage;
-    std::vector<constant> constants = base.constants();
-    constant tmp_constants;
+      for(unsigned i = 0; i < pairs.size(); ){
+        unsigned j = i;
+        while(j < pairs.size() && pairs[j] == pairs[i]) ++j;
 
-    tmp_out = out[l1];
-    out[l1] = out[l2];
-    out[l2] = tmp_out;
+        interactions[pairs[i].first].push_back(std::make_pair(pairs[i].second, j - i));
+        interactions[pairs[i].second].push_back(std::make_pair(pairs[i].first, j - i));
+        cost += (unsigned long long)(j - i) * nnc_func(pairs[i].first, pairs[i].second);
+        i = j;
+      }
+    }
 
-    tmp_in = in[l1];
-    in[l1] = in[l2];
-    in[l2] = tmp_in;
+    unsigned long long nnc() const {
+      return cost;
+    }
 
-    tmp_garbage = garbage[l1];
-    garbage[l1] = garbage[l2];
-    garbage[l2] = tmp_garbage;
+    /**
+     * lines interacting with a line and the number of gates on both of them
+     */
+    const std::vector<std::pair<unsigned, unsigned long long> >& neighbors(unsigned line) const {
+      return interactions[line];
+    }
 
-    tmp_constants = constants[l1];
-    constants[l1] = constants[l2];
-    constants[l2] = tmp_constants;
+    /**
+     * change of the costs when the lines at positions p1 and p2 are swapped
+     */
+    long long swap_delta(unsigned p1, unsigned p2) const {
+      long long delta = 0;
+      if(p1 == p2) return delta;
 
-    circ.set_inputs(in);
-    circ.set_constants(constants);
-    circ.set_outputs(out);
-    circ.set_garbage(garbage);
-  }
+      unsigned l1 = allocation.line_at[p1];
+      unsigned l2 = allocation.line_at[p2];
 
-  /**
-   * @brief calculates the impact of the lines. More precisely, for each gate g with
-     control line i and target line j, the NNC value is calculated.
-     This value is added to variables imp_i and imp_j which are used
-     to save the impacts of the circuit lines i and j on the total NNC
-     value, respectively.
-   *
-   * @param circ the circuit for which the impact should be calculated
-   *
-   * @return a vector mapping the impact to a specific line
-   */
-  std::vector< std::pair<unsigned,unsigned> > calculate_impact(const circuit& circ){
-    std::vector< std::pair<unsigned,unsigned> > impact;
-    for(unsigned line_index=0; line_index < circ.lines(); line_index++)
-      impact.push_back(std::make_pair(0,line_index));
+      for(const auto& n : interactions[l1]){
+        if(n.first == l2) continue;
+        long long p = allocation.position[n.first];
+        delta += (long long)n.second * (std::abs(p - (long long)p2) - std::abs(p - (long long)p1));
+      }
+      for(const auto& n : interactions[l2]){
+        if(n.first == l1) continue;
+        long long p = allocation.position[n.first];
+        delta += (long long)n.second * (std::abs(p - (long long)p1) - std::abs(p - (long long)p2));
+      }
+      return delta;
+    }
 
-    //calculate impact
-    for ( const gate& g : circ) {
-      unsigned nnc_val = nnc(g);
-      if(nnc_val>0){
-        impact[g.controls().front().line()].first +=nnc_val;
-        impact[g.targets().front()].first +=nnc_val;
+    void swap_positions(unsigned p1, unsigned p2){
+      cost += swap_delta(p1, p2);
+      allocation.swap_positions(p1, p2);
+    }
+
+    /**
+     * the impact of each position, i.e. the nnc of all gates acting on the line at this position
+     */
+    std::vector< std::pair<unsigned,unsigned> > impact() const {
+      std::vector< std::pair<unsigned,unsigned> > impact;
+      for(unsigned p = 0; p < allocation.line_at.size(); p++){
+        unsigned long long sum = 0;
+        for(const auto& n : interactions[allocation.line_at[p]])
+          sum += n.second * nnc_func(p, allocation.position[n.first]);
+        impact.push_back(std::make_pair(sum, p));
       }
+      return impact;
     }
-    impact.shrink_to_fit();
-    return impact;
-  }
+
+    line_allocation allocation;
+
+  private:
+    /* for each line the lines it interacts with and the number of gates */
+    std::vector<std::vector<std::pair<unsigned, unsigned long long> > > interactions;
+    unsigned long long cost;
+  };
 
   /**
-   * @brief Function switching a line with a middle line
+   * @brief Best swap of a position with a middle line
    *
-   * @param circ Target circuit of the performing action
-   * @param base Source circuit providing metadata and gates
-   * @param
+   * @param engine Current costs
+   * @param proposedline Position to swap
+   * @param middle_line Chosen middle position
    *
-   * return the nnc of the circuit
+   * return the nnc after the swap
    */
-  unsigned switch_lines(circuit& circ, const circuit& base, unsigned proposedline){
-    unsigned middle = base.lines()/2;
-    if(base.lines()%2){
-      switch_lines(circ, base, proposedline, middle);
-      return NNC(circ);
-    }
-    else{
-      //two middle lines
-      circuit circ2;
-      copy_metadata(base,circ2);
-      switch_lines(circ, base, proposedline, middle);
-      switch_lines(circ2, base, proposedline, middle-1);
-      unsigned NNC1 = NNC(circ);
-      unsigned NNC2 = NNC(circ2);
-
-      if(NNC2 < NNC1){
-        circ = circ2;
-        return NNC2;
-      }
+  unsigned long long switch_lines(const nnc_engine& engine, unsigned proposedline, unsigned& middle_line){
+    unsigned lines = engine.allocation.line_at.size();
+    unsigned middle = lines/2;
+    middle_line = middle;
+    unsigned long long NNC1 = engine.nnc() + engine.swap_delta(proposedline, middle);
+    if(lines%2)
       return NNC1;
+
+    //two middle lines
+    unsigned long long NNC2 = engine.nnc() + engine.swap_delta(proposedline, middle-1);
+    if(NNC2 < NNC1){
+      middle_line = middle-1;
+      return NNC2;
     }
+    return NNC1;
   }
 
 /**
  * @brief heuristic method for reordering the lines of a circuit, with the intention moving the line with the highest NNC impact in the middle
  *
- * @param circ Target circuit of the performing action
- * @param base Source circuit providing metadata and gates
+ * @param engine Current costs
+ * @param swap Positions of the best swap
  *
- * @return the nnc of the circuit
+ * @return the nnc after the best swap
  */
-  unsigned global_reorder_circuit(circuit& circ, const circuit& base){
-    auto impact = calculate_impact(base);
+  unsigned long long global_reorder_circuit(const nnc_engine& engine, std::pair<unsigned,unsigned>& swap){
+    auto impact = engine.impact();
     std::sort(impact.begin(), impact.end(), [](std::pair<unsigned,unsigned> a, std::pair<unsigned,unsigned> b){ return a.first > b.first; });
     //multiple lines may have the same highest impact (unspecified in the algorithm)
     std::vector<unsigned> max_lines = [](std::vector<std::pair<unsigned,unsigned>> input){
@@ -550,15 +511,15 @@ namespace revkit
       return out;
     }(impact);
 
-    unsigned best_nnc = UINT_MAX;
+    unsigned lines = impact.size();
+    unsigned long long best_nnc = ULLONG_MAX;
     for(unsigned line : max_lines){
-      if (max_lines.size() < impact.size() && (line == base.lines()/2 || line+1 == base.lines()/2))
+      if (max_lines.size() < impact.size() && (line == lines/2 || line+1 == lines/2))
         line = impact[max_lines.size()].second; //select line with the next highest impact
-      circuit circ2;
-      copy_metadata(base,circ2);
-      unsigned circ_nnc = switch_lines(circ2, base, line);
+      unsigned middle;
+      unsigned long long circ_nnc = switch_lines(engine, line, middle);
       if(circ_nnc < best_nnc){
-        circ = circ2;
+        swap = std::make_pair(line, middle);
         best_nnc = circ_nnc;
       }
     }
@@ -578,6 +539,8 @@ namespace revkit
      middle line). If the selected line is the middle line itself, a
      line with the next highest impact is selected. This procedure is
      repeated until no better NNC value is achieved.
+     The candidate swaps are evaluated on the line interactions, the
+     circuit is built once for the final ordering.
   *
   * @param circ Target circuit of the performing action
   * @param base Source circuit providing metadata and gates
@@ -585,21 +548,175 @@ namespace revkit
   * @return the nnc of the circuit
   */
 unsigned apply_global_reordering_scheme( circuit& circ, const circuit& base) {
-  copy_metadata(base,circ);
-  unsigned circ_nnc = global_reorder_circuit(circ, base);
+  if(!base.lines()){
+    copy_circuit(base,circ);
+    return 0;
+  }
+
+  nnc_engine engine(base);
+  std::pair<unsigned,unsigned> swap;
+  global_reorder_circuit(engine, swap);
+  engine.swap_positions(swap.first, swap.second);
+
   while (true){
-    circuit circ2;
-    copy_metadata(base,circ2);
-    unsigned circ2_nnc = global_reorder_circuit(circ2, circ);
-    if(circ2_nnc < circ_nnc){
-      circ = circ2;
-      circ_nnc = circ2_nnc;
-    }
+    unsigned long long circ2_nnc = global_reorder_circuit(engine, swap);
+    if(circ2_nnc < engine.nnc())
+      engine.swap_positions(swap.first, swap.second);
     else
-      return 2*circ_nnc;
+      break;
   }
+
+  apply_allocation(circ, base, engine.allocation);
+  return 2*engine.nnc();
 }
 
+  /**
+   * @brief Result of one annealing chain
+   */
+  struct annealing_result
+  {
+    explicit annealing_result(unsigned lines) : allocation(lines), nnc(0) {}
+
+    line_allocation allocation;
+    unsigned long long nnc;
+    /* elapsed time and best nnc, whenever the best nnc improved */
+    std::vector<std::pair<double, unsigned long long> > trace;
+  };
+
+  /**
+   * @brief Simulated annealing over line orderings, where a move swaps two neighboring lines
+   *
+   * For each line x, balance[x] is the number of interactions with lines
+   * left of x minus those with lines right of x.  Swapping the neighbors a
+   * and b changes the NNC by balance[a] - balance[b] + 2 w(a,b) and only
+   * the balances of a and b change, hence each move takes constant time.
+   *
+   * @param weights Number of gates on each pair of lines as lines x lines matrix
+   * @param engine Initial ordering and its nnc
+   * @param seed Seed of the random number generator
+   * @param budget Run-time in seconds, only used if max_steps is 0
+   * @param max_steps If not 0, number of moves which are tried, the cooling schedule then only depends on the steps
+   * @param result Best ordering
+   */
+  void anneal_line_ordering(const std::vector<unsigned long long>& weights, const nnc_engine& engine, unsigned seed, double budget,
+                            unsigned long long max_steps, annealing_result& result){
+    typedef std::chrono::steady_clock clock;
+
+    unsigned lines = engine.allocation.line_at.size();
+    line_allocation allocation = engine.allocation;
+    long long nnc = engine.nnc();
+
+    result.allocation = allocation;
+    result.nnc = nnc;
+    if(lines < 2) return;
+
+    std::vector<long long> balance(lines, 0);
+    for(unsigned x = 0; x < lines; ++x)
+      for(unsigned y = 0; y < lines; ++y){
+        long long w = weights[x * lines + y];
+        balance[x] += allocation.position[y] < allocation.position[x] ? w : -w;
+      }
+
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<unsigned> position(0, lines - 2);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    auto delta = [&](unsigned p){
+      unsigned a = allocation.line_at[p], b = allocation.line_at[p + 1];
+      return balance[a] - balance[b] + 2 * (long long)weights[a * lines + b];
+    };
+
+    /* start with the average change of a move as temperature and cool down to 0.1% of it */
+    double start_temperature = 0.0;
+    for(unsigned i = 0; i < 1000; ++i)
+      start_temperature += std::abs(delta(position(gen)));
+    start_temperature = std::max(start_temperature / 1000.0, 1.0);
+    double end_temperature = start_temperature / 1000.0;
+
+    auto start = clock::now();
+    double elapsed = 0.0;
+    double temperature = start_temperature;
+
+    for(unsigned long long step = 0; !max_steps || step < max_steps; ++step){
+      if(!(step & 1023)){
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        double progress = max_steps ? (double)step / max_steps : elapsed / budget;
+        if(progress >= 1.0) break;
+        temperature = start_temperature * std::pow(end_temperature / start_temperature, progress);
+      }
+
+      unsigned p = position(gen);
+      long long d = delta(p);
+      if(d > 0 && unit(gen) >= std::exp(-d / temperature)) continue;
+
+      unsigned a = allocation.line_at[p], b = allocation.line_at[p + 1];
+      long long w = weights[a * lines + b];
+      allocation.swap_positions(p, p + 1);
+      balance[a] += 2 * w;
+      balance[b] -= 2 * w;
+      nnc += d;
+
+      if(nnc < (long long)result.nnc){
+        result.nnc = nnc;
+        result.allocation = allocation;
+        result.trace.push_back(std::make_pair(elapsed, result.nnc));
+      }
+    }
+  }
+
+/**
+ * @brief searches line orderings with independent simulated annealing chains in parallel
+ *
+ * @param circ Target circuit of the performing action
+ * @param base Source circuit providing metadata and gates
+ * @param num_chains Number of chains, each one in its own thread
+ * @param seed Seed of the first chain, chain i uses seed + i
+ * @param budget Run-time of each chain in seconds, only used if max_steps is 0
+ * @param max_steps If not 0, number of moves which are tried in each chain
+ * @param trace Elapsed time and number of SWAP gates whenever the best ordering improved
+ * @param line_ordering Line of base at each position of the best ordering
+ *
+ * @return the number of SWAP gates
+ */
+  unsigned apply_annealing_scheme(circuit& circ, const circuit& base, unsigned num_chains, unsigned seed, double budget, unsigned long long max_steps,
+                                  std::vector<std::pair<double, unsigned> >& trace, std::vector<unsigned>& line_ordering){
+    nnc_engine engine(base);
+    unsigned lines = base.lines();
+
+    std::vector<unsigned long long> weights(lines * lines, 0);
+    for(unsigned x = 0; x < lines; ++x)
+      for(const auto& n : engine.neighbors(x))
+        weights[x * lines + n.first] = n.second;
+
+    num_chains = std::max(num_chains, 1u);
+    std::vector<annealing_result> results(num_chains, annealing_result(lines));
+    std::vector<std::thread> chains;
+    for(unsigned i = 0; i < num_chains; ++i)
+      chains.push_back(std::thread(anneal_line_ordering, std::cref(weights), std::cref(engine), seed + i, budget, max_steps, std::ref(results[i])));
+    for(auto& chain : chains)
+      chain.join();
+
+    unsigned best = 0;
+    std::vector<std::pair<double, unsigned long long> > events;
+    for(unsigned i = 0; i < num_chains; ++i){
+      if(results[i].nnc < results[best].nnc)
+        best = i;
+      events.insert(events.end(), results[i].trace.begin(), results[i].trace.end());
+    }
+
+    /* best number of SWAP gates over all chains in the course of time */
+    std::sort(events.begin(), events.end());
+    trace.clear();
+    trace.push_back(std::make_pair(0.0, (unsigned)(2 * engine.nnc())));
+    for(const auto& e : events)
+      if(2 * e.second < trace.back().second)
+        trace.push_back(std::make_pair(e.first, (unsigned)(2 * e.second)));
+
+    line_ordering = results[best].allocation.line_at;
+    apply_allocation(circ, base, results[best].allocation);
+    return 2 * results[best].nnc;
+  }
+
   /**
    * @brief Applies the linear nearest neighbor optimization to a quantum circuit. Different modes are possible.
       The global and local reordering scheme have been introduced in [\ref SWD10].
@@ -611,8 +728,12 @@ unsigned apply_global_reordering_scheme( circuit& circ, const circuit& base) {
   {
     /* settings */
     bool verbose = get(settings, "verbose", false);
-    /*  1: naive, 2: local reordering, 3: global reordering */
+    /*  1: naive, 2: local reordering, 3: global reordering, 4: simulated annealing */
     unsigned reordering_mode = get<unsigned>(settings, "reordering_mode", 0u);
+    double time_budget = get<double>(settings, "time_budget", 1.0);
+    unsigned num_chains = get<unsigned>(settings, "num_chains", std::max(std::thread::hardware_concurrency(), 1u));
+    unsigned seed = get<unsigned>(settings, "seed", 0u);
+    unsigned long long max_steps = get<unsigned long long>(settings, "max_steps", 0ull);
     
     // Run-time measuring
     timer<properties_timer> t;
@@ -622,7 +743,7 @@ unsigned apply_global_reordering_scheme( circuit& circ, const circuit& base) {
         t.start( rt );
     }
 
-    unsigned number_of_swaps;
+    unsigned number_of_swaps = 0;
     switch(reordering_mode) {
     case LNN_OPTIMIZATION_NONE:
       copy_circuit(base,circ);
@@ -643,6 +764,17 @@ unsigned apply_global_reordering_scheme( circuit& circ, const circuit& base) {
     case LNN_OPTIMIZATION_GLOBAL_REORDER:
       number_of_swaps = apply_global_reordering_scheme(circ, base);
       break;
+    case LNN_OPTIMIZATION_ANNEALING:
+      {
+        std::vector<std::pair<double, unsigned> > trace;
+        std::vector<unsigned> line_ordering;
+        number_of_swaps = apply_annealing_scheme(circ, base, num_chains, seed, time_budget, max_steps, trace, line_ordering);
+        if(statistics){
+          statistics->set("trace", trace);
+          statistics->set("line_ordering", line_ordering);
+        }
+      }
+      break;
 
     default:
       if(verbose)
@@ -650,6 +782,9 @@ unsigned apply_global_reordering_scheme( circuit& circ, const circuit& base) {
       return false;
     }
 
+    if(statistics)
+      statistics->set("number_of_swaps", number_of_swaps);
+
     if(verbose)
       std::cout << "SWAP gates: " << number_of_swaps << std::endl;
     
@@ -658,7 +793,7 @@ unsigned apply_global_reordering_scheme( circuit& circ, const circuit& base) {
 
 optimization_func lnn_optimization_func( properties::ptr settings, properties::ptr statistics )
 {
-    optimization_func f = [&settings, &statistics]( circuit& circ, const circuit& base ) {
+    optimization_func f = [settings, statistics]( circuit& circ, const circuit& base ) {
       return lnn_optimization( circ, base, settings, statistics );
     };
     f.init( settings, statistics );
@@ -41,6 +41,91 @@ namespace revkit
  *
  * Algorith implements a linear nearest neighbor approach
  *
+ * @param circ Optimized circuit to be generated
+ * @param base Original circuit
+ * @param settings <table border="0" width="100%">
+ *   <tr>
+ *     <td class="indexkey">Setting</td>
+ *     <td class="indexkey">Type</td>
+ *     <td class="indexkey">Default Value</td>
+ *   </tr>
+ *   <tr>
+ *     <td rowspan="2" class="indexvalue">reordering_mode</td>
+ *     <td class="indexvalue">unsigned</td>
+ *     <td class="indexvalue">0u</td>
+ *   </tr>
+ *   <tr>
+ *     <td colspan="2" class="indexvalue">0: none, 1: naive, 2: local reordering, 3: global reordering, 4: simulated annealing over line orderings.</td>
+ *   </tr>
+ *   <tr>
+ *     <td rowspan="2" class="indexvalue">time_budget</td>
+ *     <td class="indexvalue">double</td>
+ *     <td class="indexvalue">1.0</td>
+ *   </tr>
+ *   <tr>
+ *     <td colspan="2" class="indexvalue">Run-time of each annealing chain in seconds (mode 4). Since the cooling schedule then depends on the elapsed time, the result is not reproducible.</td>
+ *   </tr>
+ *   <tr>
+ *     <td rowspan="2" class="indexvalue">max_steps</td>
+ *     <td class="indexvalue">unsigned long long</td>
+ *     <td class="indexvalue">0ull</td>
+ *   </tr>
+ *   <tr>
+ *     <td colspan="2" class="indexvalue">If not 0, each annealing chain tries this number of moves and cools down by steps instead of by time, time_budget is ignored.  The result then only depends on seed and num_chains (mode 4).</td>
+ *   </tr>
+ *   <tr>
+ *     <td rowspan="2" class="indexvalue">num_chains</td>
+ *     <td class="indexvalue">unsigned</td>
+ *     <td class="indexvalue">Number of hardware threads</td>
+ *   </tr>
+ *   <tr>
+ *     <td colspan="2" class="indexvalue">Number of independent annealing chains, each one runs in its own thread (mode 4).</td>
+ *   </tr>
+ *   <tr>
+ *     <td rowspan="2" class="indexvalue">seed</td>
+ *     <td class="indexvalue">unsigned</td>
+ *     <td class="indexvalue">0u</td>
+ *   </tr>
+ *   <tr>
+ *     <td colspan="2" class="indexvalue">Seed of the first annealing chain, chain \em i uses seed + \em i (mode 4).</td>
+ *   </tr>
+ *   <tr>
+ *     <td rowspan="2" class="indexvalue">verbose</td>
+ *     <td class="indexvalue">bool</td>
+ *     <td class="indexvalue">false</td>
+ *   </tr>
+ *   <tr>
+ *     <td colspan="2" class="indexvalue">Prints the number of SWAP gates.</td>
+ *   </tr>
+ * </table>
+ * @param statistics <table border="0" width="100%">
+ *   <tr>
+ *     <td class="indexkey">Information</td>
+ *     <td class="indexkey">Type</td>
+ *     <td class="indexkey">Description</td>
+ *   </tr>
+ *   <tr>
+ *     <td class="indexvalue">runtime</td>
+ *     <td class="indexvalue">double</td>
+ *     <td class="indexvalue">Run-time consumed by the algorithm in CPU seconds.</td>
+ *   </tr>
+ *   <tr>
+ *     <td class="indexvalue">number_of_swaps</td>
+ *     <td class="indexvalue">unsigned</td>
+ *     <td class="indexvalue">Number of SWAP gates to make all gates nearest neighbor.</td>
+ *   </tr>
+ *   <tr>
+ *     <td class="indexvalue">trace</td>
+ *     <td class="indexvalue">std::vector<std::pair<double, unsigned> ></td>
+ *     <td class="indexvalue">Elapsed seconds and best number of SWAP gates whenever an annealing chain improved it (mode 4).</td>
+ *   </tr>
+ *   <tr>
+ *     <td class="indexvalue">line_ordering</td>
+ *     <td class="indexvalue">std::vector<unsigned></td>
+ *     <td class="indexvalue">Line of \p base at each line of \p circ in the best ordering (mode 4).</td>
+ *   </tr>
+ * </table>
+ * @return true on success
  */
 bool lnn_optimization( circuit& circ, const circuit& base, properties::ptr settings = properties::ptr(), properties::ptr statistics = properties::ptr() );
 
@@ -0,0 +1,208 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "peephole_optimization.hpp"
+
+#include <algorithm>
+
+#include <core/utils/timer.hpp>
+
+#include <reversible/target_tags.hpp>
+#include <reversible/functions/copy_metadata.hpp>
+
+namespace revkit
+{
+
+  enum peephole_gate_kind { other_gate, toffoli_gate, fredkin_gate };
+
+  struct peephole_entry
+  {
+    explicit peephole_entry( const gate& g )
+      : g( g ),
+        kind( is_toffoli( g ) ? toffoli_gate : is_fredkin( g ) ? fredkin_gate : other_gate ),
+        alive( true )
+    {
+      for ( const auto& v : g.controls() )
+      {
+        controls.push_back( ( v.line() << 1u ) | ( v.polarity() ? 1u : 0u ) );
+        lines.push_back( v.line() );
+      }
+      for ( unsigned t : g.targets() )
+      {
+        targets.push_back( t );
+        lines.push_back( t );
+      }
+
+      std::sort( controls.begin(), controls.end() );
+      std::sort( targets.begin(), targets.end() );
+      std::sort( lines.begin(), lines.end() );
+      lines.erase( std::unique( lines.begin(), lines.end() ), lines.end() );
+    }
+
+    gate g;
+    peephole_gate_kind kind;
+
+    /* controls as line and polarity, sorted by line */
+    std::vector<unsigned> controls;
+    std::vector<unsigned> targets;
+    std::vector<unsigned> lines;
+
+    bool alive;
+  };
+
+  bool peephole_optimization( circuit& circ, const circuit& base, properties::ptr settings, properties::ptr statistics )
+  {
+    /* settings */
+    bool merge = get<bool>( settings, "merge", true );
+
+    /* statistics */
+    unsigned cancellations = 0u;
+    unsigned merges = 0u;
+
+    timer<properties_timer> t;
+
+    if ( statistics )
+    {
+      properties_timer rt( statistics );
+      t.start( rt );
+    }
+
+    std::vector<peephole_entry> entries;
+    entries.reserve( base.num_gates() );
+
+    /* remaining gates on each line, the last one is the neighbor of the next gate */
+    std::vector<std::vector<unsigned> > line_gates( base.lines() );
+
+    for ( const auto& g : base )
+    {
+      peephole_entry e( g );
+
+      while ( true )
+      {
+        /* the neighbor has to be the last gate on all lines and must not have other lines */
+        if ( e.kind == other_gate || e.lines.empty() || line_gates[e.lines.front()].empty() )
+        {
+          break;
+        }
+
+        unsigned neighbor = line_gates[e.lines.front()].back();
+        bool adjacent = entries[neighbor].kind == e.kind && entries[neighbor].lines == e.lines
+          && std::all_of( e.lines.begin(), e.lines.end(), [&]( unsigned l ) { return line_gates[l].back() == neighbor; } );
+
+        if ( !adjacent || entries[neighbor].targets != e.targets )
+        {
+          break;
+        }
+
+        peephole_entry& n = entries[neighbor];
+
+        if ( n.controls == e.controls )
+        {
+          /* self-inverse gates cancel */
+          for ( unsigned l : n.lines )
+          {
+            line_gates[l].pop_back();
+          }
+          n.alive = false;
+          e.alive = false;
+          ++cancellations;
+          break;
+        }
+
+        if ( !merge || e.kind != toffoli_gate )
+        {
+          break;
+        }
+
+        /* controls on the same lines, differing in the polarity of exactly one of them */
+        if ( e.controls.size() != n.controls.size() )
+        {
+          break;
+        }
+
+        unsigned difference = 0u, position = 0u;
+        for ( unsigned i = 0u; i < e.controls.size(); ++i )
+        {
+          if ( e.controls[i] != n.controls[i] )
+          {
+            ++difference;
+            position = i;
+          }
+        }
+
+        if ( difference != 1u )
+        {
+          break;
+        }
+
+        /* the merged gate replaces both and is compared with its new neighbor */
+        for ( unsigned l : n.lines )
+        {
+          line_gates[l].pop_back();
+        }
+        n.alive = false;
+
+        gate merged( e.g );
+        merged.remove_control( make_var( e.controls[position] >> 1u, e.controls[position] & 1u ) );
+        e = peephole_entry( merged );
+        ++merges;
+      }
+
+      if ( e.alive )
+      {
+        for ( unsigned l : e.lines )
+        {
+          line_gates[l].push_back( entries.size() );
+        }
+        entries.push_back( e );
+      }
+    }
+
+    copy_metadata( base, circ );
+    for ( const auto& e : entries )
+    {
+      if ( e.alive )
+      {
+        circ.append_gate() = e.g;
+      }
+    }
+
+    if ( statistics )
+    {
+      statistics->set( "cancellations", cancellations );
+      statistics->set( "merges", merges );
+    }
+
+    return true;
+  }
+
+  optimization_func peephole_optimization_func( properties::ptr settings, properties::ptr statistics )
+  {
+    optimization_func f = [settings, statistics]( circuit& circ, const circuit& base ) {
+      return peephole_optimization( circ, base, settings, statistics );
+    };
+    f.init( settings, statistics );
+    return f;
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
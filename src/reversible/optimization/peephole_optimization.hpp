@@ -0,0 +1,119 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file peephole_optimization.hpp
+ *
+ * @brief Cancellation and merging of neighboring gates
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef PEEPHOLE_OPTIMIZATION_HPP
+#define PEEPHOLE_OPTIMIZATION_HPP
+
+#include <core/properties.hpp>
+
+#include <reversible/circuit.hpp>
+
+#include <reversible/optimization/optimization.hpp>
+
+namespace revkit
+{
+
+  /**
+   * @brief Peephole optimization
+   *
+   * Removes pairs of equal Toffoli or Fredkin gates which are
+   * neighbors when gates on disjoint lines are moved out of the way,
+   * and merges two such neighboring Toffoli gates which only differ in
+   * the polarity of one control into one gate without this control.
+   * A merged gate is compared again with its new neighbor.
+   *
+   * The gates are processed in one pass while the last remaining gate
+   * on each line is tracked, hence the run-time is linear in the
+   * number of gates times their size.  This makes it a cheap
+   * preprocessing step for \ref revkit::window_optimization "window_optimization"
+   * or the results of synthesis algorithms.
+   *
+   * @param circ Optimized circuit to be generated
+   * @param base Original circuit
+   * @param settings <table border="0" width="100%">
+   *   <tr>
+   *     <td class="indexkey">Setting</td>
+   *     <td class="indexkey">Type</td>
+   *     <td class="indexkey">Default Value</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">merge</td>
+   *     <td class="indexvalue">bool</td>
+   *     <td class="indexvalue">true</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">If false, gates are only cancelled but not merged.</td>
+   *   </tr>
+   * </table>
+   * @param statistics <table border="0" width="100%">
+   *   <tr>
+   *     <td class="indexkey">Information</td>
+   *     <td class="indexkey">Type</td>
+   *     <td class="indexkey">Description</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">runtime</td>
+   *     <td class="indexvalue">double</td>
+   *     <td class="indexvalue">Run-time consumed by the algorithm in CPU seconds.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">cancellations</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of removed pairs of gates.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">merges</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">Number of pairs of gates which were merged into one gate.</td>
+   *   </tr>
+   * </table>
+   * @return true on success
+   *
+   * @since  2.0
+   */
+  bool peephole_optimization( circuit& circ, const circuit& base, properties::ptr settings = properties::ptr(), properties::ptr statistics = properties::ptr() );
+
+  /**
+   * @brief Functor for the \ref revkit::peephole_optimization "peephole_optimization" algorithm
+   *
+   * @param settings Settings (see \ref revkit::peephole_optimization "peephole_optimization")
+   * @param statistics Statistics (see \ref revkit::peephole_optimization "peephole_optimization")
+   *
+   * @return A functor which complies with the \ref revkit::optimization_func "optimization_func" interface
+   *
+   * @since  2.0
+   */
+  optimization_func peephole_optimization_func( properties::ptr settings = properties::ptr( new properties() ), properties::ptr statistics = properties::ptr( new properties() ) );
+
+}
+
+#endif /* PEEPHOLE_OPTIMIZATION_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,356 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resynthesis_cache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+
+#include <boost/format.hpp>
+
+#include <reversible/target_tags.hpp>
+#include <reversible/functions/expand_circuit.hpp>
+
+namespace revkit
+{
+
+  /* number of lines of a permutation with 2^n entries, or 0 if it is not a function on n lines */
+  unsigned permutation_lines( const std::vector<unsigned>& perm )
+  {
+    unsigned n = 0u;
+    while ( ( 1u << n ) < perm.size() ) ++n;
+
+    if ( perm.size() < 2u || ( 1u << n ) != perm.size() || *std::max_element( perm.begin(), perm.end() ) >= perm.size() )
+    {
+      return 0u;
+    }
+    return n;
+  }
+
+  /* smallest permutation under relabeling of the lines, relabeling maps line i to line lines[i] */
+  void normalize_permutation( const std::vector<unsigned>& perm, unsigned n, std::vector<unsigned>& key, std::vector<unsigned>& lines )
+  {
+    std::vector<unsigned> p( n ), image( perm.size() ), g( perm.size() );
+    std::iota( p.begin(), p.end(), 0u );
+
+    do
+    {
+      for ( unsigned x = 0u; x < perm.size(); ++x )
+      {
+        image[x] = 0u;
+        for ( unsigned i = 0u; i < n; ++i )
+        {
+          if ( ( x >> i ) & 1u ) image[x] |= 1u << p[i];
+        }
+      }
+
+      for ( unsigned x = 0u; x < perm.size(); ++x )
+      {
+        g[image[x]] = image[perm[x]];
+      }
+
+      if ( key.empty() || g < key )
+      {
+        key = g;
+        lines = p;
+      }
+    } while ( std::next_permutation( p.begin(), p.end() ) );
+  }
+
+  class resynthesis_cache::priv
+  {
+  public:
+    priv( unsigned max_lines, const cost_function& cf )
+      : max_lines( max_lines ),
+        cf( cf ),
+        hits( 0ull ),
+        misses( 0ull ) {}
+
+    struct entry
+    {
+      circuit circ;
+      cost_t cost;
+    };
+
+    unsigned max_lines;
+    cost_function cf;
+
+    mutable std::mutex mutex;
+    std::map<std::vector<unsigned>, entry> entries;
+    unsigned long long hits;
+    unsigned long long misses;
+  };
+
+  resynthesis_cache::resynthesis_cache( unsigned max_lines, const cost_function& cf )
+    : d( new priv( max_lines, cf ) )
+  {
+  }
+
+  resynthesis_cache::~resynthesis_cache()
+  {
+    delete d;
+  }
+
+  unsigned resynthesis_cache::max_lines() const
+  {
+    return d->max_lines;
+  }
+
+  bool resynthesis_cache::lookup( const std::vector<unsigned>& perm, circuit& circ )
+  {
+    unsigned n = permutation_lines( perm );
+    if ( !n || n > d->max_lines )
+    {
+      return false;
+    }
+
+    std::vector<unsigned> key, lines;
+    normalize_permutation( perm, n, key, lines );
+
+    circuit canonical;
+    {
+      std::lock_guard<std::mutex> lock( d->mutex );
+
+      auto it = d->entries.find( key );
+      if ( it == d->entries.end() )
+      {
+        ++d->misses;
+        return false;
+      }
+
+      ++d->hits;
+      canonical = it->second.circ;
+    }
+
+    /* relabel with the inverse */
+    std::vector<unsigned> inverse( n );
+    for ( unsigned i = 0u; i < n; ++i )
+    {
+      inverse[lines[i]] = i;
+    }
+    expand_circuit( canonical, circ, n, inverse );
+
+    return true;
+  }
+
+  void resynthesis_cache::insert( const std::vector<unsigned>& perm, const circuit& circ )
+  {
+    unsigned n = permutation_lines( perm );
+    if ( !n || n > d->max_lines || circ.lines() != n )
+    {
+      return;
+    }
+
+    std::vector<unsigned> key, lines;
+    normalize_permutation( perm, n, key, lines );
+
+    priv::entry e;
+    expand_circuit( circ, e.circ, n, lines );
+    e.cost = costs( e.circ, d->cf );
+
+    std::lock_guard<std::mutex> lock( d->mutex );
+
+    auto it = d->entries.find( key );
+    if ( it == d->entries.end() )
+    {
+      d->entries.insert( std::make_pair( key, e ) );
+    }
+    else if ( e.cost < it->second.cost )
+    {
+      it->second = e;
+    }
+  }
+
+  bool resynthesis_cache::read( const std::string& filename, std::string* error )
+  {
+    std::ifstream is( filename.c_str() );
+    if ( !is.good() )
+    {
+      if ( error )
+      {
+        *error = boost::str( boost::format( "Cannot open %s" ) % filename );
+      }
+      return false;
+    }
+
+    std::string line;
+    for ( unsigned line_number = 1u; std::getline( is, line ); ++line_number )
+    {
+      if ( line.empty() || line[0] == '#' ) continue;
+
+      std::replace( line.begin(), line.end(), ';', '\n' );
+      std::istringstream entry( line );
+
+      /* permutation */
+      std::string part;
+      std::getline( entry, part );
+      std::istringstream header( part );
+
+      unsigned n = 0u;
+      header >> n;
+
+      std::vector<unsigned> perm;
+      unsigned value;
+      while ( header >> value )
+      {
+        perm.push_back( value );
+      }
+
+      bool ok = n && n < 32u && perm.size() == ( 1u << n );
+
+      /* gates */
+      circuit circ( n );
+      while ( ok && std::getline( entry, part ) )
+      {
+        std::istringstream gate_stream( part );
+        std::string type;
+        gate_stream >> type;
+
+        std::vector<std::string> operands;
+        std::string operand;
+        while ( gate_stream >> operand )
+        {
+          operands.push_back( operand );
+        }
+
+        unsigned num_targets = type == "t" ? 1u : 2u;
+        if ( ( type != "t" && type != "f" && type != "p" ) || operands.size() < num_targets )
+        {
+          ok = false;
+          break;
+        }
+
+        gate& g = circ.append_gate();
+        for ( unsigned i = 0u; i < operands.size(); ++i )
+        {
+          bool polarity = operands[i][0] != '-';
+          std::istringstream line_stream( operands[i].substr( polarity ? 0u : 1u ) );
+          unsigned l = n;
+          line_stream >> l;
+          if ( line_stream.fail() || l >= n )
+          {
+            ok = false;
+            break;
+          }
+
+          if ( i + num_targets < operands.size() )
+          {
+            g.add_control( make_var( l, polarity ) );
+          }
+          else
+          {
+            g.add_target( l );
+          }
+        }
+        g.set_type( type == "t" ? boost::any( toffoli_tag() ) : type == "f" ? boost::any( fredkin_tag() ) : boost::any( peres_tag() ) );
+      }
+
+      if ( !ok )
+      {
+        if ( error )
+        {
+          *error = boost::str( boost::format( "Invalid entry in %s:%d" ) % filename % line_number );
+        }
+        return false;
+      }
+
+      if ( n <= d->max_lines )
+      {
+        insert( perm, circ );
+      }
+    }
+
+    return true;
+  }
+
+  bool resynthesis_cache::write( const std::string& filename, std::string* error ) const
+  {
+    std::ofstream os( filename.c_str() );
+    if ( !os.good() )
+    {
+      if ( error )
+      {
+        *error = boost::str( boost::format( "Cannot open %s" ) % filename );
+      }
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock( d->mutex );
+
+    os << "# lines permutation ; gates" << std::endl;
+    for ( const auto& p : d->entries )
+    {
+      const circuit& circ = p.second.circ;
+
+      if ( std::find_if( circ.begin(), circ.end(), []( const gate& g ) { return !is_toffoli( g ) && !is_fredkin( g ) && !is_peres( g ); } ) != circ.end() )
+      {
+        continue;
+      }
+
+      os << circ.lines();
+      for ( unsigned v : p.first )
+      {
+        os << " " << v;
+      }
+
+      for ( const auto& g : circ )
+      {
+        os << " ; " << ( is_toffoli( g ) ? "t" : is_fredkin( g ) ? "f" : "p" );
+        for ( const auto& v : g.controls() )
+        {
+          os << " " << ( v.polarity() ? "" : "-" ) << v.line();
+        }
+        for ( unsigned t : g.targets() )
+        {
+          os << " " << t;
+        }
+      }
+      os << std::endl;
+    }
+
+    return true;
+  }
+
+  unsigned resynthesis_cache::size() const
+  {
+    std::lock_guard<std::mutex> lock( d->mutex );
+    return d->entries.size();
+  }
+
+  unsigned long long resynthesis_cache::hits() const
+  {
+    std::lock_guard<std::mutex> lock( d->mutex );
+    return d->hits;
+  }
+
+  unsigned long long resynthesis_cache::misses() const
+  {
+    std::lock_guard<std::mutex> lock( d->mutex );
+    return d->misses;
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,196 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file resynthesis_cache.hpp
+ *
+ * @brief Cache of synthesized circuits for small permutations
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef RESYNTHESIS_CACHE_HPP
+#define RESYNTHESIS_CACHE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <reversible/circuit.hpp>
+#include <reversible/utils/costs.hpp>
+
+namespace revkit
+{
+
+  /**
+   * @brief Cache of synthesized circuits for small permutations
+   *
+   * Maps reversible functions on few lines to the cheapest circuit
+   * known for them.  A function is given as a permutation
+   * \em f over \f$\{0,\dots,2^n-1\}\f$ where bit \em i of a value
+   * corresponds to line \em i.  Functions which only differ in the
+   * order of their lines share one entry: the key is the lexicographically
+   * smallest permutation that is obtained by relabeling the lines, and
+   * circuits are relabeled accordingly when they are stored or returned.
+   *
+   * All methods are thread-safe such that one cache can be shared by
+   * the worker threads of \ref revkit::window_optimization "window_optimization".
+   *
+   * @section sec_example_resynthesis_cache Example
+   * @code
+   * revkit::resynthesis_optimization ro;
+   * ro.cache.reset( new revkit::resynthesis_cache() );
+   * ro.cache->read( "cache.txt" );
+   *
+   * revkit::properties::ptr settings( new revkit::properties() );
+   * settings->set( "optimization", revkit::optimization_func( ro ) );
+   * revkit::window_optimization( circ, base, settings );
+   *
+   * ro.cache->write( "cache.txt" );
+   * @endcode
+   *
+   * @since  2.0
+   */
+  class resynthesis_cache
+  {
+  public:
+    /**
+     * @brief Smart pointer of a cache
+     *
+     * @since  2.0
+     */
+    typedef std::shared_ptr<resynthesis_cache> ptr;
+
+    /**
+     * @brief Creates an empty cache
+     *
+     * @param max_lines Functions on more lines are not cached, since
+     *                  normalization tries all \em n! relabelings
+     * @param cf Cost function to decide which circuit is kept
+     *
+     * @since  2.0
+     */
+    explicit resynthesis_cache( unsigned max_lines = 4u, const cost_function& cf = costs_by_circuit_func( gate_costs() ) );
+
+    /**
+     * @brief Deletes the cache
+     *
+     * @since  2.0
+     */
+    ~resynthesis_cache();
+
+    /**
+     * @brief Maximal number of lines of cached functions
+     *
+     * @since  2.0
+     */
+    unsigned max_lines() const;
+
+    /**
+     * @brief Looks up a circuit for a function
+     *
+     * @param perm Permutation with \f$2^n\f$ entries, \f$n \le\f$ max_lines()
+     * @param circ Empty circuit, which is filled with the cached circuit on a hit
+     *
+     * @return true, if the function is in the cache
+     *
+     * @since  2.0
+     */
+    bool lookup( const std::vector<unsigned>& perm, circuit& circ );
+
+    /**
+     * @brief Stores a circuit for a function
+     *
+     * If there is already an entry for the function, it is
+     * replaced only if \p circ is cheaper.
+     *
+     * @param perm Permutation with \f$2^n\f$ entries, \f$n \le\f$ max_lines()
+     * @param circ Circuit realizing \p perm on \em n lines
+     *
+     * @since  2.0
+     */
+    void insert( const std::vector<unsigned>& perm, const circuit& circ );
+
+    /**
+     * @brief Adds the entries of a cache file
+     *
+     * Entries for functions with more than max_lines() lines are skipped.
+     *
+     * @param filename File written by write()
+     * @param error If not 0, an error message is assigned in case of failure
+     *
+     * @return true on success
+     *
+     * @since  2.0
+     */
+    bool read( const std::string& filename, std::string* error = 0 );
+
+    /**
+     * @brief Writes all entries to a file
+     *
+     * Each entry is one line with the number of lines, the permutation
+     * and the gates of the circuit.  Entries with gates other than
+     * Toffoli, Fredkin, and Peres gates are skipped.
+     *
+     * @param filename Name of the cache file
+     * @param error If not 0, an error message is assigned in case of failure
+     *
+     * @return true on success
+     *
+     * @since  2.0
+     */
+    bool write( const std::string& filename, std::string* error = 0 ) const;
+
+    /**
+     * @brief Number of entries
+     *
+     * @since  2.0
+     */
+    unsigned size() const;
+
+    /**
+     * @brief Number of successful lookups
+     *
+     * @since  2.0
+     */
+    unsigned long long hits() const;
+
+    /**
+     * @brief Number of failed lookups
+     *
+     * @since  2.0
+     */
+    unsigned long long misses() const;
+
+  private:
+    resynthesis_cache( const resynthesis_cache& ) = delete;
+    resynthesis_cache& operator=( const resynthesis_cache& ) = delete;
+
+    class priv;
+    priv* const d;
+  };
+
+}
+
+#endif /* RESYNTHESIS_CACHE_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -17,13 +17,19 @@
 
 #include "window_optimization.hpp"
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include <boost/dynamic_bitset.hpp>
+
 #include <core/utils/timer.hpp>
 
 #include <reversible/functions/add_circuit.hpp>
 #include <reversible/functions/circuit_to_truth_table.hpp>
 #include <reversible/functions/copy_circuit.hpp>
+#include <reversible/functions/copy_metadata.hpp>
 #include <reversible/functions/expand_circuit.hpp>
-#include <reversible/functions/find_lines.hpp>
 #include <reversible/io/print_circuit.hpp>
 #include <reversible/simulation/simple_simulation.hpp>
 #include <reversible/synthesis/transformation_based_synthesis.hpp>
@@ -31,10 +37,65 @@
 namespace revkit
 {
 
+  /* finds the next window starting at pos with at most line_count non-empty lines */
+  bool next_line_window( const circuit& base, unsigned& pos, unsigned line_count, boost::dynamic_bitset<>& mask, window_range& window )
+  {
+    unsigned start_pos = pos;
+    unsigned count = 0u;
+    mask.resize( base.lines() );
+    mask.reset();
+
+    for ( circuit::const_iterator it = base.begin() + pos; it != base.end(); ++it, ++pos )
+    {
+      unsigned added = 0u;
+      for ( const auto& v : it->controls() )
+      {
+        if ( !mask.test( v.line() ) ) ++added;
+      }
+      for ( unsigned t : it->targets() )
+      {
+        if ( !mask.test( t ) ) ++added;
+      }
+
+      if ( count + added <= line_count )
+      {
+        /* keep on trying */
+        for ( const auto& v : it->controls() ) { mask.set( v.line() ); }
+        for ( unsigned t : it->targets() ) { mask.set( t ); }
+        count += added;
+      }
+      else if ( count )
+      {
+        /* we have a circuit for now */
+        break;
+      }
+      else
+      {
+        /* new start pos */
+        start_pos = pos + 1u;
+      }
+    }
+
+    if ( !count )
+    {
+      return false;
+    }
+
+    window.from = start_pos;
+    window.to = pos;
+    window.filter.clear();
+    for ( boost::dynamic_bitset<>::size_type l = mask.find_first(); l != boost::dynamic_bitset<>::npos; l = mask.find_next( l ) )
+    {
+      window.filter.push_back( l );
+    }
+    return true;
+  }
+
   shift_window_selection::shift_window_selection()
     : window_length( 10u ),
       offset( 1u ),
-      pos( 0u )
+      pos( 0u ),
+      phase( 0u )
   {
   }
 
@@ -44,7 +105,7 @@ namespace revkit
     {
       /* dont forget to reset in case of second call */
       pos = 0u;
-      return circuit();
+      return circuit_filter_pair();
     }
 
     unsigned length = std::min( window_length, base.num_gates() - pos );
@@ -56,6 +117,30 @@ namespace revkit
     return circuit_filter_pair( s, std::vector<unsigned>() );
   }
 
+  bool shift_window_selection::operator()( const circuit& base, std::vector<window_range>& windows )
+  {
+    unsigned step = std::max( offset, 1u );
+    unsigned stride = ( std::max( window_length, 1u ) + step - 1u ) / step * step;
+
+    windows.clear();
+    if ( phase * step >= stride || phase * step >= base.num_gates() )
+    {
+      phase = 0u;
+      return false;
+    }
+
+    for ( unsigned from = phase * step; from < base.num_gates(); from += stride )
+    {
+      window_range window;
+      window.from = from;
+      window.to = from + std::min( window_length, base.num_gates() - from );
+      windows.push_back( window );
+    }
+
+    ++phase;
+    return true;
+  }
+
   line_window_selection::line_window_selection()
     : num_lines( 0u ),
       line_count( 2u ),
@@ -85,64 +170,46 @@ namespace revkit
         else
         {
           line_count = 2u;
-          return circuit();
+          return circuit_filter_pair();
         }
       }
 
-      unsigned start_pos = pos;
-      std::set<unsigned> non_empty_lines;
-
-      for ( unsigned i = pos; i < base.num_gates(); ++i )
+      boost::dynamic_bitset<> mask;
+      window_range window;
+      if ( next_line_window( base, pos, line_count, mask, window ) )
       {
-        std::set<unsigned> new_non_empty_lines;
-
-        /* copy controls and targets */
-        const gate& g = *( base.begin() + i );
-        find_non_empty_lines( g, std::insert_iterator<std::set<unsigned> >( new_non_empty_lines, new_non_empty_lines.begin() ) );
-        std::copy( non_empty_lines.begin(), non_empty_lines.end(), std::insert_iterator<std::set<unsigned> >( new_non_empty_lines, new_non_empty_lines.begin() ) );
-
-        if ( new_non_empty_lines.size() <= line_count )
-        {
-          /* keep on trying */
-          non_empty_lines.clear();
-          std::copy( new_non_empty_lines.begin(), new_non_empty_lines.end(), std::insert_iterator<std::set<unsigned> >( non_empty_lines, non_empty_lines.begin() ) );
-        }
-        else
-        {
-          /* do we have a circuit for now? */
-          if ( non_empty_lines.size() )
-          {
-            pos = i;
-            std::vector<unsigned> filter( non_empty_lines.begin(), non_empty_lines.end() );
-
-            circuit ret_circuit;
-            copy_circuit( subcircuit( base, start_pos, pos ), ret_circuit, filter );
-            return circuit_filter_pair( ret_circuit, filter );
-          }
-          else
-          {
-            /* new start pos */
-            start_pos = i + 1;
-          }
-        }
+        circuit ret_circuit;
+        copy_circuit( subcircuit( base, window.from, window.to ), ret_circuit, window.filter );
+        return circuit_filter_pair( ret_circuit, window.filter );
       }
+    }
+  }
 
-      /* still here? */
-      pos = base.num_gates();
+  bool line_window_selection::operator()( const circuit& base, std::vector<window_range>& windows )
+  {
+    /* set number of lines */
+    if ( !num_lines )
+    {
+      num_lines = base.lines();
+    }
 
-      /* do we have a circuit? */
-      if ( non_empty_lines.size() )
-      {
-        std::vector<unsigned> filter( non_empty_lines.begin(), non_empty_lines.end() );
-        circuit ret_circuit;
-        copy_circuit( subcircuit( base, start_pos, base.num_gates() ), ret_circuit, filter );
-        return circuit_filter_pair( ret_circuit, filter );
-      }
-      else
-      {
-        /* next iteration */
-      }
+    windows.clear();
+    if ( line_count > std::max( num_lines, 3u ) - 1u )
+    {
+      line_count = 2u;
+      return false;
+    }
+
+    boost::dynamic_bitset<> mask;
+    window_range window;
+    for ( pos = 0u; next_line_window( base, pos, line_count, mask, window ); )
+    {
+      windows.push_back( window );
     }
+
+    pos = 0u;
+    ++line_count;
+    return true;
   }
 
   resynthesis_optimization::resynthesis_optimization()
@@ -151,29 +218,157 @@ namespace revkit
   {
   }
 
+  /* simulates the window for all inputs, returns false if the result is not a function on its lines */
+  bool window_permutation( const circuit& window, const simulation_func& simulation, std::vector<unsigned>& perm )
+  {
+    if ( simulation.settings() && simulation.settings()->get<bool>( "partial", false ) )
+    {
+      return false;
+    }
+
+    perm.resize( 1u << window.lines() );
+    for ( unsigned x = 0u; x < perm.size(); ++x )
+    {
+      boost::dynamic_bitset<> input( window.lines(), x ), output;
+      if ( !simulation( output, window, input ) || output.size() != window.lines() )
+      {
+        return false;
+      }
+      perm[x] = output.to_ulong();
+    }
+
+    return true;
+  }
+
   bool resynthesis_optimization::operator()( circuit& new_window, const circuit& old_window ) const
   {
+    std::vector<unsigned> perm;
+    bool cached = cache && old_window.lines() && old_window.lines() <= cache->max_lines() && window_permutation( old_window, simulation, perm );
+
+    if ( cached && cache->lookup( perm, new_window ) )
+    {
+      return true;
+    }
+
     binary_truth_table spec;
     circuit_to_truth_table( old_window, spec, simulation );
-    return synthesis( new_window, spec );
+    if ( !synthesis( new_window, spec ) )
+    {
+      return false;
+    }
+
+    if ( cached )
+    {
+      cache->insert( perm, new_window );
+    }
+    return true;
   }
 
-  bool window_optimization( circuit& circ, const circuit& base, properties::ptr settings, properties::ptr statistics )
+  /* optimizes a batch of disjoint windows concurrently and commits the cheaper ones in gate order */
+  bool optimize_window_batch( circuit& circ, const std::vector<window_range>& windows, const optimization_factory& make_optimization, incremental_costs& tracker, unsigned num_threads )
   {
-    select_window_func select_window = get<select_window_func>( settings, "select_window", shift_window_selection() );
-    optimization_func  optimization  = get<optimization_func>( settings, "optimization", resynthesis_optimization() );
-    cost_function cf = get<cost_function>( settings, "cost_function", costs_by_circuit_func( gate_costs() ) );
+    std::vector<circuit> replacements( windows.size() );
+    std::vector<char> cheaper( windows.size(), 0 );
+    std::atomic<unsigned> next( 0u );
 
-    timer<properties_timer> t;
+    unsigned num_workers = std::max( std::min<unsigned>( num_threads, windows.size() ), 1u );
+    std::vector<std::exception_ptr> errors( num_workers );
 
-    if ( statistics )
+    auto worker = [&]( unsigned id ) {
+      try
+      {
+        optimization_func local_optimization = make_optimization();
+
+        for ( unsigned i = next++; i < windows.size(); i = next++ )
+        {
+          const window_range& w = windows[i];
+
+          circuit s;
+          if ( w.filter.empty() )
+          {
+            copy_circuit( subcircuit( circ, w.from, w.to ), s );
+          }
+          else
+          {
+            copy_circuit( subcircuit( circ, w.from, w.to ), s, w.filter );
+          }
+
+          circuit new_window;
+          if ( local_optimization( new_window, s ) && tracker.evaluate( new_window ) < tracker.evaluate( s ) )
+          {
+            expand_circuit( new_window, replacements[i], circ.lines(), w.filter );
+            cheaper[i] = 1;
+          }
+        }
+      }
+      catch ( ... )
+      {
+        /* stop the other workers, the exception is rethrown after they are joined */
+        errors[id] = std::current_exception();
+        next = windows.size();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for ( unsigned i = 1u; i < num_workers; ++i )
     {
-      properties_timer rt( statistics );
-      t.start( rt );
+      workers.push_back( std::thread( worker, i ) );
+    }
+    worker( 0u );
+    for ( auto& t : workers )
+    {
+      t.join();
     }
 
-    copy_circuit( base, circ );
+    for ( const auto& e : errors )
+    {
+      if ( e )
+      {
+        std::rethrow_exception( e );
+      }
+    }
+
+    if ( std::find( cheaper.begin(), cheaper.end(), 1 ) == cheaper.end() )
+    {
+      return false;
+    }
+
+    /* rebuild the circuit once instead of removing and inserting gates for each window */
+    circuit result;
+    copy_metadata( circ, result );
+
+    unsigned pos = 0u;
+    for ( unsigned i = 0u; i <= windows.size(); ++i )
+    {
+      unsigned to = i < windows.size() ? windows[i].from : circ.num_gates();
+      for ( circuit::const_iterator it = circ.begin() + pos; pos < to; ++it, ++pos )
+      {
+        result.append_gate() = *it;
+      }
+
+      if ( i < windows.size() && cheaper[i] )
+      {
+        append_circuit( result, replacements[i] );
+        pos = windows[i].to;
+      }
+    }
+
+    circ = result;
+
+    /* from the back such that the positions of the other windows stay valid */
+    for ( unsigned i = windows.size(); i-- > 0u; )
+    {
+      if ( cheaper[i] )
+      {
+        tracker.replace( windows[i].from, windows[i].to, replacements[i] );
+      }
+    }
 
+    return true;
+  }
+
+  void sequential_window_optimization( circuit& circ, select_window_func& select_window, const optimization_func& optimization, incremental_costs& tracker )
+  {
     while ( true )
     {
       /* select the window */
@@ -192,7 +387,7 @@ namespace revkit
       bool ok = optimization( new_window, s );
 
       /* check if it is cheaper */
-      bool cheaper = ok && costs( new_window, cf ) < costs( s, cf );
+      bool cheaper = ok && tracker.evaluate( new_window ) < tracker.evaluate( s );
 
       if ( cheaper )
       {
@@ -207,15 +402,94 @@ namespace revkit
         circuit window_expanded;
         expand_circuit( new_window, window_expanded, circ.lines(), filter );
         insert_circuit( circ, s_from, window_expanded );
+        tracker.replace( s_from, s_from + s_size, window_expanded );
       }
     }
+  }
+
+  template<typename Selection>
+  void parallel_window_optimization( circuit& circ, Selection& select_window, const optimization_factory& make_optimization, incremental_costs& tracker, unsigned num_threads )
+  {
+    std::vector<window_range> windows;
+    while ( select_window( circ, windows ) )
+    {
+      optimize_window_batch( circ, windows, make_optimization, tracker, num_threads );
+    }
+  }
+
+  bool window_optimization( circuit& circ, const circuit& base, properties::ptr settings, properties::ptr statistics )
+  {
+    select_window_func select_window = get<select_window_func>( settings, "select_window", shift_window_selection() );
+    optimization_func  optimization  = get<optimization_func>( settings, "optimization", resynthesis_optimization() );
+    optimization_factory make_optimization = get<optimization_factory>( settings, "optimization_factory", optimization_factory() );
+    cost_function cf = get<cost_function>( settings, "cost_function", costs_by_circuit_func( gate_costs() ) );
+    unsigned num_threads = get<unsigned>( settings, "num_threads", 1u );
+
+    timer<properties_timer> t;
+
+    if ( statistics )
+    {
+      properties_timer rt( statistics );
+      t.start( rt );
+    }
+
+    /* each thread needs its own functors, copies of resynthesis_optimization share the statistics of their synthesis functor */
+    if ( make_optimization )
+    {
+      optimization = make_optimization();
+    }
+    else if ( settings && settings->get<optimization_func>( "optimization", optimization_func() ) )
+    {
+      /* copies of the functor would share its state between the threads */
+      num_threads = 1u;
+    }
+    else
+    {
+      make_optimization = []() { return optimization_func( resynthesis_optimization() ); };
+    }
+
+    /* cache statistics are reported for this call only */
+    const resynthesis_optimization* ro = optimization.target<resynthesis_optimization>();
+    resynthesis_cache::ptr cache = ro ? ro->cache : resynthesis_cache::ptr();
+    unsigned long long hits = cache ? cache->hits() : 0ull;
+    unsigned long long misses = cache ? cache->misses() : 0ull;
+
+    copy_circuit( base, circ );
+    incremental_costs tracker( circ, cf );
+
+    shift_window_selection* sws = num_threads > 1u ? select_window.target<shift_window_selection>() : 0;
+    line_window_selection* lws = num_threads > 1u ? select_window.target<line_window_selection>() : 0;
+
+    if ( sws )
+    {
+      parallel_window_optimization( circ, *sws, make_optimization, tracker, num_threads );
+    }
+    else if ( lws )
+    {
+      parallel_window_optimization( circ, *lws, make_optimization, tracker, num_threads );
+    }
+    else
+    {
+      sequential_window_optimization( circ, select_window, optimization, tracker );
+    }
+
+    if ( statistics )
+    {
+      statistics->set( "costs", tracker.total() );
+    }
+
+    if ( statistics && cache )
+    {
+      statistics->set( "cache_hits", cache->hits() - hits );
+      statistics->set( "cache_misses", cache->misses() - misses );
+    }
 
     return true;
   }
 
   optimization_func window_optimization_func( properties::ptr settings, properties::ptr statistics )
   {
-    optimization_func f = [&settings, &statistics]( circuit& circ, const circuit& base ) {
+    optimization_func f = [settings, statistics]( circuit& circ, const circuit& base ) {
       return window_optimization( circ, base, settings, statistics );
     };
     f.init( settings, statistics );
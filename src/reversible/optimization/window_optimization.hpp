@@ -36,6 +36,7 @@
 #include <reversible/utils/costs.hpp>
 #include <reversible/circuit.hpp>
 #include <reversible/optimization/optimization.hpp>
+#include <reversible/optimization/resynthesis_cache.hpp>
 #include <reversible/simulation/simulation.hpp>
 #include <reversible/synthesis/synthesis.hpp>
 
@@ -44,6 +45,26 @@ namespace revkit
 
   typedef boost::tuple<circuit, std::vector<unsigned> > circuit_filter_pair;
 
+  /**
+   * @brief Position of a window in a circuit
+   *
+   * The window consists of the gates [\p from, \p to) restricted
+   * to the lines in \p filter.  An empty filter selects all lines.
+   *
+   * Used to describe batches of windows in the parallel mode of
+   * \ref revkit::window_optimization "window_optimization".
+   *
+   * @since  2.0
+   */
+  struct window_range
+  {
+    /** @cond */
+    unsigned from;
+    unsigned to;
+    std::vector<unsigned> filter;
+    /** @endcond */
+  };
+
   /**
    * @brief Functor for selecting the windows
    *
@@ -147,9 +168,29 @@ namespace revkit
      */
     circuit_filter_pair operator()( const circuit& base );
 
+    /**
+     * @brief Operator to determine a batch of non-overlapping windows.
+     *
+     * The windows which the other operator visits one after another
+     * overlap if \ref offset is less than \ref window_length.  Therefore
+     * they are split into phases such that the windows inside one
+     * phase are disjoint, i.e. phase \em k contains the windows which
+     * start at \em k * offset + \em i * \em s, where \em s is the
+     * smallest multiple of \ref offset not less than \ref window_length.
+     *
+     * @param base The original circuit
+     * @param windows Windows of the next phase in gate order
+     *
+     * @return false, if all phases have been visited
+     *
+     * @since  2.0
+     */
+    bool operator()( const circuit& base, std::vector<window_range>& windows );
+
   private:
     /** @cond */
     unsigned pos;
+    unsigned phase;
     /** @endcond */
   };
 
@@ -184,6 +225,23 @@ namespace revkit
      */
     circuit_filter_pair operator()( const circuit& base );
 
+    /**
+     * @brief Operator to determine a batch of non-overlapping windows.
+     *
+     * Returns all windows for the current number of lines at once,
+     * that is all windows that the other operator would return
+     * before increasing the number of lines.  These windows cover
+     * disjoint gate ranges.
+     *
+     * @param base The original circuit
+     * @param windows Windows for the current number of lines in gate order
+     *
+     * @return false, if all numbers of lines have been visited
+     *
+     * @since  2.0
+     */
+    bool operator()( const circuit& base, std::vector<window_range>& windows );
+
   private:
     /** @cond */
     unsigned num_lines;
@@ -230,6 +288,20 @@ namespace revkit
      */
     simulation_func simulation;
 
+    /**
+     * @brief Cache of synthesized windows
+     *
+     * If set, windows with at most \ref revkit::resynthesis_cache::max_lines "max_lines()" lines
+     * are looked up by their function before synthesis is called, and newly
+     * synthesized windows are added.  The cache is shared by all copies of this
+     * functor and can be kept across calls to window_optimization.
+     *
+     * Default value is \b 0, i.e. no cache is used
+     *
+     * @since  2.0
+     */
+    resynthesis_cache::ptr cache;
+
     /**
      * @brief Functor which wraps the re-synthesis algorithm as an optimization algorithm
      *
@@ -244,6 +316,26 @@ namespace revkit
     bool operator()( circuit& new_window, const circuit& old_window ) const;
   };
 
+  /**
+   * @brief Creates an optimization functor
+   *
+   * Used by \ref revkit::window_optimization "window_optimization" to
+   * create an independent functor for each thread, e.g. with its own
+   * synthesis and simulation functors and their statistics.
+   *
+   * @code
+   * resynthesis_cache::ptr cache( new resynthesis_cache() );
+   * settings->set( "optimization_factory", optimization_factory( [cache]() {
+   *   resynthesis_optimization ro;
+   *   ro.cache = cache;
+   *   return optimization_func( ro );
+   * } ) );
+   * @endcode
+   *
+   * @since  2.0
+   */
+  typedef boost::function<optimization_func()> optimization_factory;
+
   /**
    * @brief Window Optimization
    *
@@ -280,6 +372,14 @@ namespace revkit
    *     <td colspan="2" class="indexvalue">Functor used to optimize the selected window.</td>
    *   </tr>
    *   <tr>
+   *     <td rowspan="2" class="indexvalue">optimization_factory</td>
+   *     <td class="indexvalue">\ref revkit::optimization_factory "optimization_factory"</td>
+   *     <td class="indexvalue">\b empty</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">If set, creates the functor used to optimize the selected windows instead of \em optimization, once per call and once for each thread.</td>
+   *   </tr>
+   *   <tr>
    *     <td rowspan="2" class="indexvalue">cost_function</td>
    *     <td class="indexvalue">\ref revkit::cost_function "cost_function"</td>
    *     <td class="indexvalue">\ref revkit::gate_costs "costs_by_circuit_func( gate_costs() )"</td>
@@ -287,6 +387,14 @@ namespace revkit
    *   <tr>
    *     <td colspan="2" class="indexvalue">Cost function to determine whether the optimized circuit is cheaper.</td>
    *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">num_threads</td>
+   *     <td class="indexvalue">unsigned</td>
+   *     <td class="indexvalue">1u</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">If greater than 1 and \em select_window is a \ref revkit::shift_window_selection "shift_window_selection" or a \ref revkit::line_window_selection "line_window_selection", batches of non-overlapping windows are optimized concurrently and the improvements are committed in gate order after each batch. Each thread uses its own functor: a new one from \em optimization_factory if set, and a new \ref revkit::resynthesis_optimization "resynthesis_optimization()" if neither \em optimization nor \em optimization_factory is set.  If only \em optimization is set, one thread is used, since copies of a functor share the functors they contain, e.g. the synthesis functor of a \ref revkit::resynthesis_optimization "resynthesis_optimization" and its statistics. An exception thrown by an optimization is rethrown after all threads have finished. Since windows are selected from the circuit before the batch is committed, the result can differ from the sequential mode.</td>
+   *   </tr>
    * </table>
    * @param statistics <table border="0" width="100%">
    *   <tr>
@@ -299,6 +407,21 @@ namespace revkit
    *     <td class="indexvalue">double</td>
    *     <td class="indexvalue">Run-time consumed by the algorithm in CPU seconds.</td>
    *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">costs</td>
+   *     <td class="indexvalue">\ref revkit::cost_t "cost_t"</td>
+   *     <td class="indexvalue">Costs of the optimized circuit with respect to \em cost_function.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">cache_hits</td>
+   *     <td class="indexvalue">unsigned long long</td>
+   *     <td class="indexvalue">Windows found in the \ref revkit::resynthesis_optimization::cache "cache" of \em optimization during this call. Only set if \em optimization is a \ref revkit::resynthesis_optimization "resynthesis_optimization" with a cache.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">cache_misses</td>
+   *     <td class="indexvalue">unsigned long long</td>
+   *     <td class="indexvalue">Windows which were looked up in the cache but had to be synthesized.</td>
+   *   </tr>
    * </table>
    * @return true on success
    *
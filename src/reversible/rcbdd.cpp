@@ -17,14 +17,21 @@
 
 #include "rcbdd.hpp"
 
+#include <cstdio>
 #include <fstream>
+#include <sstream>
 
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
 #include <boost/range/irange.hpp>
 
+#include <dddmp.h>
+
 namespace revkit
 {
 
@@ -36,6 +43,24 @@ void rcbdd::initialize_manager()
   }
 }
 
+void rcbdd::reset()
+{
+  /* the BDDs have to be released before their manager */
+  _chi = BDD();
+  _xs.clear();
+  _ys.clear();
+  _zs.clear();
+  _manager = boost::none;
+
+  _constant_value = false;
+  _num_inputs = 0u;
+  _num_outputs = 0u;
+  _input_labels.clear();
+  _output_labels.clear();
+  _n = 0u;
+  _group_reordering = false;
+}
+
 void rcbdd::create_variables( unsigned n, bool create_zs )
 {
   for (unsigned i = _n; i < n; ++i)
@@ -46,11 +71,48 @@ void rcbdd::create_variables( unsigned n, bool create_zs )
     {
       _zs += _manager->bddVar();
     }
+
+    if ( _group_reordering )
+    {
+      create_group( i );
+    }
   }
 
   _n = n;
 }
 
+void rcbdd::enable_group_reordering( Cudd_ReorderingType method, unsigned next_reordering )
+{
+  if ( !_group_reordering )
+  {
+    _group_reordering = true;
+
+    for ( unsigned i = 0u; i < _n; ++i )
+    {
+      create_group( i );
+    }
+  }
+
+  _manager->AutodynEnable( method );
+  _manager->SetNextReordering( next_reordering );
+}
+
+void rcbdd::disable_reordering()
+{
+  _manager->AutodynDisable();
+}
+
+bool rcbdd::group_reordering() const
+{
+  return _group_reordering;
+}
+
+void rcbdd::create_group( unsigned i )
+{
+  /* variables of one triple are created consecutively, hence their indexes are adjacent */
+  _manager->MakeTreeNode( _xs[i].NodeReadIndex(), i < _zs.size() ? 3u : 2u, MTR_DEFAULT );
+}
+
 BDD rcbdd::x( unsigned i ) const
 {
   return _xs.at( i );
@@ -297,6 +359,188 @@ void rcbdd::write_pla( const std::string& filename )
 }
 
 
+/* reads one line from a C stream, used for the header in front of the DDDMP section */
+static bool read_header_line( FILE* fp, std::string& line )
+{
+  line.clear();
+
+  int c;
+  while ( ( c = fgetc( fp ) ) != EOF && c != '\n' )
+  {
+    line += (char)c;
+  }
+
+  return c != EOF || !line.empty();
+}
+
+bool rcbdd::save( const std::string& filename, std::string* error ) const
+{
+  FILE* fp = fopen( filename.c_str(), "w" );
+  if ( !fp )
+  {
+    if ( error )
+    {
+      *error = "Cannot open " + filename;
+    }
+    return false;
+  }
+
+  std::stringstream order;
+  for ( int level = 0; level < _manager->ReadSize(); ++level )
+  {
+    order << " " << _manager->ReadInvPerm( level );
+  }
+
+  std::stringstream header;
+  header << ".rcbdd 1" << std::endl
+         << ".vars " << _n << std::endl
+         << ".zs " << ( _zs.empty() && _n ? 0 : 1 ) << std::endl
+         << ".inputs " << _num_inputs << std::endl
+         << ".outputs " << _num_outputs << std::endl
+         << ".constant_value " << _constant_value << std::endl
+         << ".group_reordering " << _group_reordering << std::endl
+         << ".order" << order.str() << std::endl
+         << ".ilb " << boost::join( _input_labels, " " ) << std::endl
+         << ".ob " << boost::join( _output_labels, " " ) << std::endl;
+  fputs( header.str().c_str(), fp );
+
+  bool result = true;
+  if ( _chi.getNode() )
+  {
+    fputs( ".chi\n", fp );
+    result = Dddmp_cuddBddStore( _manager->getManager(), const_cast<char*>( "chi" ), _chi.getNode(), 0, 0,
+                                 DDDMP_MODE_TEXT, DDDMP_VARIDS, const_cast<char*>( filename.c_str() ), fp ) == DDDMP_SUCCESS;
+  }
+  fclose( fp );
+
+  if ( !result && error )
+  {
+    *error = "Cannot store BDD in " + filename;
+  }
+
+  return result;
+}
+
+bool rcbdd::load( const std::string& filename, std::string* error )
+{
+  FILE* fp = fopen( filename.c_str(), "r" );
+  if ( !fp )
+  {
+    if ( error )
+    {
+      *error = "Cannot open " + filename;
+    }
+    return false;
+  }
+
+  initialize_manager();
+
+  std::string line;
+  unsigned n = 0u;
+  bool create_zs = true, group = false, has_chi = false;
+  std::vector<int> order;
+
+  try
+  {
+    while ( read_header_line( fp, line ) )
+    {
+      boost::trim( line );
+      if ( line.empty() ) continue;
+
+      std::vector<std::string> params;
+      boost::split( params, line, boost::is_any_of( " " ), boost::token_compress_on );
+      std::string command = params.front();
+      params.erase( params.begin() );
+
+      if ( command == ".vars" )
+      {
+        n = boost::lexical_cast<unsigned>( params.at( 0u ) );
+      }
+      else if ( command == ".zs" )
+      {
+        create_zs = params.at( 0u ) == "1";
+      }
+      else if ( command == ".inputs" )
+      {
+        _num_inputs = boost::lexical_cast<unsigned>( params.at( 0u ) );
+      }
+      else if ( command == ".outputs" )
+      {
+        _num_outputs = boost::lexical_cast<unsigned>( params.at( 0u ) );
+      }
+      else if ( command == ".constant_value" )
+      {
+        _constant_value = params.at( 0u ) == "1";
+      }
+      else if ( command == ".group_reordering" )
+      {
+        group = params.at( 0u ) == "1";
+      }
+      else if ( command == ".order" )
+      {
+        boost::transform( params, std::back_inserter( order ), []( const std::string& s ) { return boost::lexical_cast<int>( s ); } );
+      }
+      else if ( command == ".ilb" )
+      {
+        set_input_labels( params );
+      }
+      else if ( command == ".ob" )
+      {
+        set_output_labels( params );
+      }
+      else if ( command == ".chi" )
+      {
+        has_chi = true;
+        break;
+      }
+    }
+  }
+  catch ( std::exception& )
+  {
+    if ( error )
+    {
+      *error = "Invalid header in " + filename;
+    }
+    fclose( fp );
+    return false;
+  }
+
+  create_variables( n, create_zs );
+
+  if ( order.size() == (unsigned)_manager->ReadSize() )
+  {
+    _manager->ShuffleHeap( &order[0] );
+  }
+
+  if ( group )
+  {
+    enable_group_reordering();
+  }
+
+  bool result = true;
+  if ( has_chi )
+  {
+    DdNode* node = Dddmp_cuddBddLoad( _manager->getManager(), DDDMP_VAR_MATCHIDS, 0, 0, 0,
+                                      DDDMP_MODE_TEXT, const_cast<char*>( filename.c_str() ), fp );
+    if ( node )
+    {
+      _chi = BDD( *_manager, node );
+      Cudd_RecursiveDeref( _manager->getManager(), node );
+    }
+    else
+    {
+      result = false;
+      if ( error )
+      {
+        *error = "Cannot load BDD from " + filename;
+      }
+    }
+  }
+  fclose( fp );
+
+  return result;
+}
+
 }
 
 // Local Variables:
@@ -43,7 +43,18 @@ namespace revkit
   {
   public:
     void initialize_manager();
+
+    /* Releases chi, the variables and the manager and restores the
+       default values, e.g. after a failed load. */
+    void reset();
     void create_variables( unsigned n, bool create_zs = true );
+
+    /* Keeps (x_i, y_i, z_i) adjacent during dynamic reordering, i.e. only
+       whole triples are moved by group sifting.  Must be called after
+       initialize_manager and applies to existing and future variables. */
+    void enable_group_reordering( Cudd_ReorderingType method = CUDD_REORDER_GROUP_SIFT, unsigned next_reordering = 4004u );
+    void disable_reordering();
+    bool group_reordering() const;
     BDD x( unsigned i ) const;
     BDD y( unsigned i ) const;
     BDD z( unsigned i ) const;
@@ -80,7 +91,16 @@ namespace revkit
     void print_truth_table();
     void write_pla( const std::string& filename );
 
+    /* Stores chi (via DDDMP), the labels and the variable layout including
+       the current variable order.  load expects a fresh rcbdd and creates
+       the manager and variables itself.  If load fails, the rcbdd may be
+       partially initialized and has to be reset before it is used. */
+    bool save( const std::string& filename, std::string* error = 0 ) const;
+    bool load( const std::string& filename, std::string* error = 0 );
+
   private:
+    void create_group( unsigned i );
+
     boost::optional<Cudd> _manager;
     BDD _chi;
 
@@ -93,6 +113,7 @@ namespace revkit
     std::vector<BDD> _xs;
     std::vector<BDD> _ys;
     std::vector<BDD> _zs;
+    bool _group_reordering = false;
   };
 
 }
@@ -201,7 +201,7 @@ namespace revkit
 
   simulation_func simple_simulation_func( properties::ptr settings, properties::ptr statistics )
   {
-    simulation_func f = [&settings, &statistics]( boost::dynamic_bitset<>& output, const circuit& circ, const boost::dynamic_bitset<>& input ) {
+    simulation_func f = [settings, statistics]( boost::dynamic_bitset<>& output, const circuit& circ, const boost::dynamic_bitset<>& input ) {
       return simple_simulation( output, circ, input, settings, statistics );
     };
     f.init( settings, statistics );
@@ -44,10 +44,11 @@ namespace revkit
    * It supports complemented edges, different re-ordering strategies and the generation
    * of both, Toffoli and elementary quantum gates.
    *
-   * The function representation can be read from a PLA file-name.
+   * The function representation can be read from a PLA file-name
+   * or from an AIGER file (*.aig, *.aag).
    *
    * @param circ The circuit to be constructed
-   * @param filename A PLA file
+   * @param filename A PLA or AIGER file
    * @param settings <table border="0" width="100%">
    *   <tr>
    *     <td class="indexkey">Setting</td>
@@ -38,6 +38,7 @@
 #include <cudd.h>
 #include <cuddInt.h>
 
+#include <core/io/read_aiger_to_bdd.hpp>
 #include <core/io/read_pla_to_bdd.hpp>
 
 #include <reversible/circuit.hpp>
@@ -433,7 +434,14 @@ namespace internal
   void dd_from_bdd( dd& graph, const std::string& filename, const dd_from_bdd_settings& settings )
   {
     BDDTable bdd;
-    read_pla_to_bdd( bdd, filename );
+    if ( is_aiger_filename( filename ) )
+    {
+      read_aiger_to_bdd( bdd, filename );
+    }
+    else
+    {
+      read_pla_to_bdd( bdd, filename );
+    }
 
     // Reorder the BDD
     Cudd_ReduceHeap( bdd.cudd, (Cudd_ReorderingType)settings.reordering, 0 );
@@ -19,8 +19,11 @@
 #include "synthesis_utils_p.hpp"
 
 #include <fstream>
+#include <unordered_map>
 
 #include <boost/algorithm/string/join.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/irange.hpp>
@@ -33,13 +36,15 @@
 namespace revkit
 {
 
-BDD create_bdd_from_incube(const rcbdd& cf, const std::string& incube, unsigned offset = 0u, std::vector<BDD>* dont_cares = 0)
+/* Range is a std::string or a pla_token */
+template<typename Range>
+BDD create_bdd_from_incube(const rcbdd& cf, const Range& incube, unsigned offset = 0u, std::vector<BDD>* dont_cares = 0)
 {
   BDD cube = cf.manager().bddOne();
 
-  for (unsigned i = 0u; i < incube.size(); ++i)
+  for (unsigned i = 0u; i < (unsigned)incube.size(); ++i)
   {
-    switch (incube.at(i))
+    switch (incube[i])
     {
     case '0':
       cube &= !cf.x(offset + i);
@@ -81,23 +86,65 @@ BDD create_bdd_from_outcube(const rcbdd& cf, const std::string& outcube)
   return cube;
 }
 
-std::vector<BDD> _dec(const rcbdd& cf, const std::vector<BDD>& vars)
+/* subtracts the constant k from the binary number vars (LSB first), i.e. decrements k times */
+std::vector<BDD> _sub(const rcbdd& cf, const std::vector<BDD>& vars, const mpz_class& k)
 {
   std::vector<BDD> outputs;
+  BDD borrow = cf.manager().bddZero();
 
   for (unsigned i = 0u; i < vars.size(); ++i)
   {
-    BDD cube = cf.manager().bddOne();
+    BDD kbit = mpz_tstbit(k.get_mpz_t(), i) ? cf.manager().bddOne() : cf.manager().bddZero();
 
-    for (unsigned j = 0u; j < i; ++j)
+    outputs += vars.at(i) ^ kbit ^ borrow;
+    borrow = (!vars.at(i) & (kbit | borrow)) | (kbit & borrow);
+  }
+
+  return outputs;
+}
+
+/* ORs all BDDs pairwise in a balanced tree which keeps intermediate results small */
+BDD balanced_or(const rcbdd& cf, std::vector<BDD>& bdds)
+{
+  if (bdds.empty())
+  {
+    return cf.manager().bddZero();
+  }
+
+  while (bdds.size() > 1u)
+  {
+    for (unsigned i = 0u; i + 1u < bdds.size(); i += 2u)
+    {
+      bdds[i / 2u] = bdds[i] | bdds[i + 1u];
+    }
+    if (bdds.size() % 2u == 1u)
     {
-      cube &= !vars.at(j);
+      bdds[bdds.size() / 2u] = bdds.back();
     }
+    bdds.resize((bdds.size() + 1u) / 2u);
+  }
+
+  return bdds.front();
+}
 
-    outputs += vars.at(i) ^ cube;
+/* output patterns are packed into words (only the 1s matter for the characteristic function) */
+typedef std::vector<unsigned long long> packed_outcube;
+typedef std::unordered_map<packed_outcube, mpz_class, boost::hash<packed_outcube> > multiplicity_map;
+
+template<typename Range>
+packed_outcube pack_outcube(const Range& outcube)
+{
+  packed_outcube packed((outcube.size() + 63u) / 64u, 0ull);
+
+  for (unsigned i = 0u; i < (unsigned)outcube.size(); ++i)
+  {
+    if (outcube[i] == '1')
+    {
+      packed[i / 64u] |= 1ull << (i % 64u);
+    }
   }
 
-  return outputs;
+  return packed;
 }
 
 class embed_pla_processor : public pla_processor
@@ -131,7 +178,7 @@ public:
     cf.set_output_labels( output_labels );
   }
 
-  void on_cube( const std::string& in, const std::string& out )
+  void on_cube_range( const pla_token& in, const pla_token& out )
   {
     if (!variables_generated)
     {
@@ -140,7 +187,7 @@ public:
     }
 
 
-    cubes += std::make_pair(in, out);
+    cubes.emplace_back(std::string(in.begin(), in.end()), std::string(out.begin(), out.end()));
 
     /* Calculate number of patterns */
     BDD cube = create_bdd_from_incube(cf, in);
@@ -148,11 +195,7 @@ public:
     mpz_class patterns(cube.CountMinterm(n));
 
     /* Update entry in mu */
-    if (mu.find(out) == mu.end()) {
-      mu[out] = patterns;
-    } else {
-      mu[out] += patterns;
-    }
+    mu[pack_outcube(out)] += patterns;
 
     /* Update used cubes BDD */
     u |= cube;
@@ -162,13 +205,37 @@ public:
   rcbdd& cf;
   unsigned n, m;
   BDD u;
-  std::map<std::string, mpz_class> mu;
+  multiplicity_map mu;
   std::vector<std::pair<std::string, std::string> > cubes;
 
 private:
   bool variables_generated;
 };
 
+bool load_cached_embedding( rcbdd& cf, const std::string& cache, const std::string& filename, bool const_value )
+{
+  if ( !boost::filesystem::exists( cache ) || !boost::filesystem::exists( filename )
+       || boost::filesystem::last_write_time( cache ) < boost::filesystem::last_write_time( filename ) )
+  {
+    return false;
+  }
+
+  bool group = cf.group_reordering();
+  if ( cf.load( cache ) && cf.constant_value() == const_value )
+  {
+    return true;
+  }
+
+  /* start over with the manager as it was passed */
+  cf.reset();
+  cf.initialize_manager();
+  if ( group )
+  {
+    cf.enable_group_reordering();
+  }
+  return false;
+}
+
 bool embed_pla( rcbdd& cf, const std::string& filename,
                 properties::ptr settings,
                 properties::ptr statistics )
@@ -178,6 +245,7 @@ bool embed_pla( rcbdd& cf, const std::string& filename,
   bool        truth_table = get( settings, "truth_table", false         ); /* prints the truth table (for debugging) */
   std::string write_pla   = get( settings, "write_pla",   std::string() );
   bool        const_value = get( settings, "const_value", false         ); /* value that is used for constant embedding */
+  std::string cache       = get( settings, "cache",       std::string() ); /* stores the embedding and reuses it as long as it is newer than the PLA */
 
   /* Timing */
   timer<properties_timer> t;
@@ -190,6 +258,12 @@ bool embed_pla( rcbdd& cf, const std::string& filename,
   /* BDD manager? */
   cf.initialize_manager();
 
+  /* Cached embedding */
+  if ( !cache.empty() && load_cached_embedding( cf, cache, filename, const_value ) )
+  {
+    return true;
+  }
+
   /* Constant value */
   cf.set_constant_value( const_value );
 
@@ -204,10 +278,8 @@ bool embed_pla( rcbdd& cf, const std::string& filename,
 
   BDD zeroCubes = !p.u;
   std::string zerocube = std::string(p.m, '0');
-  if (p.mu.find(zerocube) == p.mu.end())
-  {
-    p.mu[zerocube] = 0;
-  }
+  packed_outcube packed_zerocube = pack_outcube(zerocube);
+  p.mu[packed_zerocube];
 
   Cudd_ForeachCube(zeroCubes.manager(), zeroCubes.getNode(), gen, cube, value)
   {
@@ -230,7 +302,7 @@ bool embed_pla( rcbdd& cf, const std::string& filename,
       }
     }
 
-    p.mu[zerocube] += mpz_class(create_bdd_from_incube(cf, incube).CountMinterm(p.n));
+    p.mu[packed_zerocube] += mpz_class(create_bdd_from_incube(cf, incube).CountMinterm(p.n));
     p.cubes += std::make_pair(incube, zerocube);
   }
 
@@ -253,6 +325,19 @@ bool embed_pla( rcbdd& cf, const std::string& filename,
     garbage += cf.y(i);
   }
 
+  /* Constant inputs */
+  BDD constants = cf.manager().bddOne();
+  for (unsigned i = 0u; i < req_vars - p.n; i++)
+  {
+    constants &= ( const_value ? cf.x(i) : !cf.x(i) );
+  }
+
+  /* h is the input projection of func, i.e. remove_ys( func ), and is
+     maintained incrementally while new cubes are collected in pending.
+     func itself is only built when needed using a balanced OR tree. */
+  BDD h = cf.manager().bddZero();
+  std::vector<BDD> pending;
+
   for (const auto& cube : p.cubes) {
     /* Assign cubes to local variables */
     const std::string& incube = cube.first;
@@ -263,29 +348,11 @@ bool embed_pla( rcbdd& cf, const std::string& filename,
     BDD ocube = create_bdd_from_outcube(cf, outcube);
     mpz_class patterns(icube.CountMinterm(p.n));
 
-    /* compute h */
-    BDD constants = cf.manager().bddOne();
-    for ( unsigned i = 0; i < req_vars - p.n; ++i ) { constants += cf.x( i ); }
-    BDD h = cf.remove_ys( func ).ExistAbstract(constants);
-    assert( !h & icube == icube );
-
     /* add new cubes */
-    BDD fcube = cf.manager().bddOne();
-    for (unsigned i = 0u; i < req_vars - p.n; i++)
-    {
-      fcube &= ( const_value ? cf.x(i) : !cf.x(i) );
-    }
-    fcube &= !h & icube & ocube;
+    BDD fcube = constants & !h & icube & ocube;
 
-    if (p.mu.find(outcube) == p.mu.end()) {
-      p.mu[outcube] = 0u;
-    }
-
-    std::vector<BDD> dec_garbage = garbage;
-    for (unsigned i = 0u; i < p.mu[outcube]; ++i)
-    {
-      dec_garbage = _dec(cf, dec_garbage);
-    }
+    mpz_class& mu = p.mu[pack_outcube(outcube)];
+    std::vector<BDD> dec_garbage = _sub(cf, garbage, mu);
 
     /* Assign don't cares to dec_garbage (from back to front) */
     for (unsigned i = 0u; i < (req_vars - p.m); ++i)
@@ -300,14 +367,27 @@ bool embed_pla( rcbdd& cf, const std::string& filename,
       }
     }
 
-    func |= fcube;
-    p.mu[outcube] += patterns;
+    pending += fcube;
+    mu += patterns;
 
-    /* Update existing cubes */
-    assert( (h & icube) == cf.manager().bddZero() );
-    func &= !(h & icube) | ocube;
+    /* Update existing cubes (only if input cubes overlap, which does not happen for extended PLAs) */
+    BDD overlap = h & icube;
+    if (overlap != cf.manager().bddZero())
+    {
+      pending += func;
+      func = balanced_or(cf, pending) & (!overlap | ocube);
+      pending.clear();
+      h = cf.remove_ys(func);
+    }
+    else
+    {
+      h |= cf.remove_ys(fcube);
+    }
   }
 
+  pending += func;
+  func = balanced_or(cf, pending);
+
   /* Assign zeros */
   for ( unsigned i = 0; i < p.m; ++i )
   {
@@ -337,6 +417,11 @@ bool embed_pla( rcbdd& cf, const std::string& filename,
     cf.write_pla( write_pla );
   }
 
+  if ( !cache.empty() )
+  {
+    cf.save( cache );
+  }
+
   return true;
 
 }
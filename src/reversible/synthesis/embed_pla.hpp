@@ -45,6 +45,25 @@ namespace revkit
                   properties::ptr statistics = properties::ptr() );
 
 
+  /**
+   * @brief Loads an embedding which has been stored with the \em cache setting of embed_pla
+   *
+   * The embedding is only loaded if \p cache is not older than
+   * \p filename and has been computed with the same constant value.
+   * Otherwise, \p cf is reset to an initialized manager with the
+   * group reordering as passed.
+   *
+   * @param cf Characteristic function
+   * @param cache Stored embedding
+   * @param filename PLA from which the embedding has been computed
+   * @param const_value Value that is used for constant embedding
+   *
+   * @return true, if the embedding has been loaded
+   *
+   * @since  2.0
+   */
+  bool load_cached_embedding( rcbdd& cf, const std::string& cache, const std::string& filename, bool const_value = false );
+
   pla_embedding_func embed_pla_func( properties::ptr settings = properties::ptr( new properties() ), properties::ptr statistics = properties::ptr( new properties() ) );
 
 }
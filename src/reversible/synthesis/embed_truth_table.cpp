@@ -230,7 +230,7 @@ namespace revkit
 
   embedding_func embed_truth_table_func( properties::ptr settings, properties::ptr statistics )
   {
-    embedding_func f = [&settings, &statistics]( binary_truth_table& spec, const binary_truth_table& base ) {
+    embedding_func f = [settings, statistics]( binary_truth_table& spec, const binary_truth_table& base ) {
       return embed_truth_table( spec, base, settings, statistics );
     };
     f.init( settings, statistics );
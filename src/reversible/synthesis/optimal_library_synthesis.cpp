@@ -0,0 +1,386 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "optimal_library_synthesis.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <core/utils/cancellation_token.hpp>
+#include <core/utils/timer.hpp>
+#include <reversible/target_tags.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/functions/clear_circuit.hpp>
+#include <reversible/functions/copy_metadata.hpp>
+#include <reversible/functions/fully_specified.hpp>
+#include <reversible/synthesis/transformation_based_synthesis.hpp>
+
+namespace revkit
+{
+
+  /* permutations are packed into 64 bits with 4 bits per value */
+  typedef std::uint64_t packed_permutation;
+
+  class optimal_circuit_library::priv
+  {
+  public:
+    explicit priv( unsigned n ) : n( n ), num_values( 1u << n ) {}
+
+    unsigned value( packed_permutation p, unsigned x ) const
+    {
+      return ( p >> ( 4u * x ) ) & 15u;
+    }
+
+    packed_permutation apply( unsigned g, packed_permutation p ) const
+    {
+      packed_permutation result = 0u;
+      for ( unsigned x = 0u; x < num_values; ++x )
+      {
+        unsigned v = value( p, x );
+        if ( ( v & gates[g].first ) == gates[g].first )
+        {
+          v ^= 1u << gates[g].second;
+        }
+        result |= packed_permutation( v ) << ( 4u * x );
+      }
+      return result;
+    }
+
+    /* Lehmer code */
+    unsigned rank( packed_permutation p ) const
+    {
+      unsigned r = 0u;
+      for ( unsigned i = 0u; i < num_values; ++i )
+      {
+        unsigned smaller = 0u;
+        for ( unsigned j = i + 1u; j < num_values; ++j )
+        {
+          if ( value( p, j ) < value( p, i ) ) ++smaller;
+        }
+        r = r * ( num_values - i ) + smaller;
+      }
+      return r;
+    }
+
+    /* 0 for the identity, gate index + 1 otherwise, or not_found */
+    unsigned char last_gate( packed_permutation p ) const
+    {
+      if ( n <= 3u )
+      {
+        return dense[rank( p )];
+      }
+      else
+      {
+        auto it = sparse.find( p );
+        return it == sparse.end() ? not_found : it->second;
+      }
+    }
+
+    static const unsigned char not_found = 0xff;
+
+    unsigned n;
+    unsigned num_values;
+
+    /* controls as mask and target */
+    std::vector<std::pair<unsigned, unsigned> > gates;
+
+    std::vector<unsigned char> dense;
+    std::unordered_map<packed_permutation, unsigned char> sparse;
+  };
+
+  const unsigned char optimal_circuit_library::priv::not_found;
+
+  /* checked before priv is allocated, since the destructor is not called on a throwing constructor */
+  unsigned checked_library_lines( unsigned num_lines, cost_t max_cost )
+  {
+    if ( num_lines < 1u || num_lines > 4u )
+    {
+      throw std::invalid_argument( "optimal_circuit_library supports 1 to 4 lines." );
+    }
+
+    if ( num_lines == 4u && !max_cost )
+    {
+      throw std::invalid_argument( "optimal_circuit_library requires a maximal cost for 4 lines." );
+    }
+
+    return num_lines;
+  }
+
+  optimal_circuit_library::optimal_circuit_library( unsigned num_lines, const costs_by_gate_func& cf, cost_t max_cost )
+    : d( new priv( checked_library_lines( num_lines, max_cost ) ) )
+  {
+
+    /* all Toffoli gates with positive controls */
+    std::vector<cost_t> gate_costs;
+    for ( unsigned t = 0u; t < num_lines; ++t )
+    {
+      for ( unsigned mask = 0u; mask < d->num_values; ++mask )
+      {
+        if ( mask & ( 1u << t ) ) continue;
+
+        d->gates.push_back( std::make_pair( mask, t ) );
+
+        gate g;
+        for ( unsigned i = 0u; i < num_lines; ++i )
+        {
+          if ( mask & ( 1u << i ) ) g.add_control( make_var( i ) );
+        }
+        g.add_target( t );
+        g.set_type( toffoli_tag() );
+        gate_costs.push_back( cf ? cf( g, num_lines ) : 1u );
+      }
+    }
+
+    /* uniform-cost search from the identity */
+    packed_permutation identity = 0u;
+    for ( unsigned x = 0u; x < d->num_values; ++x )
+    {
+      identity |= packed_permutation( x ) << ( 4u * x );
+    }
+
+    typedef std::pair<cost_t, packed_permutation> queue_entry;
+    std::priority_queue<queue_entry, std::vector<queue_entry>, std::greater<queue_entry> > queue;
+    std::unordered_map<packed_permutation, std::pair<cost_t, unsigned char> > best;
+
+    best[identity] = std::make_pair( 0u, 0u );
+    queue.push( queue_entry( 0u, identity ) );
+
+    while ( !queue.empty() )
+    {
+      queue_entry e = queue.top();
+      queue.pop();
+
+      if ( best[e.second].first < e.first ) continue;
+
+      for ( unsigned g = 0u; g < d->gates.size(); ++g )
+      {
+        cost_t c = e.first + gate_costs[g];
+        if ( max_cost && c > max_cost ) continue;
+
+        packed_permutation p = d->apply( g, e.second );
+        auto it = best.find( p );
+        if ( it == best.end() || c < it->second.first )
+        {
+          best[p] = std::make_pair( c, g + 1u );
+          queue.push( queue_entry( c, p ) );
+        }
+      }
+    }
+
+    if ( num_lines <= 3u )
+    {
+      unsigned factorial = 1u;
+      for ( unsigned i = 2u; i <= d->num_values; ++i ) factorial *= i;
+
+      d->dense.assign( factorial, priv::not_found );
+      for ( const auto& p : best )
+      {
+        d->dense[d->rank( p.first )] = p.second.second;
+      }
+    }
+    else
+    {
+      for ( const auto& p : best )
+      {
+        d->sparse[p.first] = p.second.second;
+      }
+    }
+  }
+
+  optimal_circuit_library::~optimal_circuit_library()
+  {
+    delete d;
+  }
+
+  unsigned optimal_circuit_library::lines() const
+  {
+    return d->n;
+  }
+
+  unsigned optimal_circuit_library::size() const
+  {
+    return d->n <= 3u ? d->dense.size() - std::count( d->dense.begin(), d->dense.end(), priv::not_found ) : d->sparse.size();
+  }
+
+  bool optimal_circuit_library::find( const std::vector<unsigned>& perm, circuit& circ ) const
+  {
+    if ( perm.size() != d->num_values )
+    {
+      return false;
+    }
+
+    packed_permutation p = 0u;
+    std::vector<bool> seen( d->num_values );
+    for ( unsigned x = 0u; x < d->num_values; ++x )
+    {
+      if ( perm[x] >= d->num_values || seen[perm[x]] ) return false;
+      seen[perm[x]] = true;
+      p |= packed_permutation( perm[x] ) << ( 4u * x );
+    }
+
+    /* undo the last gates until the identity is reached */
+    std::vector<unsigned> gates;
+    for ( unsigned char g = d->last_gate( p ); g; g = d->last_gate( p ) )
+    {
+      if ( g == priv::not_found ) return false;
+
+      gates.push_back( g - 1u );
+      p = d->apply( g - 1u, p );
+    }
+
+    circ.set_lines( d->n );
+    for ( auto it = gates.rbegin(); it != gates.rend(); ++it )
+    {
+      gate::control_container controls;
+      for ( unsigned i = 0u; i < d->n; ++i )
+      {
+        if ( d->gates[*it].first & ( 1u << i ) ) controls.push_back( make_var( i ) );
+      }
+      append_toffoli( circ, controls, d->gates[*it].second );
+    }
+
+    return true;
+  }
+
+  /* gate count libraries for 1 to 3 lines, computed on first use */
+  const optimal_circuit_library& default_optimal_circuit_library( unsigned num_lines )
+  {
+    switch ( num_lines )
+    {
+    case 1u:
+      {
+        static const optimal_circuit_library library( 1u );
+        return library;
+      }
+    case 2u:
+      {
+        static const optimal_circuit_library library( 2u );
+        return library;
+      }
+    default:
+      {
+        static const optimal_circuit_library library( 3u );
+        return library;
+      }
+    }
+  }
+
+  bool optimal_library_synthesis( circuit& circ, const binary_truth_table& spec,
+                                  properties::ptr settings,
+                                  properties::ptr statistics )
+  {
+    /* Settings */
+    optimal_circuit_library::ptr library = get<optimal_circuit_library::ptr>( settings, "library", optimal_circuit_library::ptr() );
+    truth_table_synthesis_func fallback  = get<truth_table_synthesis_func>( settings, "fallback", truth_table_synthesis_func() );
+    cancellation_token         token     = get( settings, "cancellation_token", cancellation_token::current() );
+
+    timer<properties_timer> t;
+
+    if ( statistics )
+    {
+      properties_timer rt( statistics );
+      t.start( rt );
+    }
+
+    // circuit has to be empty
+    clear_circuit( circ );
+
+    // truth table has to be fully specified
+    if ( !fully_specified( spec ) )
+    {
+      set_error_message( statistics, "truth table `spec` is not fully specified." );
+      return false;
+    }
+
+    unsigned n = spec.num_outputs();
+
+    bool found = false;
+    try
+    {
+      const optimal_circuit_library* l = ( library && library->lines() == n ) ? library.get() : ( n >= 1u && n <= 3u ) ? &default_optimal_circuit_library( n ) : 0;
+
+      if ( l && spec.num_inputs() == n )
+      {
+        std::vector<unsigned> perm( 1u << n );
+        for ( binary_truth_table::const_iterator it = spec.begin(); it != spec.end(); ++it )
+        {
+          unsigned input = 0u, output = 0u;
+          for ( unsigned i = 0u; i < n; ++i )
+          {
+            input |= ( **( it->first.first + i ) ? 1u : 0u ) << i;
+            output |= ( **( it->second.first + i ) ? 1u : 0u ) << i;
+          }
+          perm[input] = output;
+        }
+
+        found = l->find( perm, circ );
+      }
+    }
+    catch ( const std::exception& e )
+    {
+      set_error_message( statistics, std::string( "cannot build optimal circuit library: " ) + e.what() );
+      return false;
+    }
+
+    if ( statistics )
+    {
+      statistics->set( "from_library", found );
+    }
+
+    if ( found )
+    {
+      copy_metadata( spec, circ );
+      return true;
+    }
+
+    clear_circuit( circ );
+    if ( token.is_cancelled() )
+    {
+      set_error_message( statistics, "synthesis was cancelled." );
+      return false;
+    }
+
+    if ( fallback )
+    {
+      return fallback( circ, spec );
+    }
+
+    properties::ptr fallback_settings( new properties() );
+    fallback_settings->set( "cancellation_token", token );
+    return transformation_based_synthesis( circ, spec, fallback_settings );
+  }
+
+  truth_table_synthesis_func optimal_library_synthesis_func( properties::ptr settings, properties::ptr statistics )
+  {
+    truth_table_synthesis_func f = [settings, statistics]( circuit& circ, const binary_truth_table& spec ) {
+      return optimal_library_synthesis( circ, spec, settings, statistics );
+    };
+    f.init( settings, statistics );
+    return f;
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
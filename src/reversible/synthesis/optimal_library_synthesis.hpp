@@ -0,0 +1,219 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file optimal_library_synthesis.hpp
+ *
+ * @brief Synthesis of small functions by lookup of minimal circuits
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef OPTIMAL_LIBRARY_SYNTHESIS_HPP
+#define OPTIMAL_LIBRARY_SYNTHESIS_HPP
+
+#include <memory>
+#include <vector>
+
+#include <core/properties.hpp>
+#include <reversible/circuit.hpp>
+#include <reversible/truth_table.hpp>
+#include <reversible/utils/costs.hpp>
+
+#include <reversible/synthesis/synthesis.hpp>
+
+namespace revkit
+{
+
+  /**
+   * @brief Library of minimal Toffoli circuits for small reversible functions
+   *
+   * The library is computed by a uniform-cost search over compositions
+   * of Toffoli gates with positive controls, starting from the identity.
+   * For each reached permutation only the last gate of a cheapest circuit
+   * is stored, the circuit is recovered by undoing one gate after the other.
+   *
+   * On up to 3 lines all permutations are reached, i.e. all 40,320 functions
+   * for 3 lines, and are stored in an array indexed by the rank of the permutation.
+   * On 4 lines only functions up to a maximal cost can be enumerated, they are
+   * stored in a hash table.
+   *
+   * @since  2.0
+   */
+  class optimal_circuit_library
+  {
+  public:
+    /**
+     * @brief Smart pointer of a library
+     *
+     * @since  2.0
+     */
+    typedef std::shared_ptr<optimal_circuit_library> ptr;
+
+    /**
+     * @brief Computes the library
+     *
+     * @param num_lines Number of lines, at most 4
+     * @param cf Cost of a single gate, if empty each gate has cost 1, i.e. the number of gates is minimized
+     * @param max_cost If not 0, only functions up to this cost are stored.
+     *                 Has to be set for 4 lines.
+     *
+     * @throw std::invalid_argument if \p num_lines is not between 1 and 4,
+     *        or if \p max_cost is 0 for 4 lines
+     *
+     * @since  2.0
+     */
+    explicit optimal_circuit_library( unsigned num_lines, const costs_by_gate_func& cf = costs_by_gate_func(), cost_t max_cost = 0u );
+
+    /**
+     * @brief Deletes the library
+     *
+     * @since  2.0
+     */
+    ~optimal_circuit_library();
+
+    /**
+     * @brief Number of lines
+     *
+     * @since  2.0
+     */
+    unsigned lines() const;
+
+    /**
+     * @brief Number of functions in the library
+     *
+     * @since  2.0
+     */
+    unsigned size() const;
+
+    /**
+     * @brief Looks up a minimal circuit
+     *
+     * @param perm Permutation with \f$2^n\f$ entries, where bit \em i
+     *             of a value corresponds to line \em i
+     * @param circ Circuit, which is assigned the minimal circuit
+     *
+     * @return false, if the function is not in the library
+     *
+     * @since  2.0
+     */
+    bool find( const std::vector<unsigned>& perm, circuit& circ ) const;
+
+  private:
+    optimal_circuit_library( const optimal_circuit_library& ) = delete;
+    optimal_circuit_library& operator=( const optimal_circuit_library& ) = delete;
+
+    class priv;
+    priv* const d;
+  };
+
+  /**
+   * @brief Synthesizes a circuit by looking it up in a library of minimal circuits
+   *
+   * Specifications on 1 to 3 lines are looked up in libraries which minimize the
+   * number of gates.  These are computed once when they are used first.  A library
+   * for a different cost model or for 4 lines can be given with the \em library
+   * setting.  Specifications which are not covered by a library are synthesized
+   * with the \em fallback algorithm.
+   *
+   * Since the algorithm fits the \ref revkit::truth_table_synthesis_func "truth_table_synthesis_func"
+   * interface, it can be used for the windows of \ref revkit::resynthesis_optimization "resynthesis_optimization"
+   * and within \ref revkit::swop "swop".
+   *
+   * @param circ       Empty Circuit
+   * @param spec       Function Specification (has to be fully specified)
+   * @param settings <table border="0" width="100%">
+   *   <tr>
+   *     <td class="indexkey">Setting</td>
+   *     <td class="indexkey">Type</td>
+   *     <td class="indexkey">Default Value</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">library</td>
+   *     <td class="indexvalue">\ref revkit::optimal_circuit_library::ptr "optimal_circuit_library::ptr"</td>
+   *     <td class="indexvalue">0</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Library which is used instead of the default one for specifications with the same number of lines.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">fallback</td>
+   *     <td class="indexvalue">\ref revkit::truth_table_synthesis_func "truth_table_synthesis_func"</td>
+   *     <td class="indexvalue">empty</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Synthesis algorithm for specifications which are not in a library. If empty, \ref revkit::transformation_based_synthesis "transformation_based_synthesis" is used.</td>
+   *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">cancellation_token</td>
+   *     <td class="indexvalue">\ref revkit::cancellation_token "cancellation_token"</td>
+   *     <td class="indexvalue">cancellation_token::current()</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Checked before the fallback is called, if it is cancelled the algorithm returns false.  The default fallback gets the token as well.</td>
+   *   </tr>
+   * </table>
+   * @param statistics <table border="0" width="100%">
+   *   <tr>
+   *     <td class="indexkey">Information</td>
+   *     <td class="indexkey">Type</td>
+   *     <td class="indexkey">Description</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">runtime</td>
+   *     <td class="indexvalue">double</td>
+   *     <td class="indexvalue">Run-time consumed by the algorithm in CPU seconds.</td>
+   *   </tr>
+   *   <tr>
+   *     <td class="indexvalue">from_library</td>
+   *     <td class="indexvalue">bool</td>
+   *     <td class="indexvalue">Whether the circuit was found in a library.</td>
+   *   </tr>
+   * </table>
+   *
+   * @return true if successful, false otherwise, e.g. if a default library
+   *         cannot be built.  The reason is stored as error message in
+   *         \p statistics.
+   *
+   * @since  2.0
+   */
+  bool optimal_library_synthesis( circuit& circ, const binary_truth_table& spec,
+                                  properties::ptr settings = properties::ptr(),
+                                  properties::ptr statistics = properties::ptr() );
+
+  /**
+   * @brief Functor for the \ref revkit::optimal_library_synthesis "optimal_library_synthesis" algorithm
+   *
+   * @param settings Settings (see \ref revkit::optimal_library_synthesis "optimal_library_synthesis")
+   * @param statistics Statistics (see \ref revkit::optimal_library_synthesis "optimal_library_synthesis")
+   *
+   * @return A functor which complies with the \ref revkit::truth_table_synthesis_func "truth_table_based_synthesis_func" interface
+   *
+   * @since  2.0
+   */
+  truth_table_synthesis_func optimal_library_synthesis_func( properties::ptr settings = properties::ptr( new properties() ), properties::ptr statistics = properties::ptr( new properties() ) );
+
+}
+
+#endif /* OPTIMAL_LIBRARY_SYNTHESIS_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
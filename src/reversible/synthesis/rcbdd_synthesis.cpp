@@ -20,10 +20,15 @@
 
 #include <core/utils/timer.hpp>
 #include <reversible/functions/add_gates.hpp>
+#include <reversible/io/read_realization.hpp>
+#include <reversible/io/revlib_parser.hpp>
+#include <reversible/io/write_realization.hpp>
 #include <classical/optimization/optimization.hpp>
 
+#include <cstdio>
 #include <fstream>
 
+#include <boost/format.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
 
@@ -35,6 +40,28 @@ enum Direction {
   ChangeRight
 };
 
+/* reads the partial circuit of a checkpoint and the progress stored in its header */
+class checkpoint_processor : public circuit_processor
+{
+public:
+  checkpoint_processor( circuit& circ, unsigned& next_var, unsigned& insert_position )
+    : circuit_processor( circ ),
+      next_var( next_var ),
+      insert_position( insert_position )
+  {
+  }
+
+protected:
+  void on_comment( const std::string& comment ) const
+  {
+    sscanf( comment.c_str(), " rcbdd_synthesis checkpoint %u %u", &next_var, &insert_position );
+  }
+
+private:
+  unsigned& next_var;
+  unsigned& insert_position;
+};
+
 struct rcbdd_synthesis_manager
 {
   rcbdd_synthesis_manager( const rcbdd& _cf, circuit& _circ )
@@ -438,9 +465,50 @@ struct rcbdd_synthesis_manager
     */
   }
 
+  void reorder()
+  {
+    if ( !reorder_after_variable ) return;
+
+    /* the tree of variable groups registered in cf is respected by every method */
+    cf.manager().ReduceHeap( reordering_method, 0 );
+
+    if ( verbose )
+    {
+      std::cout << "[I] live nodes after reordering: " << cf.manager().ReadNodeCount() << std::endl;
+    }
+  }
+
+  void write_checkpoint( unsigned next_var )
+  {
+    rcbdd state = cf;
+    state.set_chi( f );
+
+    write_realization_settings settings;
+    settings.header = boost::str( boost::format( "rcbdd_synthesis checkpoint %d %d" ) % next_var % insert_position );
+
+    /* write both files aside first so that a crash never leaves a half-written checkpoint */
+    if ( state.save( checkpoint + ".rcbdd.tmp" ) && write_realization( circ, checkpoint + ".real.tmp", settings ) )
+    {
+      std::rename( ( checkpoint + ".rcbdd.tmp" ).c_str(), ( checkpoint + ".rcbdd" ).c_str() );
+      std::rename( ( checkpoint + ".real.tmp" ).c_str(), ( checkpoint + ".real" ).c_str() );
+    }
+
+    if ( verbose || progress )
+    {
+      std::cout << "[I] wrote checkpoint " << checkpoint << " before variable " << next_var << std::endl;
+    }
+  }
+
+  bool read_checkpoint()
+  {
+    std::ifstream is( ( checkpoint + ".real" ).c_str() );
+    checkpoint_processor p( circ, start_var, insert_position );
+    return is.good() && revlib_parser( is, p );
+  }
+
   void default_synthesis()
   {
-    for (unsigned var = 0; var < cf.num_vars(); ++var)
+    for (unsigned var = start_var; var < cf.num_vars(); ++var)
     {
       if ( verbose || progress )
       {
@@ -462,6 +530,13 @@ struct rcbdd_synthesis_manager
 
       create_toffoli_gates_with_exorcism(left_f, var, 0u);
       create_toffoli_gates_with_exorcism(right_f, var, 1u);
+
+      reorder();
+
+      if ( checkpoint_interval && ( var + 1u ) % checkpoint_interval == 0u && var + 1u < cf.num_vars() )
+      {
+        write_checkpoint( var + 1u );
+      }
     }
   }
 
@@ -547,6 +622,8 @@ struct rcbdd_synthesis_manager
       create_toffoli_gates_with_exorcism(left_f, best_line, 0u);
       create_toffoli_gates_with_exorcism(right_f, best_line, 1u);
 
+      reorder();
+
       list_lines.erase(std::remove(list_lines.begin(),list_lines.end(),best_line));
 
       if ( verbose )
@@ -598,6 +675,8 @@ struct rcbdd_synthesis_manager
       create_toffoli_gates_with_exorcism(left_f, best_line, 0u);
       create_toffoli_gates_with_exorcism(right_f, best_line, 1u);
 
+      reorder();
+
       list_lines.erase(std::remove(list_lines.begin(),list_lines.end(),best_line));
 
       if ( verbose )
@@ -616,6 +695,11 @@ struct rcbdd_synthesis_manager
   bool genesop;
   dd_based_esop_optimization_func esopmin;
   bool create_gates;
+  bool reorder_after_variable;
+  Cudd_ReorderingType reordering_method;
+  std::string checkpoint;
+  unsigned checkpoint_interval;
+  unsigned start_var = 0u;
 
   BDD f;
   BDD left_f, right_f;
@@ -630,14 +714,22 @@ struct rcbdd_synthesis_manager
 bool rcbdd_synthesis( circuit& circ, const rcbdd& cf, properties::ptr settings, properties::ptr statistics )
 {
   /* Settings */
-  bool                            verbose      = get( settings, "verbose",      false                             );
-  bool                            progress     = get( settings, "progress",     false                             );
-  std::string                     name         = get( settings, "name",         std::string( "test" )             );
-  bool                            genesop      = get( settings, "genesop",      false                             );
-  dd_based_esop_optimization_func esopmin      = get( settings, "esopmin",      dd_based_esop_optimization_func() );
-  bool                            create_gates = get( settings, "create_gates", true                              );
+  bool                            verbose                = get( settings, "verbose",                false                             );
+  bool                            progress               = get( settings, "progress",               false                             );
+  std::string                     name                   = get( settings, "name",                   std::string( "test" )             );
+  bool                            genesop                = get( settings, "genesop",                false                             );
+  dd_based_esop_optimization_func esopmin                = get( settings, "esopmin",                dd_based_esop_optimization_func() );
+  bool                            create_gates           = get( settings, "create_gates",           true                              );
   /* 0: default, 1: swap, 2: hamming */
-  unsigned                        mode         = get( settings, "mode",         0u                                );
+  unsigned                        mode                   = get( settings, "mode",                   0u                                );
+  /* explicitly reorders the BDD after each target line (see rcbdd::enable_group_reordering for automatic reordering) */
+  bool                            reorder_after_variable = get( settings, "reorder_after_variable", false                             );
+  Cudd_ReorderingType             reordering_method      = get( settings, "reordering_method",      CUDD_REORDER_GROUP_SIFT           );
+  /* checkpoints (only in default mode, rejected otherwise): writes <checkpoint>.rcbdd and <checkpoint>.real every
+     checkpoint_interval variables; with resume the synthesis continues from there and cf is ignored */
+  std::string                     checkpoint             = get( settings, "checkpoint",             std::string()                     );
+  unsigned                        checkpoint_interval    = get( settings, "checkpoint_interval",    0u                                );
+  bool                            resume                 = get( settings, "resume",                 false                             );
 
   /* Timing */
   timer<properties_timer> t;
@@ -647,13 +739,42 @@ bool rcbdd_synthesis( circuit& circ, const rcbdd& cf, properties::ptr settings,
     t.start(rt);
   }
 
-  rcbdd_synthesis_manager mgr( cf, circ );
+  /* the heuristics do not process the variables in order, hence there is no point to resume from */
+  if ( mode != 0u && ( resume || ( !checkpoint.empty() && checkpoint_interval ) ) )
+  {
+    set_error_message( statistics, "checkpoints and resume are only supported in mode 0" );
+    return false;
+  }
+
+  rcbdd resumed;
+  if ( resume )
+  {
+    std::string error;
+    if ( !resumed.load( checkpoint + ".rcbdd", &error ) )
+    {
+      set_error_message( statistics, error );
+      return false;
+    }
+  }
+
+  rcbdd_synthesis_manager mgr( resume ? resumed : cf, circ );
   mgr.verbose      = verbose;
   mgr.progress     = progress;
   mgr.name         = name;
   mgr.genesop      = genesop;
   mgr.esopmin      = esopmin;
   mgr.create_gates = create_gates;
+  mgr.reorder_after_variable = reorder_after_variable;
+  mgr.reordering_method      = reordering_method;
+  mgr.checkpoint             = checkpoint;
+  mgr.checkpoint_interval    = checkpoint.empty() ? 0u : checkpoint_interval;
+
+  if ( resume && !mgr.read_checkpoint() )
+  {
+    set_error_message( statistics, "Cannot read checkpoint " + checkpoint + ".real" );
+    return false;
+  }
+
   switch ( mode )
   {
   case 1u:
@@ -666,6 +787,14 @@ bool rcbdd_synthesis( circuit& circ, const rcbdd& cf, properties::ptr settings,
     mgr.default_synthesis();
   };
 
+  if ( statistics )
+  {
+    /* values are accumulated over the lifetime of the manager, i.e. include the embedding */
+    statistics->set( "peak_live_nodes", (unsigned)mgr.cf.manager().ReadPeakLiveNodeCount() );
+    statistics->set( "num_reorderings", (unsigned)mgr.cf.manager().ReadReorderings() );
+    statistics->set( "reordering_time", mgr.cf.manager().ReadReorderingTime() / 1000.0 );
+  }
+
   return true;
 }
 
@@ -30,6 +30,7 @@
 #include <boost/variant.hpp>
 
 #include <core/functor.hpp>
+#include <core/utils/cancellation_token.hpp>
 #include <core/utils/timer.hpp>
 
 #include <reversible/functions/add_gates.hpp>
@@ -200,6 +201,7 @@ namespace revkit
 
     // Settings parsing
     bool bidirectional = get( settings, "bidirectional", true );
+    cancellation_token token = get( settings, "cancellation_token", cancellation_token::current() );
 
     // Run-time measuring
     timer<properties_timer> t;
@@ -287,6 +289,12 @@ namespace revkit
 
     for ( unsigned i = 1u; i < ( 1u << n ) - 1; ++i )
     {
+      if ( token.is_cancelled() )
+      {
+        set_error_message( statistics, "synthesis was cancelled." );
+        return false;
+      }
+
       // Step B (i = 2^(k-1), variable rows)
       if ( ( log( i ) / log( 2.0 ) ) == ceil( ( log( i ) / log( 2.0 ) ) ) )
       {
@@ -366,7 +374,7 @@ namespace revkit
 
   truth_table_synthesis_func reed_muller_synthesis_func( properties::ptr settings, properties::ptr statistics )
   {
-    truth_table_synthesis_func f = [&settings, &statistics]( circuit& circ, const binary_truth_table& spec ) {
+    truth_table_synthesis_func f = [settings, statistics]( circuit& circ, const binary_truth_table& spec ) {
       return reed_muller_synthesis( circ, spec, settings, statistics );
     };
     f.init( settings, statistics );
@@ -58,6 +58,14 @@ namespace revkit
    *   <tr>
    *     <td colspan="2" class="indexvalue">Use the bidirectional approach as described in [\ref MDM07].</td>
    *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">cancellation_token</td>
+   *     <td class="indexvalue">\ref revkit::cancellation_token "cancellation_token"</td>
+   *     <td class="indexvalue">cancellation_token::current()</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Checked once per row of the spectra, if it is cancelled the algorithm returns false.</td>
+   *   </tr>
    * </table>
    * @param statistics <table border="0" width="100%">
    *   <tr>
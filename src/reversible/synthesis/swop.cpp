@@ -20,6 +20,8 @@
 #include <boost/range/algorithm.hpp>
 #include <boost/range/irange.hpp>
 
+#include <core/utils/cancellation_token.hpp>
+
 #include "transformation_based_synthesis.hpp"
 
 namespace revkit
@@ -34,6 +36,7 @@ namespace revkit
     truth_table_synthesis_func synth = get<truth_table_synthesis_func>( settings, "synthesis", transformation_based_synthesis_func() );
     cost_function cf = get<cost_function>( settings, "cost_function", costs_by_circuit_func( gate_costs() ) );
     swop_step_func stepfunc = get<boost::function<void()> >( settings, "stepfunc", swop_step_func() );
+    cancellation_token token = get( settings, "cancellation_token", cancellation_token::current() );
 
     timer<properties_timer> t;
 
@@ -52,6 +55,12 @@ namespace revkit
     {
       do
       {
+        if ( token.is_cancelled() )
+        {
+          set_error_message( statistics, "synthesis was cancelled." );
+          return false;
+        }
+
         circuit tmp;
         bool r = synth( tmp, spec2 );
         if ( r && ( !circ.num_gates() || costs( tmp, cf ) < costs( circ, cf ) ) )
@@ -86,6 +95,12 @@ namespace revkit
 
           do
           {
+            if ( token.is_cancelled() )
+            {
+              set_error_message( statistics, "synthesis was cancelled." );
+              return false;
+            }
+
             circuit tmp;
             spec2.set_permutation( perm );
             bool r = synth( tmp, spec2 );
@@ -140,7 +155,7 @@ namespace revkit
 
   truth_table_synthesis_func swop_func( properties::ptr settings, properties::ptr statistics )
   {
-    truth_table_synthesis_func f = [&settings, &statistics]( circuit& circ, const binary_truth_table& spec ) {
+    truth_table_synthesis_func f = [settings, statistics]( circuit& circ, const binary_truth_table& spec ) {
       return swop( circ, spec, settings, statistics );
     };
     f.init( settings, statistics );
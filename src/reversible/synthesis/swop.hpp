@@ -126,6 +126,14 @@ namespace revkit
    *   <tr>
    *     <td colspan="2" class="indexvalue">This functor is called after each iteration.</td>
    *   </tr>
+   *   <tr>
+   *     <td rowspan="2" class="indexvalue">cancellation_token</td>
+   *     <td class="indexvalue">\ref revkit::cancellation_token "cancellation_token"</td>
+   *     <td class="indexvalue">cancellation_token::current()</td>
+   *   </tr>
+   *   <tr>
+   *     <td colspan="2" class="indexvalue">Checked before each call of \em synthesis, if it is cancelled the algorithm returns false.</td>
+   *   </tr>
    * </table>
    * @param statistics <table border="0" width="100%">
    *   <tr>
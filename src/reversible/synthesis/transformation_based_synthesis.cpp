@@ -17,6 +17,7 @@
 
 #include "transformation_based_synthesis.hpp"
 
+#include <core/utils/cancellation_token.hpp>
 #include <core/utils/timer.hpp>
 #include <reversible/circuit.hpp>
 #include <reversible/functions/add_gates.hpp>
@@ -219,6 +220,7 @@ namespace revkit
   {
     /* Settings */
     bool bidirectional = get( settings, "bidirectional", true );
+    cancellation_token token = get( settings, "cancellation_token", cancellation_token::current() );
 
     timer<properties_timer> t;
 
@@ -262,6 +264,12 @@ namespace revkit
 
     for ( unsigned i = start_index; i < output_values.size(); ++i )
     {
+      if ( token.is_cancelled() )
+      {
+        set_error_message( statistics, "synthesis was cancelled." );
+        return false;
+      }
+
       if ( i == output_values.at( i ) )
       {
         continue;
@@ -292,7 +300,7 @@ namespace revkit
   truth_table_synthesis_func transformation_based_synthesis_func( properties::ptr settings,
                                                                   properties::ptr statistics )
   {
-    truth_table_synthesis_func f = [&settings, &statistics]( circuit& circ, const binary_truth_table& spec ) {
+    truth_table_synthesis_func f = [settings, statistics]( circuit& circ, const binary_truth_table& spec ) {
       return transformation_based_synthesis( circ, spec, settings, statistics );
     };
     f.init( settings, statistics );
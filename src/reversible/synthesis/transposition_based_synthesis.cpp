@@ -28,6 +28,7 @@
 #include <boost/dynamic_bitset.hpp>
 
 #include <core/functor.hpp>
+#include <core/utils/cancellation_token.hpp>
 #include <core/utils/timer.hpp>
 
 #include <reversible/circuit.hpp>
@@ -50,6 +51,8 @@ namespace revkit
       properties::ptr settings, properties::ptr statistics )
   {
     // Settings parsing
+    cancellation_token token = get( settings, "cancellation_token", cancellation_token::current() );
+
     // Run-time measuring
     timer<properties_timer> t;
 
@@ -78,6 +81,12 @@ namespace revkit
 
     while ( !values_map.empty() )
     {
+      if ( token.is_cancelled() )
+      {
+        set_error_message( statistics, "synthesis was cancelled." );
+        return false;
+      }
+
       unsigned start_value = values_map.begin()->first; // first key in values_map
 
       std::vector<unsigned> cycle;
@@ -123,6 +132,12 @@ namespace revkit
     // TODO create transpositions function
     for ( auto& cycle : cycles )
     {
+      if ( token.is_cancelled() )
+      {
+        set_error_message( statistics, "synthesis was cancelled." );
+        return false;
+      }
+
       for ( unsigned i = 0u; i < cycle.size() - 1; ++i )
       {
         circuit transposition_circ( spec.num_inputs() );
@@ -144,7 +159,7 @@ namespace revkit
 
   truth_table_synthesis_func transposition_based_synthesis_func( properties::ptr settings, properties::ptr statistics )
   {
-    truth_table_synthesis_func f = [&settings, &statistics]( circuit& circ, const binary_truth_table& spec ) {
+    truth_table_synthesis_func f = [settings, statistics]( circuit& circ, const binary_truth_table& spec ) {
       return transposition_based_synthesis( circ, spec, settings, statistics );
     };
     f.init( settings, statistics );
@@ -27,6 +27,7 @@
 #include <boost/range/algorithm_ext/push_back.hpp>
 #include <boost/range/irange.hpp>
 
+#include <core/utils/cancellation_token.hpp>
 #include <core/utils/timer.hpp>
 
 #include <reversible/circuit.hpp>
@@ -271,6 +272,7 @@ bool young_subgroup_synthesis(circuit& circ, const binary_truth_table& spec, pro
   bool                            verbose  = get( settings, "verbose",  false                             );
   std::vector<unsigned>           ordering = get( settings, "ordering", std::vector<unsigned>()           );
   dd_based_esop_optimization_func esopmin  = get( settings, "esopmin",  dd_based_esop_optimization_func() );
+  cancellation_token              token    = get( settings, "cancellation_token", cancellation_token::current() );
 
   timer<properties_timer> t;
 
@@ -306,6 +308,12 @@ bool young_subgroup_synthesis(circuit& circ, const binary_truth_table& spec, pro
 
   for ( auto i : ordering )
   {
+    if ( token.is_cancelled() )
+    {
+      set_error_message( statistics, "synthesis was cancelled." );
+      return false;
+    }
+
     mgr.add_gates_for_line( i );
   }
 
@@ -314,7 +322,7 @@ bool young_subgroup_synthesis(circuit& circ, const binary_truth_table& spec, pro
 
 truth_table_synthesis_func young_subgroup_synthesis_func(properties::ptr settings, properties::ptr statistics)
 {
-  truth_table_synthesis_func f = [&settings, &statistics]( circuit& circ, const binary_truth_table& spec ) {
+  truth_table_synthesis_func f = [settings, statistics]( circuit& circ, const binary_truth_table& spec ) {
     return young_subgroup_synthesis( circ, spec, settings, statistics );
   };
   f.init( settings, statistics );
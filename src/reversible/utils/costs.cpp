@@ -17,6 +17,9 @@
 
 #include "costs.hpp"
 
+#include <map>
+
+#include <boost/iterator/function_output_iterator.hpp>
 #include <boost/range/algorithm.hpp>
 
 #include "../target_tags.hpp"
@@ -69,13 +72,23 @@ namespace revkit
 
     cost_t operator()( const costs_by_gate_func& f ) const
     {
+      // costs of each module are computed once
+      std::map<const circuit*, cost_t> module_costs;
+
       cost_t sum = 0ull;
       for ( const auto& g : circ )
       {
         // respect modules
         if ( is_module( g ) )
         {
-          sum += costs( *boost::any_cast<module_tag>( g.type() ).reference.get(), f );
+          const circuit* module = boost::any_cast<module_tag>( &g.type() )->reference.get();
+
+          auto it = module_costs.find( module );
+          if ( it == module_costs.end() )
+          {
+            it = module_costs.insert( std::make_pair( module, costs( *module, f ) ) ).first;
+          }
+          sum += it->second;
         }
         else
         {
@@ -94,6 +107,164 @@ namespace revkit
     return boost::apply_visitor( costs_visitor( circ ), f );
   }
 
+  class incremental_costs::priv
+  {
+  public:
+    struct entry
+    {
+      entry() : f( 0ull ), quantum( 0ull ), transistor( 0ull ) {}
+
+      entry& operator+=( const entry& other )
+      {
+        f += other.f; quantum += other.quantum; transistor += other.transistor;
+        return *this;
+      }
+
+      entry& operator-=( const entry& other )
+      {
+        f -= other.f; quantum -= other.quantum; transistor -= other.transistor;
+        return *this;
+      }
+
+      cost_t f;
+      cost_t quantum;
+      cost_t transistor;
+    };
+
+    priv( const circuit& circ, const cost_function& f )
+      : circ( circ ),
+        f( f )
+    {
+      if ( const costs_by_gate_func* gf = boost::get<costs_by_gate_func>( &f ) )
+      {
+        gate_f = *gf;
+      }
+      else if ( boost::get<costs_by_circuit_func>( f ).target<gate_costs>() )
+      {
+        gate_f = []( const gate&, unsigned ) { return 1ull; };
+      }
+
+      for ( const auto& p : circ.modules() )
+      {
+        module_costs.insert( std::make_pair( p.second.get(), module_entry( *p.second ) ) );
+      }
+    }
+
+    entry module_entry( const circuit& module ) const
+    {
+      entry e;
+      e.f          = gate_f ? costs( module, f ) : 0ull;
+      e.quantum    = costs( module, costs_by_gate_func( sk2013_quantum_costs() ) );
+      e.transistor = costs( module, costs_by_gate_func( transistor_costs() ) );
+      return e;
+    }
+
+    /* evaluates a contiguous range of gates, dispatches the cost function once per batch */
+    template<typename OutputIterator>
+    entry evaluate_batch( circuit::const_iterator first, circuit::const_iterator last, unsigned lines, OutputIterator out ) const
+    {
+      sk2013_quantum_costs qc;
+      transistor_costs tc;
+
+      entry sum;
+      for ( ; first != last; ++first )
+      {
+        entry e;
+        if ( is_module( *first ) )
+        {
+          const circuit* module = boost::any_cast<module_tag>( &first->type() )->reference.get();
+          auto it = module_costs.find( module );
+          e = it == module_costs.end() ? module_entry( *module ) : it->second;
+        }
+        else
+        {
+          e.f          = gate_f ? gate_f( *first, lines ) : 0ull;
+          e.quantum    = qc( *first, lines );
+          e.transistor = tc( *first, lines );
+        }
+
+        sum += e;
+        *out++ = e;
+      }
+      return sum;
+    }
+
+    const circuit& circ;
+    cost_function f;
+    costs_by_gate_func gate_f;
+
+    std::map<const circuit*, entry> module_costs;
+    std::vector<entry> gates;
+    entry totals;
+  };
+
+  incremental_costs::incremental_costs( const circuit& circ, const cost_function& f )
+    : d( new priv( circ, f ) )
+  {
+    d->gates.reserve( circ.num_gates() );
+    d->totals = d->evaluate_batch( circ.begin(), circ.end(), circ.lines(), std::back_inserter( d->gates ) );
+  }
+
+  incremental_costs::~incremental_costs()
+  {
+    delete d;
+  }
+
+  cost_t incremental_costs::total() const
+  {
+    return d->gate_f ? d->totals.f : costs( d->circ, d->f );
+  }
+
+  cost_t incremental_costs::quantum_total() const
+  {
+    return d->totals.quantum;
+  }
+
+  cost_t incremental_costs::transistor_total() const
+  {
+    return d->totals.transistor;
+  }
+
+  cost_t incremental_costs::range( unsigned from, unsigned to ) const
+  {
+    if ( !d->gate_f )
+    {
+      return costs( subcircuit( d->circ, from, to ), d->f );
+    }
+
+    cost_t sum = 0ull;
+    for ( unsigned i = from; i < to; ++i )
+    {
+      sum += d->gates[i].f;
+    }
+    return sum;
+  }
+
+  cost_t incremental_costs::evaluate( const circuit& window ) const
+  {
+    if ( !d->gate_f )
+    {
+      return costs( window, d->f );
+    }
+
+    return d->evaluate_batch( window.begin(), window.end(), window.lines(), boost::make_function_output_iterator( []( const priv::entry& ) {} ) ).f;
+  }
+
+  void incremental_costs::replace( unsigned from, unsigned to, const circuit& window )
+  {
+    for ( unsigned i = from; i < to; ++i )
+    {
+      d->totals -= d->gates[i];
+    }
+
+    std::vector<priv::entry> entries;
+    entries.reserve( window.num_gates() );
+    d->totals += d->evaluate_batch( window.begin(), window.end(), d->circ.lines(), std::back_inserter( entries ) );
+
+    d->gates.erase( d->gates.begin() + from, d->gates.begin() + to );
+    d->gates.insert( d->gates.begin() + from, entries.begin(), entries.end() );
+  }
+
 }
 
 // Local Variables:
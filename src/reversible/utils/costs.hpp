@@ -178,6 +178,106 @@ namespace revkit
    */
   cost_t costs( const circuit& circ, const cost_function& f );
 
+  /**
+   * @brief Costs of a circuit which are updated when gates are replaced
+   *
+   * The costs of each gate with respect to a cost function as well as its
+   * \ref revkit::sk2013_quantum_costs "quantum costs" and \ref revkit::transistor_costs "transistor costs"
+   * are evaluated once and cached together with the costs of each module.  When
+   * a range of gates is replaced in the circuit, replace() updates the cached
+   * costs and the totals in time linear in the size of the range.  The totals
+   * are available in constant time.
+   *
+   * The per-gate costs are exact for a costs_by_gate_func and for \ref revkit::gate_costs "gate_costs".
+   * Other costs_by_circuit_func cost functions cannot be split among the gates,
+   * and are evaluated on the circuit whenever their costs are requested.
+   *
+   * @since  2.0
+   */
+  class incremental_costs
+  {
+  public:
+    /**
+     * @brief Evaluates the costs of all gates
+     *
+     * @param circ Circuit which has to outlive this object
+     * @param f Cost function
+     *
+     * @since  2.0
+     */
+    incremental_costs( const circuit& circ, const cost_function& f );
+
+    /**
+     * @brief Deletes the cached costs
+     *
+     * @since  2.0
+     */
+    ~incremental_costs();
+
+    /**
+     * @brief Costs of the circuit with respect to the cost function
+     *
+     * @since  2.0
+     */
+    cost_t total() const;
+
+    /**
+     * @brief Quantum costs of the circuit according to sk2013_quantum_costs
+     *
+     * @since  2.0
+     */
+    cost_t quantum_total() const;
+
+    /**
+     * @brief Transistor costs of the circuit according to transistor_costs
+     *
+     * @since  2.0
+     */
+    cost_t transistor_total() const;
+
+    /**
+     * @brief Costs of the gates [\p from, \p to) with respect to the cost function
+     *
+     * @since  2.0
+     */
+    cost_t range( unsigned from, unsigned to ) const;
+
+    /**
+     * @brief Costs of another circuit with respect to the cost function
+     *
+     * Same as \ref revkit::costs "costs", but uses the cached costs of modules.
+     * Can be called concurrently.
+     *
+     * @param window Circuit, e.g. a window of the circuit
+     *
+     * @return Costs of \p window
+     *
+     * @since  2.0
+     */
+    cost_t evaluate( const circuit& window ) const;
+
+    /**
+     * @brief Updates the costs after gates have been replaced in the circuit
+     *
+     * Call after the gates [\p from, \p to) have been replaced by the gates
+     * of \p window in the circuit.
+     *
+     * @param from First replaced gate
+     * @param to First gate after the replaced gates
+     * @param window Circuit with the gates that have been inserted at \p from
+     *
+     * @since  2.0
+     */
+    void replace( unsigned from, unsigned to, const circuit& window );
+
+  private:
+    incremental_costs( const incremental_costs& ) = delete;
+    incremental_costs& operator=( const incremental_costs& ) = delete;
+
+    class priv;
+    priv* const d;
+  };
+
 }
 
 #endif /* COSTS_HPP */
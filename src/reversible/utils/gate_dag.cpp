@@ -0,0 +1,304 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gate_dag.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <set>
+
+namespace revkit
+{
+
+  const unsigned gate_dag::none;
+
+  class gate_dag::priv
+  {
+  public:
+    /* nodes are ordered by their position, gate i has position 2i+1,
+       a key with the raw_position bit set is a position itself */
+    struct by_position
+    {
+      explicit by_position( const std::vector<unsigned>* position ) : position( position ) {}
+
+      unsigned key( unsigned a ) const
+      {
+        return ( a & raw_position ) ? ( a & ~raw_position ) : ( *position )[a];
+      }
+
+      bool operator()( unsigned a, unsigned b ) const
+      {
+        return key( a ) < key( b );
+      }
+
+      static const unsigned raw_position = 1u << 31u;
+
+      const std::vector<unsigned>* position;
+    };
+
+    typedef std::set<unsigned, by_position> line_set;
+
+    explicit priv( unsigned lines )
+    {
+      for ( unsigned i = 0u; i < lines; ++i )
+      {
+        line_gates.push_back( line_set( by_position( &position ) ) );
+      }
+    }
+
+    unsigned index( unsigned node ) const
+    {
+      return position[node] >> 1u;
+    }
+
+    /* first node on line with index >= i, position 2i sorts before gate i */
+    line_set::const_iterator lower_bound( unsigned line, unsigned i ) const
+    {
+      return line_gates[line].lower_bound( by_position::raw_position | ( 2u * i ) );
+    }
+
+    const line_set::iterator* find_entry( unsigned node, unsigned line ) const
+    {
+      for ( const auto& e : entries[node] )
+      {
+        if ( e.first == line ) return &e.second;
+      }
+      return 0;
+    }
+
+    void add_lines( unsigned node, const gate& g )
+    {
+      std::vector<unsigned> ls;
+      for ( const auto& v : g.controls() )
+      {
+        ls.push_back( v.line() );
+      }
+      for ( unsigned l : g.targets() )
+      {
+        ls.push_back( l );
+      }
+
+      for ( unsigned l : ls )
+      {
+        assert( l < line_gates.size() );
+        if ( find_entry( node, l ) ) continue;
+        entries[node].push_back( std::make_pair( l, line_gates[l].insert( node ).first ) );
+      }
+    }
+
+    void remove_lines( unsigned node )
+    {
+      for ( const auto& e : entries[node] )
+      {
+        line_gates[e.first].erase( e.second );
+      }
+      entries[node].clear();
+    }
+
+    /* position of each node */
+    std::vector<unsigned> position;
+
+    /* node of each gate */
+    std::vector<unsigned> order;
+
+    /* lines of each node with the position in the line set */
+    std::vector<std::vector<std::pair<unsigned, line_set::iterator> > > entries;
+
+    std::vector<line_set> line_gates;
+    std::vector<unsigned> free_nodes;
+  };
+
+  const unsigned gate_dag::priv::by_position::raw_position;
+
+  gate_dag::gate_dag( const circuit& circ )
+    : d( new priv( circ.lines() ) )
+  {
+    for ( const auto& g : circ )
+    {
+      insert( d->order.size(), g );
+    }
+  }
+
+  gate_dag::~gate_dag()
+  {
+    delete d;
+  }
+
+  unsigned gate_dag::lines() const
+  {
+    return d->line_gates.size();
+  }
+
+  unsigned gate_dag::num_gates() const
+  {
+    return d->order.size();
+  }
+
+  void gate_dag::add_line()
+  {
+    d->line_gates.push_back( priv::line_set( priv::by_position( &d->position ) ) );
+  }
+
+  unsigned gate_dag::first( unsigned line ) const
+  {
+    const priv::line_set& s = d->line_gates.at( line );
+    return s.empty() ? none : d->index( *s.begin() );
+  }
+
+  unsigned gate_dag::last( unsigned line ) const
+  {
+    const priv::line_set& s = d->line_gates.at( line );
+    return s.empty() ? none : d->index( *s.rbegin() );
+  }
+
+  unsigned gate_dag::previous( unsigned index, unsigned line ) const
+  {
+    const priv::line_set& s = d->line_gates.at( line );
+
+    priv::line_set::const_iterator it;
+    const priv::line_set::iterator* e = index < d->order.size() ? d->find_entry( d->order[index], line ) : 0;
+    if ( e )
+    {
+      it = *e;
+    }
+    else
+    {
+      it = d->lower_bound( line, index );
+    }
+
+    return it == s.begin() ? none : d->index( *--it );
+  }
+
+  unsigned gate_dag::next( unsigned index, unsigned line ) const
+  {
+    const priv::line_set& s = d->line_gates.at( line );
+
+    priv::line_set::const_iterator it;
+    const priv::line_set::iterator* e = index < d->order.size() ? d->find_entry( d->order[index], line ) : 0;
+    if ( e )
+    {
+      it = *e;
+      ++it;
+    }
+    else
+    {
+      it = d->lower_bound( line, index + 1u );
+    }
+
+    return it == s.end() ? none : d->index( *it );
+  }
+
+  void gate_dag::non_empty_lines( unsigned from, unsigned to, std::vector<unsigned>& lines ) const
+  {
+    lines.clear();
+    if ( from >= to ) return;
+
+    for ( unsigned l = 0u; l < d->line_gates.size(); ++l )
+    {
+      priv::line_set::const_iterator it = d->lower_bound( l, from );
+      if ( it != d->line_gates[l].end() && d->index( *it ) < to )
+      {
+        lines.push_back( l );
+      }
+    }
+  }
+
+  void gate_dag::insert( unsigned index, const gate& g )
+  {
+    assert( index <= d->order.size() );
+
+    unsigned node;
+    if ( d->free_nodes.empty() )
+    {
+      node = d->position.size();
+      d->position.push_back( 0u );
+      d->entries.resize( node + 1u );
+    }
+    else
+    {
+      node = d->free_nodes.back();
+      d->free_nodes.pop_back();
+    }
+
+    /* shifting all following gates keeps their relative order in the line sets */
+    for ( unsigned i = index; i < d->order.size(); ++i )
+    {
+      d->position[d->order[i]] += 2u;
+    }
+
+    d->order.insert( d->order.begin() + index, node );
+    d->position[node] = 2u * index + 1u;
+    d->add_lines( node, g );
+  }
+
+  void gate_dag::remove( unsigned index )
+  {
+    assert( index < d->order.size() );
+
+    unsigned node = d->order[index];
+    d->remove_lines( node );
+    d->free_nodes.push_back( node );
+
+    d->order.erase( d->order.begin() + index );
+    for ( unsigned i = index; i < d->order.size(); ++i )
+    {
+      d->position[d->order[i]] -= 2u;
+    }
+  }
+
+  void gate_dag::update( unsigned index, const gate& g )
+  {
+    assert( index < d->order.size() );
+
+    unsigned node = d->order[index];
+    d->remove_lines( node );
+    d->add_lines( node, g );
+  }
+
+  unsigned gate_dag::levels( std::vector<unsigned>& levels ) const
+  {
+    /* number of levels up to the last gate on each line */
+    std::vector<unsigned> line_levels( d->line_gates.size(), 0u );
+    unsigned depth = 0u;
+
+    levels.resize( d->order.size() );
+    for ( unsigned i = 0u; i < d->order.size(); ++i )
+    {
+      unsigned level = 0u;
+      for ( const auto& e : d->entries[d->order[i]] )
+      {
+        level = std::max( level, line_levels[e.first] );
+      }
+
+      levels[i] = level;
+      for ( const auto& e : d->entries[d->order[i]] )
+      {
+        line_levels[e.first] = level + 1u;
+      }
+      depth = std::max( depth, level + 1u );
+    }
+
+    return depth;
+  }
+
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
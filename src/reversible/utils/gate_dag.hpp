@@ -0,0 +1,244 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file gate_dag.hpp
+ *
+ * @brief Per-line gate adjacency of a circuit
+ *
+ * @author Mathias Soeken
+ * @since  2.0
+ */
+
+#ifndef GATE_DAG_HPP
+#define GATE_DAG_HPP
+
+#include <vector>
+
+#include <reversible/circuit.hpp>
+
+namespace revkit
+{
+
+  /**
+   * @brief Dependency graph of the gates of a circuit
+   *
+   * For every line the gates which have a control or
+   * target on it are kept in circuit order, such that the
+   * previous and the next gate on a line can be queried
+   * without scanning the gates in between.  Gates are
+   * addressed by their index in the circuit.
+   *
+   * The graph does not observe the circuit, it has to be
+   * updated with insert() and remove() when gates are
+   * inserted into or removed from the circuit, and with
+   * update() when the lines of a gate change.
+   *
+   * Queries do not modify the graph, hence they can be
+   * run concurrently as long as the graph is not updated.
+   *
+   * @section sec_example_gate_dag Example
+   * @code
+   * revkit::gate_dag dag( circ );
+   * for ( unsigned i = dag.last( line ); i != revkit::gate_dag::none; i = dag.previous( i, line ) )
+   * {
+   *   ...
+   * }
+   * @endcode
+   *
+   * @since  2.0
+   */
+  class gate_dag
+  {
+  public:
+    /**
+     * @brief Returned if there is no such gate
+     *
+     * @since  2.0
+     */
+    static const unsigned none = ~0u;
+
+    /**
+     * @brief Creates the graph of a circuit
+     *
+     * @param circ Circuit
+     *
+     * @since  2.0
+     */
+    explicit gate_dag( const circuit& circ );
+
+    /**
+     * @brief Deletes the graph
+     *
+     * @since  2.0
+     */
+    ~gate_dag();
+
+    /**
+     * @brief Number of lines
+     *
+     * @since  2.0
+     */
+    unsigned lines() const;
+
+    /**
+     * @brief Number of gates
+     *
+     * @since  2.0
+     */
+    unsigned num_gates() const;
+
+    /**
+     * @brief Adds an empty line to the end
+     *
+     * @since  2.0
+     */
+    void add_line();
+
+    /**
+     * @brief Index of the first gate on a line
+     *
+     * @param line Line
+     *
+     * @return Gate index or none, if the line is empty
+     *
+     * @since  2.0
+     */
+    unsigned first( unsigned line ) const;
+
+    /**
+     * @brief Index of the last gate on a line
+     *
+     * @param line Line
+     *
+     * @return Gate index or none, if the line is empty
+     *
+     * @since  2.0
+     */
+    unsigned last( unsigned line ) const;
+
+    /**
+     * @brief Last gate on a line before a position
+     *
+     * If the gate at \p index is on \p line, this is a constant
+     * time operation, otherwise it is logarithmic in the
+     * number of gates on \p line.
+     *
+     * @param index Gate index, may be num_gates()
+     * @param line Line
+     *
+     * @return Index of the last gate on \p line before \p index, or none
+     *
+     * @since  2.0
+     */
+    unsigned previous( unsigned index, unsigned line ) const;
+
+    /**
+     * @brief First gate on a line after a position
+     *
+     * If the gate at \p index is on \p line, this is a constant
+     * time operation, otherwise it is logarithmic in the
+     * number of gates on \p line.
+     *
+     * @param index Gate index
+     * @param line Line
+     *
+     * @return Index of the first gate on \p line after \p index, or none
+     *
+     * @since  2.0
+     */
+    unsigned next( unsigned index, unsigned line ) const;
+
+    /**
+     * @brief Lines of the gates in a range
+     *
+     * Logarithmic in the number of gates for each line of the circuit,
+     * independent of the length of the range.
+     *
+     * @param from First gate index (inclusive)
+     * @param to Last gate index (exclusive)
+     * @param lines Sorted lines which are control or target line of at least one gate in the range
+     *
+     * @since  2.0
+     */
+    void non_empty_lines( unsigned from, unsigned to, std::vector<unsigned>& lines ) const;
+
+    /**
+     * @brief Inserts a gate
+     *
+     * The indexes of the gates from \p index on are incremented.
+     *
+     * @param index Position of the new gate
+     * @param g Gate
+     *
+     * @since  2.0
+     */
+    void insert( unsigned index, const gate& g );
+
+    /**
+     * @brief Removes a gate
+     *
+     * The indexes of the gates after \p index are decremented.
+     *
+     * @param index Position of the gate
+     *
+     * @since  2.0
+     */
+    void remove( unsigned index );
+
+    /**
+     * @brief Updates the lines of a gate
+     *
+     * @param index Position of the gate
+     * @param g Gate with the new lines
+     *
+     * @since  2.0
+     */
+    void update( unsigned index, const gate& g );
+
+    /**
+     * @brief Topological levels
+     *
+     * Gates on level 0 have no predecessor, all other gates have
+     * a predecessor on the level before.  Gates on the same level
+     * have disjoint lines.
+     *
+     * @param levels Level of each gate
+     *
+     * @return Number of levels, i.e. the depth of the circuit
+     *
+     * @since  2.0
+     */
+    unsigned levels( std::vector<unsigned>& levels ) const;
+
+  private:
+    gate_dag( const gate_dag& ) = delete;
+    gate_dag& operator=( const gate_dag& ) = delete;
+
+    class priv;
+    priv* const d;
+  };
+
+}
+
+#endif /* GATE_DAG_HPP */
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
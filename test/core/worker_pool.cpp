@@ -0,0 +1,97 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE worker_pool
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include <core/utils/worker_pool.hpp>
+
+using namespace revkit;
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  worker_pool pool;
+
+  /* finished job */
+  auto value = std::make_shared<unsigned>( 0u );
+  BOOST_CHECK( pool.run( [value]( const cancellation_token& ) { *value = 42u; } ) );
+  BOOST_CHECK_EQUAL( *value, 42u );
+
+  /* job which only stops when cancelled */
+  auto stopped = std::make_shared<std::atomic<bool> >( false );
+  BOOST_CHECK( !pool.run( [stopped]( const cancellation_token& token ) {
+        while ( !token.is_cancelled() ) {}
+        *stopped = true;
+      }, 50u ) );
+
+  /* the worker is available again after the abandoned job noticed the cancellation */
+  BOOST_CHECK( pool.run( [value]( const cancellation_token& ) { *value = 7u; }, 10000u ) );
+  BOOST_CHECK( *stopped );
+  BOOST_CHECK_EQUAL( *value, 7u );
+}
+
+BOOST_AUTO_TEST_CASE(exception)
+{
+  worker_pool pool;
+
+  /* the exception is thrown in the waiting thread, with and without time-out */
+  BOOST_CHECK_THROW( pool.run( []( const cancellation_token& ) { throw std::runtime_error( "job failed" ); } ), std::runtime_error );
+  BOOST_CHECK_THROW( pool.run( []( const cancellation_token& ) { throw std::runtime_error( "job failed" ); }, 10000u ), std::runtime_error );
+
+  /* the worker survived */
+  auto value = std::make_shared<unsigned>( 0u );
+  BOOST_CHECK( pool.run( [value]( const cancellation_token& ) { *value = 42u; }, 10000u ) );
+  BOOST_CHECK_EQUAL( *value, 42u );
+}
+
+BOOST_AUTO_TEST_CASE(abandoned)
+{
+  auto release = std::make_shared<std::atomic<bool> >( false );
+  auto value = std::make_shared<unsigned>( 0u );
+
+  {
+    worker_pool pool;
+
+    /* job which does not check its token */
+    BOOST_CHECK( !pool.run( [release]( const cancellation_token& ) {
+          while ( !*release ) { std::this_thread::yield(); }
+        }, 20u ) );
+
+    /* the next job does not wait for it and finds its token on the thread */
+    BOOST_CHECK( pool.run( [value]( const cancellation_token& ) {
+          *value = cancellation_token::current().has_timeout() ? 1u : 2u;
+        }, 10000u ) );
+    BOOST_CHECK_EQUAL( *value, 1u );
+  }
+
+  /* the pool was destroyed without waiting for the abandoned job */
+  BOOST_CHECK( !*release );
+  *release = true;
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
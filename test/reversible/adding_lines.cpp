@@ -0,0 +1,109 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE adding_lines
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/optimization/adding_lines.hpp>
+#include <reversible/utils/costs.hpp>
+
+BOOST_AUTO_TEST_CASE(large_factor)
+{
+  using namespace revkit;
+
+  /* three gates with the same 12 controls and a gate which does not share them */
+  gate::control_container controls;
+  for ( unsigned l = 0u; l < 12u; ++l )
+  {
+    controls.push_back( make_var( l ) );
+  }
+
+  circuit base( 15u );
+  append_toffoli( base, controls, 12u );
+  append_cnot( base, 0u, 14u );
+  append_toffoli( base, controls, 13u );
+  append_toffoli( base, controls, 14u );
+
+  circuit circ;
+  BOOST_CHECK( adding_lines( circ, base ) );
+
+  /* the factor is computed once on the helper line, which is not uncomputed in the end */
+  BOOST_REQUIRE_EQUAL( circ.lines(), 16u );
+  BOOST_REQUIRE_EQUAL( circ.num_gates(), 5u );
+  BOOST_CHECK_EQUAL( circ[0u].controls().size(), 12u );
+  BOOST_CHECK_EQUAL( circ[0u].targets().front(), 15u );
+  BOOST_CHECK_EQUAL( circ[1u].controls().size(), 1u );
+  BOOST_CHECK_EQUAL( circ[3u].controls().size(), 1u );
+  BOOST_CHECK_EQUAL( circ[4u].controls().size(), 1u );
+  BOOST_CHECK_LT( costs( circ, costs_by_gate_func( transistor_costs() ) ), costs( base, costs_by_gate_func( transistor_costs() ) ) );
+}
+
+BOOST_AUTO_TEST_CASE(single_gate_quantum_costs)
+{
+  using namespace revkit;
+
+  gate::control_container controls;
+  for ( unsigned l = 0u; l < 6u; ++l )
+  {
+    controls.push_back( make_var( l ) );
+  }
+
+  circuit base( 7u );
+  append_toffoli( base, controls, 6u );
+
+  /* splitting the controls of a single gate does not save transistors */
+  circuit circ;
+  BOOST_CHECK( adding_lines( circ, base ) );
+  BOOST_CHECK_EQUAL( circ.num_gates(), 1u );
+
+  /* but quantum costs, since they grow quadratically in the number of controls */
+  cost_function cf = costs_by_gate_func( sk2013_quantum_costs() );
+  properties::ptr settings( new properties() );
+  settings->set( "cost_function", cf );
+
+  circuit circ2;
+  BOOST_CHECK( adding_lines( circ2, base, settings ) );
+  BOOST_CHECK_EQUAL( circ2.lines(), 8u );
+  BOOST_CHECK_EQUAL( circ2.num_gates(), 2u );
+  BOOST_CHECK_LT( costs( circ2, cf ), costs( base, cf ) );
+}
+
+BOOST_AUTO_TEST_CASE(functor)
+{
+  using namespace revkit;
+
+  circuit base( 3u );
+  append_toffoli( base )( 0u, 1u )( 2u );
+
+  /* settings and statistics are owned by the functor */
+  optimization_func optimizer = adding_lines_func();
+
+  circuit circ;
+  BOOST_CHECK( optimizer( circ, base ) );
+  BOOST_CHECK_EQUAL( circ.num_gates(), 1u );
+  BOOST_CHECK_GE( optimizer.statistics()->get<double>( "runtime" ), 0.0 );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
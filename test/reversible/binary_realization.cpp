@@ -0,0 +1,87 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE binary_realization
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/target_tags.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/io/read_binary_realization.hpp>
+#include <reversible/io/write_binary_realization.hpp>
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+  using namespace revkit;
+
+  circuit module( 2u );
+  append_cnot( module, 0u, 1u );
+
+  circuit circ( 4u );
+  circ.set_circuit_name( "test" );
+  circ.set_inputs( std::vector<std::string>( { "a", "b", "0", "d" } ) );
+  circ.set_outputs( std::vector<std::string>( { "a", "f", "g", "d" } ) );
+  circ.set_constants( std::vector<constant>( { constant(), constant(), false, constant() } ) );
+  circ.set_garbage( std::vector<bool>( { true, false, false, true } ) );
+  circ.add_module( "swap", module );
+
+  append_toffoli( circ )( make_var( 0u ), make_var( 3u, false ) )( 2u );
+  append_fredkin( circ )( 0u )( 1u, 2u );
+  append_module( circ, "swap", gate::control_container( 1u, make_var( 3u ) ), gate::target_container( { 1u, 2u } ) );
+  circ.annotate( circ[0u], "cost", "5" );
+  circ.annotate( circ[2u], "comment", "module gate" );
+
+  std::string error;
+  BOOST_REQUIRE( write_binary_realization( circ, "/tmp/test.realb", &error ) );
+
+  circuit circ2;
+  BOOST_REQUIRE( read_binary_realization( circ2, "/tmp/test.realb", &error ) );
+
+  BOOST_CHECK_EQUAL( circ2.circuit_name(), "test" );
+  BOOST_CHECK( circ2.inputs() == circ.inputs() );
+  BOOST_CHECK( circ2.outputs() == circ.outputs() );
+  BOOST_CHECK( circ2.constants() == circ.constants() );
+  BOOST_CHECK( circ2.garbage() == circ.garbage() );
+
+  BOOST_REQUIRE_EQUAL( circ2.num_gates(), 3u );
+  for ( unsigned i = 0u; i < circ.num_gates(); ++i )
+  {
+    BOOST_CHECK( circ2[i].controls() == circ[i].controls() );
+    BOOST_CHECK( circ2[i].targets() == circ[i].targets() );
+  }
+  BOOST_CHECK( is_toffoli( circ2[0u] ) );
+  BOOST_CHECK( is_fredkin( circ2[1u] ) );
+
+  BOOST_REQUIRE( is_module( circ2[2u] ) );
+  const module_tag* tag = boost::any_cast<module_tag>( &circ2[2u].type() );
+  BOOST_CHECK_EQUAL( tag->name, "swap" );
+  BOOST_REQUIRE_EQUAL( circ2.modules().count( "swap" ), 1u );
+  BOOST_CHECK_EQUAL( circ2.modules().find( "swap" )->second->num_gates(), 1u );
+  BOOST_CHECK_EQUAL( tag->reference.get(), circ2.modules().find( "swap" )->second.get() );
+
+  BOOST_CHECK_EQUAL( circ2.annotation( circ2[0u], "cost" ), "5" );
+  BOOST_CHECK_EQUAL( circ2.annotation( circ2[2u], "comment" ), "module gate" );
+  BOOST_CHECK( !circ2.annotations( circ2[1u] ) );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,123 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE compressed_io
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <core/io/compressed_stream.hpp>
+#include <reversible/circuit.hpp>
+#include <reversible/truth_table.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/io/read_pla.hpp>
+#include <reversible/io/read_realization.hpp>
+#include <reversible/io/write_realization.hpp>
+
+std::vector<std::string> extensions()
+{
+  std::vector<std::string> exts( 1u, ".gz" );
+  if ( revkit::is_compressed_filename( "test.zst" ) )
+  {
+    exts.push_back( ".zst" );
+  }
+  return exts;
+}
+
+/* cuts off the second half of a file */
+void truncate_file( const std::string& filename )
+{
+  boost::filesystem::resize_file( filename, boost::filesystem::file_size( filename ) / 2u );
+}
+
+BOOST_AUTO_TEST_CASE(realization)
+{
+  using namespace revkit;
+
+  circuit circ( 8u );
+  for ( unsigned i = 0u; i < 5000u; ++i )
+  {
+    append_toffoli( circ )( make_var( i % 8u ), make_var( ( i / 8u ) % 8u == i % 8u ? ( i + 1u ) % 8u : ( i / 8u ) % 8u, i % 3u != 0u ) )( ( i + 2u ) % 8u == i % 8u ? 7u : ( i * 5u + 2u ) % 8u );
+  }
+
+  for ( const auto& ext : extensions() )
+  {
+    std::string filename = "/tmp/test_compressed.real" + ext;
+    BOOST_REQUIRE( write_realization( circ, filename ) );
+
+    circuit circ2;
+    BOOST_REQUIRE( read_realization( circ2, filename ) );
+    BOOST_REQUIRE_EQUAL( circ2.num_gates(), circ.num_gates() );
+    for ( unsigned i = 0u; i < circ.num_gates(); ++i )
+    {
+      BOOST_CHECK( circ2[i].controls() == circ[i].controls() );
+      BOOST_CHECK( circ2[i].targets() == circ[i].targets() );
+    }
+
+    truncate_file( filename );
+
+    circuit circ3;
+    std::string error;
+    BOOST_CHECK( !read_realization( circ3, filename, read_realization_settings(), &error ) );
+    BOOST_CHECK( !error.empty() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pla)
+{
+  using namespace revkit;
+
+  for ( const auto& ext : extensions() )
+  {
+    std::string filename = "/tmp/test_compressed.pla" + ext;
+
+    {
+      compressed_ofstream os( filename );
+      os << ".i 10" << std::endl << ".o 1" << std::endl;
+      for ( unsigned i = 0u; i < 1024u; i += 3u )
+      {
+        for ( unsigned j = 0u; j < 10u; ++j )
+        {
+          os << ( ( i >> j ) & 1u );
+        }
+        os << " 1" << std::endl;
+      }
+      os << ".e" << std::endl;
+      BOOST_REQUIRE( os.close() );
+    }
+
+    read_pla_settings settings;
+    settings.extend = false;
+
+    binary_truth_table spec;
+    BOOST_REQUIRE( read_pla( spec, filename, settings ) );
+    BOOST_CHECK_EQUAL( spec.num_inputs(), 10u );
+    BOOST_CHECK_EQUAL( std::distance( spec.begin(), spec.end() ), 342 );
+
+    truncate_file( filename );
+
+    binary_truth_table spec2;
+    BOOST_CHECK( !read_pla( spec2, filename, settings ) );
+  }
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,110 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE create_image
+
+#include <sstream>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/io/create_image.hpp>
+
+using namespace revkit;
+
+/* counts the drawn blocks */
+struct counting_svg_settings : public create_svg_settings
+{
+  void draw_block( std::ostream& os, float x1, float y1, float x2, float y2, unsigned num_gates ) const
+  {
+    ++num_blocks;
+    block_gates += num_gates;
+    create_svg_settings::draw_block( os, x1, y1, x2, y2, num_gates );
+  }
+
+  mutable unsigned num_blocks = 0u;
+  mutable unsigned block_gates = 0u;
+};
+
+BOOST_AUTO_TEST_CASE(compact)
+{
+  circuit circ( 4u );
+  append_cnot( circ, 0u, 1u );
+  append_cnot( circ, 2u, 3u );
+  append_cnot( circ, 1u, 2u );
+
+  std::ostringstream os;
+  create_svg_settings settings;
+  create_image( os, circ, settings );
+  BOOST_CHECK_EQUAL( settings.width, settings.elem_width * 5 );
+
+  /* the first two gates share a column */
+  settings.compact = true;
+  create_image( os, circ, settings );
+  BOOST_CHECK_EQUAL( settings.width, settings.elem_width * 4 );
+}
+
+BOOST_AUTO_TEST_CASE(max_columns)
+{
+  circuit circ( 3u );
+  for ( unsigned i = 0u; i < 10u; ++i )
+  {
+    append_cnot( circ, i % 3u, ( i + 1u ) % 3u );
+  }
+
+  std::ostringstream os;
+  counting_svg_settings settings;
+  settings.max_columns = 3u;
+  create_image( os, circ, settings );
+
+  /* 4 columns per block */
+  BOOST_CHECK_EQUAL( settings.width, settings.elem_width * 5 );
+  BOOST_CHECK_EQUAL( settings.num_blocks, 3u );
+  BOOST_CHECK_EQUAL( settings.block_gates, 10u );
+}
+
+BOOST_AUTO_TEST_CASE(svg)
+{
+  circuit circ( 3u );
+  append_toffoli( circ )( make_var( 0u ), make_var( 1u, false ) )( 2u );
+  append_fredkin( circ, gate::control_container(), 0u, 1u );
+
+  std::ostringstream os;
+  os << 0.123456;
+  create_svg_settings settings;
+  create_image( os, circ, settings );
+  os << 0.123456;
+
+  std::string svg = os.str();
+  BOOST_CHECK( boost::starts_with( svg, "0.123456<svg " ) );
+  BOOST_CHECK( boost::ends_with( svg, "</svg>\n0.123456" ) );
+  BOOST_CHECK( svg.find( "<circle class=\"p\" cx=\"36.0\" cy=\"12.0\"" ) != std::string::npos );
+  BOOST_CHECK( svg.find( "<circle class=\"n\" cx=\"36.0\" cy=\"36.0\"" ) != std::string::npos );
+
+  /* format of the stream is restored */
+  BOOST_CHECK_EQUAL( os.precision(), 6 );
+  BOOST_CHECK( !( os.flags() & std::ios_base::fixed ) );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,156 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE gate_dag
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/utils/gate_dag.hpp>
+
+bool on_line( const revkit::gate& g, unsigned line )
+{
+  for ( const auto& v : g.controls() )
+  {
+    if ( v.line() == line ) return true;
+  }
+  return g.targets().front() == line;
+}
+
+void check_neighbors( const revkit::circuit& circ, const revkit::gate_dag& dag )
+{
+  using revkit::gate_dag;
+
+  BOOST_REQUIRE_EQUAL( dag.num_gates(), circ.num_gates() );
+
+  for ( unsigned l = 0u; l < circ.lines(); ++l )
+  {
+    unsigned prev = gate_dag::none;
+    for ( unsigned i = 0u; i < circ.num_gates(); ++i )
+    {
+      BOOST_CHECK_EQUAL( dag.previous( i, l ), prev );
+      if ( on_line( circ[i], l ) )
+      {
+        if ( prev != gate_dag::none )
+        {
+          BOOST_CHECK_EQUAL( dag.next( prev, l ), i );
+        }
+        else
+        {
+          BOOST_CHECK_EQUAL( dag.first( l ), i );
+        }
+        prev = i;
+      }
+    }
+    BOOST_CHECK_EQUAL( dag.last( l ), prev );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  using namespace revkit;
+
+  circuit circ( 3u );
+  append_toffoli( circ )( 0u, 1u )( 2u );
+  append_cnot( circ, 0u, 1u );
+  append_not( circ, 2u );
+
+  gate_dag dag( circ );
+  check_neighbors( circ, dag );
+
+  std::vector<unsigned> lines;
+  dag.non_empty_lines( 1u, 2u, lines );
+  BOOST_CHECK( lines == std::vector<unsigned>( { 0u, 1u } ) );
+
+  std::vector<unsigned> levels;
+  BOOST_CHECK_EQUAL( dag.levels( levels ), 2u );
+  BOOST_CHECK( levels == std::vector<unsigned>( { 0u, 1u, 1u } ) );
+
+  /* a gate between the CNOT and the NOT gate */
+  insert_cnot( circ, 2u, 2u, 0u );
+  dag.insert( 2u, circ[2u] );
+  check_neighbors( circ, dag );
+
+  BOOST_CHECK_EQUAL( dag.levels( levels ), 4u );
+
+  /* remove the Toffoli gate */
+  circ.remove_gate_at( 0u );
+  dag.remove( 0u );
+  check_neighbors( circ, dag );
+
+  /* change a gate */
+  circ[0u].add_control( make_var( 2u ) );
+  dag.update( 0u, circ[0u] );
+  check_neighbors( circ, dag );
+
+  BOOST_CHECK_EQUAL( dag.first( 2u ), 0u );
+  BOOST_CHECK_EQUAL( dag.next( 0u, 2u ), 1u );
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_queries)
+{
+  using namespace revkit;
+
+  circuit circ( 4u );
+  for ( unsigned i = 0u; i < 64u; ++i )
+  {
+    append_cnot( circ, i % 4u, ( i + 1u + i / 4u % 3u ) % 4u );
+  }
+  gate_dag dag( circ );
+
+  /* previous gates between the gates, computed by several threads at once */
+  auto query = [&dag]( std::vector<unsigned>& result ) {
+    for ( unsigned l = 0u; l < dag.lines(); ++l )
+    {
+      for ( unsigned i = 0u; i <= dag.num_gates(); ++i )
+      {
+        result.push_back( dag.previous( i, l ) );
+      }
+    }
+  };
+
+  std::vector<unsigned> expected;
+  query( expected );
+
+  std::vector<std::vector<unsigned> > results( 4u );
+  std::vector<std::thread> threads;
+  for ( auto& result : results )
+  {
+    threads.push_back( std::thread( query, std::ref( result ) ) );
+  }
+  for ( auto& t : threads )
+  {
+    t.join();
+  }
+
+  for ( const auto& result : results )
+  {
+    BOOST_CHECK( result == expected );
+  }
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,67 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE incremental_costs
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/utils/costs.hpp>
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  using namespace revkit;
+
+  circuit circ( 4u );
+  append_toffoli( circ )( 0u, 1u, 2u )( 3u );
+  append_cnot( circ, 0u, 1u );
+  append_not( circ, 2u );
+  append_toffoli( circ )( 1u, 2u )( 0u );
+
+  incremental_costs tracker( circ, costs_by_gate_func( transistor_costs() ) );
+  BOOST_CHECK_EQUAL( tracker.total(), costs( circ, costs_by_gate_func( transistor_costs() ) ) );
+  BOOST_CHECK_EQUAL( tracker.quantum_total(), costs( circ, costs_by_gate_func( sk2013_quantum_costs() ) ) );
+  BOOST_CHECK_EQUAL( tracker.range( 1u, 3u ), 8u );
+
+  /* replace the CNOT and the NOT gate by a single CNOT */
+  circuit window( 4u );
+  append_cnot( window, 2u, 3u );
+
+  circ.remove_gate_at( 1u );
+  circ.remove_gate_at( 1u );
+  insert_circuit( circ, 1u, window );
+  tracker.replace( 1u, 3u, window );
+
+  BOOST_CHECK_EQUAL( tracker.total(), costs( circ, costs_by_gate_func( transistor_costs() ) ) );
+  BOOST_CHECK_EQUAL( tracker.quantum_total(), costs( circ, costs_by_gate_func( sk2013_quantum_costs() ) ) );
+  BOOST_CHECK_EQUAL( tracker.transistor_total(), costs( circ, costs_by_gate_func( transistor_costs() ) ) );
+  BOOST_CHECK_EQUAL( tracker.evaluate( window ), 8u );
+
+  /* gate costs are split among the gates */
+  incremental_costs gates_tracker( circ, costs_by_circuit_func( gate_costs() ) );
+  BOOST_CHECK_EQUAL( gates_tracker.total(), 3u );
+  BOOST_CHECK_EQUAL( gates_tracker.range( 0u, 2u ), 2u );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
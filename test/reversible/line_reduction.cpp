@@ -0,0 +1,152 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE line_reduction
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/truth_table.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/optimization/line_reduction.hpp>
+#include <reversible/simulation/simple_simulation.hpp>
+#include <reversible/synthesis/transformation_based_synthesis.hpp>
+
+using namespace revkit;
+
+/* permutation x -> 3x + 1 on three bits */
+binary_truth_table permutation_spec()
+{
+  binary_truth_table spec;
+  for ( unsigned x = 0u; x < 8u; ++x )
+  {
+    unsigned y = ( 3u * x + 1u ) % 8u;
+    binary_truth_table::cube_type in, out;
+    for ( unsigned i = 0u; i < 3u; ++i )
+    {
+      in.push_back( ( x >> ( 2u - i ) ) & 1u );
+      out.push_back( ( y >> ( 2u - i ) ) & 1u );
+    }
+    spec.add_entry( in, out );
+  }
+  return spec;
+}
+
+BOOST_AUTO_TEST_CASE(timeout)
+{
+  std::vector<unsigned> order = { 0u, 1u, 2u };
+
+  embed_and_synthesize es;
+  binary_truth_table spec = permutation_spec();
+  circuit circ;
+  BOOST_REQUIRE( es( circ, spec, order ) );
+
+  es.timeout = 10000u;
+  binary_truth_table spec2 = permutation_spec();
+  circuit circ2;
+  BOOST_REQUIRE( es( circ2, spec2, order ) );
+  BOOST_CHECK_EQUAL( circ2.num_gates(), circ.num_gates() );
+}
+
+BOOST_AUTO_TEST_CASE(abandoned_synthesis)
+{
+  std::vector<unsigned> order = { 0u, 1u, 2u };
+  auto release = std::make_shared<std::atomic<bool> >( false );
+
+  /* synthesis which does not check for cancellation */
+  properties::ptr settings( new properties() );
+  truth_table_synthesis_func slow = [release]( circuit&, const binary_truth_table& ) {
+    while ( !*release ) { std::this_thread::yield(); }
+    return true;
+  };
+  slow.init( settings, properties::ptr( new properties() ) );
+
+  embed_and_synthesize es;
+  es.synthesis = slow;
+  es.timeout = 20u;
+
+  auto start = std::chrono::steady_clock::now();
+  binary_truth_table spec = permutation_spec();
+  circuit circ;
+  BOOST_CHECK( !es( circ, spec, order ) );
+  BOOST_CHECK( std::chrono::steady_clock::now() - start < std::chrono::seconds( 5 ) );
+  BOOST_CHECK_EQUAL( settings->size(), 0u );
+
+  /* the next window does not wait for the abandoned synthesis */
+  es.synthesis = transformation_based_synthesis_func();
+  es.timeout = 10000u;
+  binary_truth_table spec2 = permutation_spec();
+  circuit circ2;
+  BOOST_CHECK( es( circ2, spec2, order ) );
+  BOOST_CHECK( !*release );
+
+  *release = true;
+}
+
+BOOST_AUTO_TEST_CASE(line_reduction_with_timeout)
+{
+  /* the garbage line 0 can be cleared after its value is copied, and then used as line 2 */
+  circuit base( 3u );
+  base.set_inputs( { "a", "0", "0" } );
+  base.set_outputs( { "g", "a", "a" } );
+  base.set_constants( { constant(), false, false } );
+  base.set_garbage( { true, false, false } );
+  append_cnot( base, 0u, 1u );
+  append_cnot( base, 1u, 2u );
+
+  embed_and_synthesize es;
+  es.timeout = 10000u;
+
+  properties::ptr settings( new properties() );
+  settings->set( "window_synthesis", window_synthesis_func( es ) );
+  properties::ptr statistics( new properties() );
+
+  circuit circ;
+  BOOST_REQUIRE( line_reduction( circ, base, settings, statistics ) );
+  BOOST_CHECK_EQUAL( circ.lines(), 2u );
+  BOOST_CHECK_EQUAL( statistics->get<unsigned>( "skipped_synthesis_failed" ), 0u );
+
+  for ( unsigned a = 0u; a < 2u; ++a )
+  {
+    boost::dynamic_bitset<> input( circ.lines() ), output;
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
+    {
+      input[i] = circ.constants()[i] ? *circ.constants()[i] : a;
+    }
+    BOOST_REQUIRE( simple_simulation( output, circ, input ) );
+
+    for ( unsigned i = 0u; i < circ.lines(); ++i )
+    {
+      if ( !circ.garbage()[i] )
+      {
+        BOOST_CHECK_EQUAL( output[i], a );
+      }
+    }
+  }
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,148 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE lnn_optimization
+
+#include <cstdlib>
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/optimization/lnn_optimization.hpp>
+
+BOOST_AUTO_TEST_CASE(global_reordering)
+{
+  using namespace revkit;
+
+  /* lines 0 and 4 interact, after moving one of them to the middle the distance is smaller */
+  circuit base( 5u );
+  base.set_inputs( std::vector<std::string>( { "a", "b", "c", "d", "e" } ) );
+  base.set_outputs( std::vector<std::string>( { "a", "b", "c", "d", "e" } ) );
+  append_cnot( base, 0u, 4u );
+  append_not( base, 1u );
+  append_cnot( base, 4u, 0u );
+
+  properties::ptr settings( new properties() );
+  settings->set( "reordering_mode", 3u );
+
+  circuit circ;
+  BOOST_CHECK( lnn_optimization( circ, base, settings ) );
+
+  BOOST_REQUIRE_EQUAL( circ.num_gates(), 3u );
+
+  /* the lines are permuted together with their names */
+  for ( unsigned i = 0u; i < circ.num_gates(); ++i )
+  {
+    BOOST_CHECK_EQUAL( circ.inputs()[circ[i].targets().front()], base.inputs()[base[i].targets().front()] );
+  }
+
+  unsigned distance = circ[0u].controls().front().line() > circ[0u].targets().front()
+    ? circ[0u].controls().front().line() - circ[0u].targets().front()
+    : circ[0u].targets().front() - circ[0u].controls().front().line();
+  BOOST_CHECK_LT( distance, 4u );
+}
+
+BOOST_AUTO_TEST_CASE(annealing)
+{
+  using namespace revkit;
+
+  /* a chain of interactions which is nearest neighbor for the order 3 0 5 1 4 2 */
+  std::vector<unsigned> order( { 3u, 0u, 5u, 1u, 4u, 2u } );
+  circuit base( 6u );
+  for ( unsigned i = 0u; i + 1u < order.size(); ++i )
+  {
+    append_cnot( base, order[i], order[i + 1u] );
+  }
+
+  properties::ptr settings( new properties() );
+  settings->set( "reordering_mode", 4u );
+  settings->set( "time_budget", 0.1 );
+  settings->set( "num_chains", 2u );
+  properties::ptr statistics( new properties() );
+
+  circuit circ;
+  BOOST_CHECK( lnn_optimization( circ, base, settings, statistics ) );
+
+  BOOST_CHECK_EQUAL( circ.num_gates(), base.num_gates() );
+  BOOST_CHECK_EQUAL( statistics->get<unsigned>( "number_of_swaps" ), 0u );
+
+  auto trace = statistics->get<std::vector<std::pair<double, unsigned> > >( "trace" );
+  BOOST_REQUIRE( !trace.empty() );
+  BOOST_CHECK_EQUAL( trace.back().second, 0u );
+
+  /* neighbors in the chain are neighbors in the ordering */
+  auto line_ordering = statistics->get<std::vector<unsigned> >( "line_ordering" );
+  BOOST_REQUIRE_EQUAL( line_ordering.size(), 6u );
+  std::vector<unsigned> position( 6u );
+  for ( unsigned p = 0u; p < 6u; ++p )
+  {
+    position[line_ordering[p]] = p;
+  }
+  for ( unsigned i = 0u; i + 1u < order.size(); ++i )
+  {
+    BOOST_CHECK_EQUAL( std::abs( int( position[order[i]] ) - int( position[order[i + 1u]] ) ), 1 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(annealing_steps)
+{
+  using namespace revkit;
+
+  circuit base( 8u );
+  for ( unsigned i = 0u; i < 8u; ++i )
+  {
+    append_cnot( base, i, ( 5u * i + 3u ) % 8u );
+  }
+
+  properties::ptr settings( new properties() );
+  settings->set( "reordering_mode", 4u );
+  settings->set( "max_steps", 5000ull );
+  settings->set( "num_chains", 2u );
+  settings->set( "seed", 7u );
+
+  /* with a fixed number of steps, runs are reproducible */
+  properties::ptr statistics1( new properties() ), statistics2( new properties() );
+  circuit circ1, circ2;
+  BOOST_CHECK( lnn_optimization( circ1, base, settings, statistics1 ) );
+  BOOST_CHECK( lnn_optimization( circ2, base, settings, statistics2 ) );
+
+  BOOST_CHECK_EQUAL( statistics1->get<unsigned>( "number_of_swaps" ), statistics2->get<unsigned>( "number_of_swaps" ) );
+  BOOST_CHECK( statistics1->get<std::vector<unsigned> >( "line_ordering" ) == statistics2->get<std::vector<unsigned> >( "line_ordering" ) );
+}
+
+BOOST_AUTO_TEST_CASE(functor)
+{
+  using namespace revkit;
+
+  circuit base( 3u );
+  append_cnot( base, 0u, 2u );
+
+  /* settings and statistics are owned by the functor */
+  optimization_func optimizer = lnn_optimization_func();
+
+  circuit circ;
+  BOOST_CHECK( optimizer( circ, base ) );
+  BOOST_CHECK_EQUAL( optimizer.statistics()->get<unsigned>( "number_of_swaps" ), 2u );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
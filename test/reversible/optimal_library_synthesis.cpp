@@ -0,0 +1,117 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE optimal_library_synthesis
+
+#include <stdexcept>
+#include <sstream>
+
+#include <boost/assign/std/vector.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/truth_table.hpp>
+#include <reversible/functions/circuit_to_truth_table.hpp>
+#include <reversible/simulation/simple_simulation.hpp>
+#include <reversible/synthesis/optimal_library_synthesis.hpp>
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  using namespace boost::assign;
+  using namespace revkit;
+
+  optimal_circuit_library library( 3u );
+  BOOST_CHECK_EQUAL( library.size(), 40320u );
+
+  /* Toffoli gate with target 0 */
+  std::vector<unsigned> toffoli;
+  toffoli += 0u,1u,2u,3u,4u,5u,7u,6u;
+
+  circuit circ;
+  BOOST_CHECK( library.find( toffoli, circ ) );
+  BOOST_CHECK_EQUAL( circ.num_gates(), 1u );
+
+  /* cyclic shift x -> x + 1 */
+  std::vector<unsigned> shift;
+  shift += 1u,2u,3u,4u,5u,6u,7u,0u;
+
+  circuit circ2;
+  BOOST_CHECK( library.find( shift, circ2 ) );
+  BOOST_CHECK_EQUAL( circ2.num_gates(), 3u );
+
+  for ( unsigned x = 0u; x < 8u; ++x )
+  {
+    boost::dynamic_bitset<> input( 3u, x ), output;
+    simple_simulation( output, circ2, input );
+    BOOST_CHECK_EQUAL( output.to_ulong(), shift[x] );
+  }
+
+  /* 4 lines up to 2 gates, swapping two lines needs 3 gates */
+  optimal_circuit_library library4( 4u, costs_by_gate_func(), 2u );
+
+  std::vector<unsigned> swap;
+  for ( unsigned x = 0u; x < 16u; ++x )
+  {
+    swap += ( x & 12u ) | ( ( x & 1u ) << 1u ) | ( ( x & 2u ) >> 1u );
+  }
+
+  circuit circ3;
+  BOOST_CHECK( !library4.find( swap, circ3 ) );
+  BOOST_CHECK( library.find( std::vector<unsigned>( swap.begin(), swap.begin() + 8u ), circ3 ) );
+  BOOST_CHECK_EQUAL( circ3.num_gates(), 3u );
+
+  /* 4 lines cannot be enumerated completely, more are not supported */
+  BOOST_CHECK_THROW( optimal_circuit_library( 4u ), std::invalid_argument );
+  BOOST_CHECK_THROW( optimal_circuit_library( 5u, costs_by_gate_func(), 2u ), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE(synthesis)
+{
+  using namespace boost::assign;
+  using namespace revkit;
+
+  /* 3_17 benchmark, which needs 6 gates */
+  std::vector<unsigned> permutation;
+  permutation += 7u,0u,1u,3u,4u,2u,6u,5u;
+
+  binary_truth_table spec;
+  for ( unsigned x = 0u; x < 8u; ++x )
+  {
+    spec.add_entry( number_to_truth_table_cube( x, 3u ), number_to_truth_table_cube( permutation[x], 3u ) );
+  }
+
+  circuit circ;
+  properties::ptr statistics( new properties() );
+  BOOST_REQUIRE( optimal_library_synthesis( circ, spec, properties::ptr(), statistics ) );
+  BOOST_CHECK( statistics->get<bool>( "from_library" ) );
+  BOOST_CHECK_EQUAL( circ.num_gates(), 6u );
+
+  binary_truth_table simulated;
+  circuit_to_truth_table( circ, simulated, simple_simulation_func() );
+
+  std::stringstream expected, actual;
+  expected << spec;
+  actual << simulated;
+  BOOST_CHECK_EQUAL( actual.str(), expected.str() );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,55 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE peephole_optimization
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/optimization/peephole_optimization.hpp>
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  using namespace revkit;
+
+  circuit base( 5u );
+  append_toffoli( base )( 0u, 1u )( 2u );
+  append_cnot( base, 3u, 4u );             /* no common line with the neighbors */
+  append_toffoli( base )( 1u, 0u )( 2u );  /* cancels the first gate */
+  append_cnot( base, 0u, 1u );
+  append_cnot( base, make_var( 0u, false ), 1u ); /* merged into a NOT gate */
+  append_not( base, 1u );                  /* cancels the merged gate */
+  append_fredkin( base )( 3u )( 1u, 2u );
+
+  properties::ptr statistics( new properties() );
+
+  circuit circ;
+  peephole_optimization( circ, base, properties::ptr(), statistics );
+
+  BOOST_CHECK_EQUAL( circ.num_gates(), 2u );
+  BOOST_CHECK_EQUAL( circ.lines(), 5u );
+  BOOST_CHECK_EQUAL( statistics->get<unsigned>( "cancellations" ), 2u );
+  BOOST_CHECK_EQUAL( statistics->get<unsigned>( "merges" ), 1u );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
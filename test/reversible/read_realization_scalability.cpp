@@ -0,0 +1,101 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE read_realization_scalability
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <core/utils/benchmark_table.hpp>
+#include <core/utils/timer.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/io/read_realization.hpp>
+#include <reversible/io/write_realization.hpp>
+
+using namespace revkit;
+
+void create_random_circuit( circuit& circ, unsigned lines, unsigned num_gates )
+{
+  std::srand( 42 );
+
+  circ.set_lines( lines );
+  for ( unsigned i = 0u; i < num_gates; ++i )
+  {
+    gate::control_container controls;
+    unsigned target = std::rand() % lines;
+    for ( unsigned j = 0u; j < lines; ++j )
+    {
+      if ( j != target && std::rand() % 8 == 0 )
+      {
+        controls.push_back( make_var( j, std::rand() % 2 ) );
+      }
+    }
+    append_toffoli( circ, controls, target );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  circuit circ;
+  create_random_circuit( circ, 32u, 500000u );
+
+  std::string filename = ( boost::filesystem::temp_directory_path() / boost::filesystem::unique_path( "%%%%-%%%%.real" ) ).string();
+  BOOST_REQUIRE( write_realization( circ, filename ) );
+
+  std::ostringstream expected;
+  write_realization( circ, expected );
+
+  benchmark_table<unsigned, double> table( {"Threads", "Run-time"} );
+
+  for ( unsigned num_threads : { 1u, 2u, 4u, 8u, 16u, 32u } )
+  {
+    double runtime;
+    circuit read_circ;
+    read_realization_settings settings;
+    settings.num_threads = num_threads;
+
+    {
+      reference_timer rt( &runtime );
+      timer<reference_timer> t( rt );
+      BOOST_REQUIRE( read_realization( read_circ, filename, settings ) );
+    }
+
+    std::ostringstream actual;
+    write_realization( read_circ, actual );
+    BOOST_CHECK( actual.str() == expected.str() );
+
+    table.add( num_threads, runtime );
+    std::cout << "[I] " << num_threads << ": " << runtime << std::endl;
+  }
+
+  table.print();
+
+  boost::filesystem::remove( filename );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,91 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE resynthesis_cache
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/optimization/resynthesis_cache.hpp>
+#include <reversible/simulation/simple_simulation.hpp>
+
+std::vector<unsigned> circuit_permutation( const revkit::circuit& circ )
+{
+  std::vector<unsigned> perm( 1u << circ.lines() );
+  for ( unsigned x = 0u; x < perm.size(); ++x )
+  {
+    boost::dynamic_bitset<> input( circ.lines(), x ), output;
+    revkit::simple_simulation( output, circ, input );
+    perm[x] = output.to_ulong();
+  }
+  return perm;
+}
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  using namespace revkit;
+
+  resynthesis_cache cache;
+
+  /* Toffoli gate with target 2 and the same gate with target 0 */
+  circuit circ( 3u ), relabeled( 3u );
+  append_toffoli( circ )( 0u, 1u )( 2u );
+  append_toffoli( relabeled )( 2u, 1u )( 0u );
+
+  circuit result;
+  BOOST_CHECK( !cache.lookup( circuit_permutation( circ ), result ) );
+
+  cache.insert( circuit_permutation( circ ), circ );
+  BOOST_CHECK_EQUAL( cache.size(), 1u );
+
+  BOOST_CHECK( cache.lookup( circuit_permutation( relabeled ), result ) );
+  BOOST_CHECK_EQUAL( result.num_gates(), 1u );
+  BOOST_CHECK( circuit_permutation( result ) == circuit_permutation( relabeled ) );
+
+  BOOST_CHECK_EQUAL( cache.hits(), 1ull );
+  BOOST_CHECK_EQUAL( cache.misses(), 1ull );
+
+  /* a more expensive realization does not replace the entry */
+  circuit expensive( 3u );
+  append_toffoli( expensive )( 0u, 1u )( 2u );
+  append_not( expensive, 0u );
+  append_not( expensive, 0u );
+  cache.insert( circuit_permutation( expensive ), expensive );
+
+  circuit result2;
+  BOOST_CHECK( cache.lookup( circuit_permutation( circ ), result2 ) );
+  BOOST_CHECK_EQUAL( result2.num_gates(), 1u );
+
+  /* round trip through a file */
+  BOOST_CHECK( cache.write( "/tmp/test_resynthesis_cache.txt" ) );
+
+  resynthesis_cache other;
+  BOOST_CHECK( other.read( "/tmp/test_resynthesis_cache.txt" ) );
+  BOOST_CHECK_EQUAL( other.size(), 1u );
+
+  circuit result3;
+  BOOST_CHECK( other.lookup( circuit_permutation( relabeled ), result3 ) );
+  BOOST_CHECK( circuit_permutation( result3 ) == circuit_permutation( relabeled ) );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
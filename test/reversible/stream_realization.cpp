@@ -0,0 +1,110 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE stream_realization
+
+#include <sstream>
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/target_tags.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/functions/reverse_circuit.hpp>
+#include <reversible/io/read_realization.hpp>
+#include <reversible/io/stream_realization.hpp>
+#include <reversible/io/write_realization.hpp>
+#include <reversible/utils/costs.hpp>
+
+std::string example_realization()
+{
+  using namespace revkit;
+
+  circuit module( 2u );
+  append_toffoli( module )( 0u )( 1u );
+  append_toffoli( module )( 1u )( 0u );
+
+  circuit circ( 4u );
+  circ.add_module( "m", module );
+  append_toffoli( circ )( make_var( 0u ), make_var( 1u, false ) )( 2u );
+  append_module( circ, "m", gate::control_container( 1u, make_var( 0u ) ), gate::target_container( { 2u, 3u } ) );
+  append_fredkin( circ )( 3u )( 0u, 1u );
+  append_not( circ, 3u );
+  append_module( circ, "m", gate::control_container(), gate::target_container( { 0u, 1u } ) );
+  append_toffoli( circ )( make_var( 0u ), make_var( 1u ), make_var( 2u ) )( 3u );
+
+  std::stringstream s;
+  write_realization( circ, s );
+  return s.str();
+}
+
+BOOST_AUTO_TEST_CASE(costs)
+{
+  using namespace revkit;
+
+  std::string realization = example_realization();
+
+  circuit circ;
+  std::istringstream in( realization );
+  BOOST_REQUIRE( read_realization( circ, in ) );
+
+  std::istringstream stream_in( realization );
+  statistics_sink stats;
+  BOOST_REQUIRE( stream_realization( stream_in, stats ) );
+
+  BOOST_CHECK_EQUAL( stats.num_gates(), circ.num_gates() );
+  BOOST_CHECK_EQUAL( stats.lines(), circ.lines() );
+  BOOST_CHECK_EQUAL( stats.transistor_costs(), revkit::costs( circ, costs_by_gate_func( transistor_costs() ) ) );
+  BOOST_CHECK_EQUAL( stats.quantum_costs(), revkit::costs( circ, costs_by_gate_func( sk2013_quantum_costs() ) ) );
+}
+
+BOOST_AUTO_TEST_CASE(reverse)
+{
+  using namespace revkit;
+
+  std::string realization = example_realization();
+
+  circuit circ, reversed;
+  std::istringstream in( realization );
+  BOOST_REQUIRE( read_realization( circ, in ) );
+  reverse_circuit( circ, reversed );
+
+  /* small chunks to move most of the gates to temporary files */
+  std::stringstream out;
+  std::istringstream stream_in( realization );
+  write_realization_sink writer( out );
+  reverse_sink reverser( writer, 2u );
+  BOOST_REQUIRE( stream_realization( stream_in, reverser ) );
+
+  circuit streamed;
+  BOOST_REQUIRE( read_realization( streamed, out ) );
+
+  BOOST_REQUIRE_EQUAL( streamed.num_gates(), reversed.num_gates() );
+  for ( unsigned i = 0u; i < reversed.num_gates(); ++i )
+  {
+    BOOST_CHECK( streamed[i].controls() == reversed[i].controls() );
+    BOOST_CHECK( streamed[i].targets() == reversed[i].targets() );
+    BOOST_CHECK_EQUAL( is_module( streamed[i] ), is_module( reversed[i] ) );
+  }
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
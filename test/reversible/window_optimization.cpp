@@ -0,0 +1,143 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE window_optimization
+
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/optimization/window_optimization.hpp>
+#include <reversible/simulation/simple_simulation.hpp>
+
+using namespace revkit;
+
+/* circuit with redundant gates in every window */
+circuit redundant_circuit()
+{
+  circuit circ( 4u );
+  for ( unsigned i = 0u; i < 60u; ++i )
+  {
+    append_toffoli( circ )( i % 4u, ( i + 1u ) % 4u )( ( i + 2u ) % 4u );
+    append_cnot( circ, ( i + 3u ) % 4u, i % 4u );
+    append_cnot( circ, ( i + 3u ) % 4u, i % 4u );
+  }
+  return circ;
+}
+
+bool equivalent( const circuit& c1, const circuit& c2 )
+{
+  for ( unsigned x = 0u; x < ( 1u << c1.lines() ); ++x )
+  {
+    boost::dynamic_bitset<> input( c1.lines(), x ), o1, o2;
+    simple_simulation( o1, c1, input );
+    simple_simulation( o2, c2, input );
+    if ( o1 != o2 )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE(parallel_default_optimization)
+{
+  circuit base = redundant_circuit();
+
+  properties::ptr settings( new properties() );
+  settings->set( "num_threads", 4u );
+  properties::ptr statistics( new properties() );
+
+  circuit circ;
+  BOOST_REQUIRE( window_optimization( circ, base, settings, statistics ) );
+  BOOST_CHECK( circ.num_gates() < base.num_gates() );
+  BOOST_CHECK_EQUAL( statistics->get<cost_t>( "costs" ), circ.num_gates() );
+  BOOST_CHECK( equivalent( circ, base ) );
+}
+
+BOOST_AUTO_TEST_CASE(parallel_optimization_factory)
+{
+  circuit base = redundant_circuit();
+
+  resynthesis_cache::ptr cache( new resynthesis_cache() );
+  properties::ptr settings( new properties() );
+  settings->set( "num_threads", 4u );
+  settings->set( "optimization_factory", optimization_factory( [cache]() {
+        resynthesis_optimization ro;
+        ro.cache = cache;
+        return optimization_func( ro );
+      } ) );
+  properties::ptr statistics( new properties() );
+
+  circuit circ;
+  BOOST_REQUIRE( window_optimization( circ, base, settings, statistics ) );
+  BOOST_CHECK( circ.num_gates() < base.num_gates() );
+  BOOST_CHECK( equivalent( circ, base ) );
+  BOOST_CHECK( statistics->get<unsigned long long>( "cache_hits" ) > 0ull );
+}
+
+BOOST_AUTO_TEST_CASE(parallel_shared_optimization)
+{
+  circuit base = redundant_circuit();
+
+  /* a functor without factory is not copied to several threads */
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  optimization_func ro = resynthesis_optimization();
+  properties::ptr settings( new properties() );
+  settings->set( "num_threads", 4u );
+  settings->set( "optimization", optimization_func( [&]( circuit& circ, const circuit& base ) {
+        {
+          std::lock_guard<std::mutex> lock( mutex );
+          threads.insert( std::this_thread::get_id() );
+        }
+        return ro( circ, base );
+      } ) );
+
+  circuit circ;
+  BOOST_REQUIRE( window_optimization( circ, base, settings ) );
+  BOOST_CHECK( circ.num_gates() < base.num_gates() );
+  BOOST_CHECK_EQUAL( threads.size(), 1u );
+}
+
+BOOST_AUTO_TEST_CASE(parallel_exception)
+{
+  circuit base = redundant_circuit();
+
+  properties::ptr settings( new properties() );
+  settings->set( "num_threads", 4u );
+  settings->set( "optimization_factory", optimization_factory( []() {
+        return optimization_func( []( circuit&, const circuit& ) -> bool {
+            throw std::runtime_error( "optimization failed" );
+          } );
+      } ) );
+
+  circuit circ;
+  BOOST_CHECK_THROW( window_optimization( circ, base, settings ), std::runtime_error );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End:
@@ -0,0 +1,93 @@
+/* RevKit (www.revkit.org)
+ * Copyright (C) 2009-2014  University of Bremen
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE write_verilog
+
+#include <sstream>
+
+#include <boost/test/unit_test.hpp>
+
+#include <reversible/circuit.hpp>
+#include <reversible/functions/add_gates.hpp>
+#include <reversible/io/write_verilog.hpp>
+
+BOOST_AUTO_TEST_CASE(constants)
+{
+  using namespace revkit;
+
+  circuit circ( 5u );
+  circ.set_inputs( std::vector<std::string>( { "a", "b", "0", "1", "0" } ) );
+  circ.set_outputs( std::vector<std::string>( { "a", "p", "x", "y", "z" } ) );
+  circ.set_constants( std::vector<constant>( { constant(), constant(), false, true, false } ) );
+  circ.set_garbage( std::vector<bool>( { true, false, false, false, false } ) );
+
+  /* both targets constant, then one target constant */
+  append_fredkin( circ )( make_var( 0u ) )( 2u, 3u );
+  append_fredkin( circ )( make_var( 0u ) )( 4u, 1u );
+  append_toffoli( circ )( make_var( 0u ), make_var( 1u ) )( 2u );
+
+  std::string expected =
+    "module top( clk, a, b, p, x, y, z );\n"
+    "  input clk;\n"
+    "  input a, b;\n"
+    "  output p, x, y, z;\n"
+    "  wire tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;\n"
+    "  // gate 0\n"
+    "  not( tmp0, a );\n"
+    "  buf( tmp1, a );\n"
+    "  buf( tmp2, tmp0 );\n"
+    "  // gate 1\n"
+    "  not( tmp3, a );\n"
+    "  and( tmp4, a, b );\n"
+    "  and( tmp5, tmp3, b );\n"
+    "  // gate 2\n"
+    "  and( tmp6, a, tmp5 );\n"
+    "  xor( tmp7, tmp1, tmp6 );\n"
+    "\n"
+    "  // map outputs\n"
+    "  buf( p, tmp5 );\n"
+    "  buf( x, tmp7 );\n"
+    "  buf( y, tmp2 );\n"
+    "  buf( z, tmp4 );\n"
+    "\n"
+    "  // map state signals\n"
+    "endmodule\n";
+
+  std::ostringstream os;
+  BOOST_CHECK( write_verilog( circ, os ) );
+  BOOST_CHECK_EQUAL( os.str(), expected );
+}
+
+BOOST_AUTO_TEST_CASE(unsupported)
+{
+  using namespace revkit;
+
+  circuit circ( 1u );
+  circ.append_gate().set_type( 0 );
+
+  std::ostringstream os;
+  std::string error;
+  BOOST_CHECK( !write_verilog( circ, os, write_verilog_settings(), &error ) );
+  BOOST_CHECK( os.str().empty() );
+  BOOST_CHECK( !error.empty() );
+}
+
+// Local Variables:
+// c-basic-offset: 2
+// eval: (c-set-offset 'substatement-open 0)
+// eval: (c-set-offset 'innamespace 0)
+// End: